@@ -0,0 +1,163 @@
+#include "allocation_engine.h"
+#include "supporting_func_structs.h"
+#include <unordered_map>
+#include <iomanip>
+
+using namespace std;
+
+
+/*----------------------------------------------------- Allocation Pass Functions ----------------------------------------------*/
+
+//first free position of the pool at or after the one passed in - a taken position links to the one after it, and
+//the links followed are shortened on the way so a run of taken positions is skipped in one step the next time
+static size_t next_free_position(vector<size_t>& next_free, size_t position)
+{
+    while(next_free.at(position) != position)
+    {
+        next_free.at(position) = next_free.at(next_free.at(position));
+        position = next_free.at(position);
+    }
+    return position;
+}
+
+bool allocate_pledges(State_Journal& tree, Customer_Store& customers, vector<RBT_Security_Node*>& additions)
+{
+    //the underpledged customers, smallest deficit first - ties go to the lower pledge code
+    const Money *over_under = customers.over_under_column();
+    vector<size_t> rows;
+    rows.reserve(customers.underpledged_count());
+    for (size_t row = 0; row < customers.size(); row++)
+    {
+        if (over_under[row] < Money())
+        {
+            rows.push_back(row);
+        }
+    }
+    sort(rows.begin(), rows.end(), [over_under](size_t first, size_t second)
+    {
+        return over_under[first] > over_under[second] || (over_under[first] == over_under[second] && first < second);
+    });
+
+    //the free securities are read once in market value order - the values are kept apart so they are searched
+    //contiguously, and a taken position is linked past in next_free instead of being erased
+    vector<RBT_Security_Node*> pool;
+    tree.collect_securities(pool);
+    vector<Money> values(pool.size());
+    vector<size_t> next_free(pool.size() + 1);
+    for (size_t position = 0; position < pool.size(); position++)
+    {
+        values.at(position) = pool.at(position)->market_value;
+        next_free.at(position) = position;
+    }
+    next_free.at(pool.size()) = pool.size();
+    size_t free_end = pool.size(); //one past the largest free security
+
+    vector<size_t> picked;
+    for (size_t row : rows)
+    {
+        Money needed = -over_under[row];
+        picked.clear();
+        while (needed > Money())
+        {
+            while (free_end > 0 && next_free.at(free_end - 1) != free_end - 1)
+            {
+                free_end--;
+            }
+            if (free_end == 0)
+            {
+                //no free securities are left for this customer
+                return false;
+            }
+            //the smallest free security that covers what is left - or the largest one, when none does
+            size_t position = lower_bound(values.begin(), values.begin() + free_end, needed) - values.begin();
+            position = (position < free_end) ? next_free_position(next_free, position) : free_end - 1;
+            next_free.at(position) = position + 1;
+            needed -= values.at(position);
+            picked.push_back(position);
+        }
+        Customer_Node *customer = customers.at(row);
+        for (size_t position : picked)
+        {
+            RBT_Security_Node *security = pool.at(position);
+            tree.remove_security(security);
+            tree.set_pledge(security, customer->pledge_code, customer->name1);
+            tree.pledge(customer, security);
+            RBT_Security_Node *copy = tree.copy_record(security);
+            copy->change_status = "Pledge";
+            tree.push_change(additions, copy);
+        }
+    }
+    return true;
+}
+
+
+/*---------------------------------------------------- Allocation Report Functions ---------------------------------------------*/
+
+Money total_excess(Customer_Store& customers)
+{
+    const Money *over_under = customers.over_under_column();
+    Money excess;
+    for (size_t row = 0; row < customers.size(); row++)
+    {
+        if (over_under[row] > Money())
+        {
+            excess += over_under[row];
+        }
+    }
+    return excess;
+}
+
+int count_lots_moved(const vector<RBT_Security_Node*>& removals, size_t first_removal,
+                     const vector<RBT_Security_Node*>& additions, size_t first_addition)
+{
+    //the customer each released lot was pledged to, by ticket - a lot pledged back to it is crossed off
+    unordered_map<int, int> released;
+    for (size_t i = first_removal; i < removals.size(); i++)
+    {
+        released[removals.at(i)->ticket] = removals.at(i)->pledge_id;
+    }
+    int moved = 0;
+    for (size_t i = first_addition; i < additions.size(); i++)
+    {
+        unordered_map<int, int>::iterator found = released.find(additions.at(i)->ticket);
+        if (found != released.end() && found->second == additions.at(i)->pledge_id)
+        {
+            released.erase(found);
+        }
+        else
+        {
+            moved++;
+        }
+    }
+    //the released lots left were not pledged back to the customer they came from
+    for (const pair<const int, int>& lot : released)
+    {
+        if (lot.second != 0)
+        {
+            moved++;
+        }
+    }
+    return moved;
+}
+
+void display_allocation_report(const Allocation_Report& report)
+{
+    if (report.single_pass)
+    {
+        cout << "Allocation: Single Pass" << endl;
+    }
+    else if (report.threshold_passes == 0)
+    {
+        cout << "Allocation: None - Securities Worth Less Than the Deficit" << endl;
+    }
+    else
+    {
+        cout << "Allocation: Threshold Loop - " << report.threshold_passes << " Passes" << endl;
+    }
+    cout << fixed << setprecision(2);
+    cout << "Customers Pledged: " << report.customers_pledged << "  Deficit: " << report.deficit << endl;
+    cout << "Lots Released: " << report.lots_released << "  Pledged: " << report.lots_pledged
+         << "  Moved: " << report.lots_moved << endl;
+    cout << "Excess Pledged: " << report.excess << endl;
+    cout << "Allocation Time: " << report.milliseconds << " ms" << endl;
+}
@@ -0,0 +1,69 @@
+#ifndef ALLOCATION_ENGINE_H
+#define ALLOCATION_ENGINE_H
+
+#include <iostream>
+#include <vector>
+#include "money.h"
+#include "state_journal.h"
+#include "customer_store.h"
+
+
+using namespace std;
+
+
+/*------------------------------------------------- Allocation Engine Structures -----------------------------------------------*/
+
+/*
+    This structure reports a clear all and repledge run - whether every customer was covered, how it got there
+    and what the pledges it left cost in excess collateral.
+*/
+struct Allocation_Report
+{
+    bool covered = false;
+    bool single_pass = false; //true if the single global pass covered every customer
+    int threshold_passes = 0; //passes of the threshold loop run after the single pass fell short
+    int customers_pledged = 0;
+    int lots_released = 0; //lots unpledged when the pledges were cleared
+    int lots_pledged = 0;
+    int lots_moved = 0; //lots that ended up free or pledged to a different customer than before the run
+    Money deficit; //combined shortfall the run started from
+    Money excess; //collateral pledged over the customers' balances once the run finished
+    double milliseconds = 0;
+};
+
+
+/*------------------------------------------------- Allocation Engine Functions ------------------------------------------------*/
+
+/*
+    Function pledges the securities in the index to every underpledged customer in one global pass - best fit
+    bin covering. The customers are taken smallest deficit first and the free securities are read once, in market
+    value order. Each customer takes the smallest free security that covers what it still needs, or the largest
+    free security when none does, until it is covered - so the small deficits are covered closely by the small
+    securities and the large ones are left for the customers that need more than one. The securities picked are
+    taken out of the index, pledged and added to the additions through the journal, as update_customers does.
+
+    Returns false at the first customer the free securities can't cover, leaving the customers pledged so far -
+    roll back through the journal to undo the pass. O(NlogN + MlogM) for N customers and M securities.
+*/
+bool allocate_pledges(State_Journal& tree, Customer_Store& customers, vector<RBT_Security_Node*>& additions);
+
+/*
+    Function counts the lots a run moved, from the removals and additions it pushed (those from the first positions
+    passed in on). A lot released and pledged back to the same customer hasn't moved. O(N)
+*/
+int count_lots_moved(const vector<RBT_Security_Node*>& removals, size_t first_removal,
+                     const vector<RBT_Security_Node*>& additions, size_t first_addition);
+
+/*
+    Function returns the collateral pledged over the customers' balances - the sum of every positive over_under
+    balance, read from the store's column. O(N)
+*/
+Money total_excess(Customer_Store& customers);
+
+/*
+    Function prints the report of a clear all and repledge run.
+*/
+void display_allocation_report(const Allocation_Report& report);
+
+
+#endif
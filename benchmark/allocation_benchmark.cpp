@@ -0,0 +1,167 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include "../supporting_func_structs.h"
+
+using namespace std;
+
+/*
+    Compares the two ways clear all and repledge can allocate the securities: the threshold loop it used on its
+    own, which runs update_customers from a 50% threshold down to 0% and rolls back every pass that fails, and
+    the single global pass it now tries first (see allocate_pledges). A synthetic customer file and security file
+    are written, with the securities (a third of them pledged) worth the coverage ratio times the combined
+    customer balances - the closer the ratio is to 1, the more passes the loop needs. Both runs start from the
+    same loaded state through the journal and are compared on coverage, excess pledged, lots moved and time.
+
+    Build from the project folder:
+        g++ -O2 -std=c++17 benchmark/allocation_benchmark.cpp allocation_engine.cpp supporting_func_structs.cpp red_black_tree.cpp csv_reader.cpp security_index.cpp bplus_tree.cpp state_journal.cpp security_catalog.cpp customer_store.cpp deficit_queue.cpp -o allocation_benchmark -pthread
+    Run:
+        ./allocation_benchmark [customer count - 10000 by default] [coverage ratio - 1.10 by default]
+*/
+
+#define BENCHMARK_CUSTOMER_FILE "allocation_benchmark_customers.csv" //both files are written to the working folder
+#define BENCHMARK_SECURITY_FILE "allocation_benchmark_securities.csv" //and removed at the end
+
+
+/*----------------------------------------------------- Benchmark Input Functions ----------------------------------------------*/
+
+string cents_text(uint64_t cents)
+{
+    return to_string(cents / 100) + ((cents % 100 < 10) ? ".0" : ".") + to_string(cents % 100);
+}
+
+void write_source_files(size_t customer_count, double coverage)
+{
+    mt19937_64 random(2024);
+    ofstream customer_file(BENCHMARK_CUSTOMER_FILE);
+    customer_file << "Pledge ID,Tax ID Number,Name1,Name2,Account Number,Effective Interest Rate,Account Type,"
+                  << "Class Code Description,Current Balance" << endl;
+    uint64_t balance_total = 0;
+    for(size_t i = 0; i < customer_count * 2; i++)
+    {
+        size_t customer = i / 2;
+        uint64_t balance = random() % 50000000;
+        balance_total += balance;
+        customer_file << (customer + 10000) << "," << (2000000000 + customer) << ",Customer " << customer << ",,"
+                      << (300000 + i) << ",1.00%,DDA,Demand Deposit," << cents_text(balance) << "\n";
+    }
+
+    ofstream security_file(BENCHMARK_SECURITY_FILE);
+    security_file << "Portfolio,CUSIP,Ticket,Maturity Date,Pledge ID,Pledge Description,Pledge Amount,Par Value,"
+                  << "Market Value,Group,Security Description" << endl;
+    uint64_t value_total = 0;
+    for(size_t i = 0; value_total < balance_total * coverage; i++)
+    {
+        uint64_t value = random() % 60000000 + 1;
+        value_total += value;
+        security_file << "Justin Investments LLC,3131" << (random() % 100000) << "," << i << ","
+                      << (random() % 12 + 1) << "/" << (random() % 28 + 1) << "/" << (2024 + random() % 30) << ","
+                      << ((i % 3 == 0) ? to_string(random() % customer_count + 10000) : "") << ",,"
+                      << cents_text(value) << "," << cents_text(value) << "," << cents_text(value) << ",MBS,Security Name\n";
+    }
+}
+
+
+/*--------------------------------------------------- Benchmark Allocation Functions -------------------------------------------*/
+
+//the threshold loop as clear_all_and_repledge ran it before the single pass was added
+bool threshold_loop(State_Journal& tree, Customer_Store& customers, vector<RBT_Security_Node*>& additions,
+                    vector<RBT_Security_Node*>& removals, Allocation_Report& report)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    clear_pledges(tree, customers, removals);
+    report.lots_released = removals.size();
+    report.deficit = total_deficit(customers);
+    report.customers_pledged = customers.underpledged_count();
+    size_t cleared_state = tree.snapshot();
+    bool status = false;
+    double threshold = .51;
+    while(!status && report.deficit <= tree.market_value_total() && threshold > 0)
+    {
+        threshold -= .01;
+        if(threshold < 0) {threshold = 0;}
+        report.threshold_passes++;
+        status = update_customers(customers, tree, additions, threshold);
+        if(!status)
+        {
+            tree.rollback(cleared_state);
+        }
+    }
+    report.covered = status;
+    if(!status)
+    {
+        report.customers_pledged = 0;
+    }
+    report.lots_pledged = additions.size();
+    report.lots_moved = count_lots_moved(removals, 0, additions, 0);
+    report.excess = total_excess(customers);
+    report.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return status;
+}
+
+void print_result(const string& engine, const Allocation_Report& report)
+{
+    cout << setw(16) << engine << setw(10) << (report.covered ? "Yes" : "No") << setw(8) << report.threshold_passes
+         << setw(20) << report.excess << setw(10) << report.lots_pledged << setw(10) << report.lots_moved
+         << setw(14) << report.milliseconds << endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    size_t customer_count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 10000;
+    double coverage = (argc > 2) ? atof(argv[2]) : 1.10;
+    if(customer_count == 0 || coverage <= 0)
+    {
+        return 0;
+    }
+    write_source_files(customer_count, coverage);
+
+    RBT_Security_Index index;
+    State_Journal tree(index);
+    Mapped_File customer_file;
+    customer_file.open(BENCHMARK_CUSTOMER_FILE);
+    Customer_Store customers = load_customer_data(customer_file);
+    vector<RBT_Security_Node*> removals;
+    vector<RBT_Security_Node*> additions;
+    Mapped_File security_file;
+    security_file.open(BENCHMARK_SECURITY_FILE);
+    import_and_build_security_index(customers, removals, security_file, tree);
+    tree.commit();
+    size_t loaded_state = tree.snapshot();
+
+    cout << endl << "Clear all and repledge - " << customers.size() << " customers, " << tree.security_count()
+         << " free securities, coverage " << coverage << endl;
+    cout << setw(16) << "Engine" << setw(10) << "Covered" << setw(8) << "Passes" << setw(20) << "Excess"
+         << setw(10) << "Pledged" << setw(10) << "Moved" << setw(14) << "ms" << endl;
+    cout << fixed << setprecision(2);
+
+    //both runs only count the changes they make - the removals from the import are kept apart
+    vector<RBT_Security_Node*> loop_removals;
+    Allocation_Report loop_report;
+    threshold_loop(tree, customers, additions, loop_removals, loop_report);
+    print_result("Threshold Loop", loop_report);
+    tree.rollback(loaded_state);
+
+    vector<RBT_Security_Node*> pass_removals;
+    Allocation_Report pass_report;
+    clear_all_and_repledge(tree, customers, additions, pass_removals, pass_report);
+    print_result(pass_report.single_pass ? "Single Pass" : "Pass + Loop", pass_report);
+    tree.rollback(loaded_state);
+
+    bool covered = pass_report.covered || !loop_report.covered;
+    cout << endl << "Coverage Equal or Better: " << (covered ? "Passed" : "Failed")
+         << "  Speedup: " << loop_report.milliseconds / pass_report.milliseconds << "x" << endl;
+
+    clear_customers(customers);
+    clear_vector(removals);
+    remove(BENCHMARK_CUSTOMER_FILE);
+    remove(BENCHMARK_SECURITY_FILE);
+    return 0;
+}
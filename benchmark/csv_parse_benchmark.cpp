@@ -0,0 +1,151 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include "../red_black_tree.h"
+#include "../csv_reader.h"
+
+using namespace std;
+
+/*
+    Compares the two ways of reading a security file into security records: the stream reader the program used
+    before (getline per row, a stringstream split into a fresh vector of strings) and the mapped csv reader
+    (string_view fields split in place). Both build the records with the same field conversions. A synthetic security file is
+    written first - every tenth description is quoted and holds a comma - and each reader builds every record
+    from it. Times include opening the file.
+
+    Build from the project folder:
+        g++ -O2 -std=c++17 benchmark/csv_parse_benchmark.cpp red_black_tree.cpp csv_reader.cpp -o csv_parse_benchmark -pthread
+    Run:
+        ./csv_parse_benchmark [row count - 2000000 by default]
+*/
+
+#define BENCHMARK_FILE "csv_parse_benchmark.csv" //written to the working folder and removed at the end
+
+
+/*----------------------------------------------------- Benchmark Input Functions ----------------------------------------------*/
+
+void write_security_file(size_t row_count)
+{
+    mt19937_64 random(2024);
+    ofstream security_file(BENCHMARK_FILE);
+    security_file << "Portfolio,CUSIP,Ticket,Maturity Date,Pledge ID,Pledge Description,Pledge Amount,Par Value,"
+                  << "Market Value,Group,Security Description" << endl;
+    for(size_t i = 0; i < row_count; i++)
+    {
+        uint64_t cents = random() % 1000000000;
+        security_file << "Justin Investments LLC,3131" << (random() % 100000) << ",";
+        security_file << i << "," << (random() % 12 + 1) << "/" << (random() % 28 + 1) << "/" << (2024 + random() % 30) << ",";
+        security_file << ((i % 3 == 0) ? to_string(random() % 5000 + 1) : "") << ",,";
+        security_file << (cents / 100) << ",";
+        string amount = to_string(cents / 100) + ((cents % 100 < 10) ? ".0" : ".") + to_string(cents % 100);
+        security_file << amount << "," << amount << ",MBS,";
+        security_file << ((i % 10 == 0) ? "\"Security Name, Series A\"" : "Security Name") << "\n";
+    }
+}
+
+
+/*--------------------------------------------------- Benchmark Timing Functions -----------------------------------------------*/
+
+double elapsed_ms(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+void print_row(const string& name, double load_ms, size_t row_count, double checksum)
+{
+    cout << fixed << setprecision(1)
+         << setw(16) << name
+         << setw(14) << load_ms
+         << setw(14) << load_ms * 1e6 / row_count
+         << "    (checksum " << setprecision(0) << checksum << ")" << endl;
+}
+
+void run_stream_reader(size_t row_count)
+{
+    vector<RBT_Security_Node*> securities;
+    securities.reserve(row_count);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    ifstream security_file(BENCHMARK_FILE);
+    string security_line;
+    getline(security_file, security_line);
+    while(getline(security_file, security_line))
+    {
+        stringstream security_detail_line(security_line);
+        string temp_string;
+        vector<string> temp_vector;
+        while(getline(security_detail_line, temp_string, ','))
+        {
+            temp_vector.push_back(temp_string);
+        }
+        //the stream split can't see quotes - the description is glued back from the fields after the group
+        for(size_t i = 11; i < temp_vector.size(); i++)
+        {
+            temp_vector.at(10) += "," + temp_vector.at(i);
+        }
+        securities.push_back(RBT::build_security_node(temp_vector));
+    }
+    double load_ms = elapsed_ms(start);
+
+    double checksum = 0;
+    for(size_t i = 0; i < securities.size(); i++)
+    {
+        checksum += securities.at(i)->market_value.to_double() + securities.at(i)->security_description.size();
+        delete securities.at(i);
+    }
+    print_row("Stream reader", load_ms, row_count, checksum);
+}
+
+void run_mapped_reader(size_t row_count)
+{
+    vector<RBT_Security_Node*> securities;
+    securities.reserve(row_count);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Mapped_File security_file;
+    security_file.open(BENCHMARK_FILE);
+    Csv_Reader security_rows(security_file);
+    vector<string_view> security_fields;
+    security_rows.skip_row();
+    while(security_rows.next_row(security_fields))
+    {
+        securities.push_back(RBT::build_security_node(security_fields));
+    }
+    double load_ms = elapsed_ms(start);
+
+    double checksum = 0;
+    for(size_t i = 0; i < securities.size(); i++)
+    {
+        //the quotes aren't part of the field, so two characters fewer for each quoted description
+        checksum += securities.at(i)->market_value.to_double() + securities.at(i)->security_description.size()
+                    + ((i % 10 == 0) ? 2 : 0);
+        delete securities.at(i);
+    }
+    print_row("Mapped reader", load_ms, row_count, checksum);
+}
+
+
+int main(int argc, char* argv[])
+{
+    size_t row_count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 2000000;
+    if(row_count == 0)
+    {
+        return 0;
+    }
+    write_security_file(row_count);
+
+    cout << endl << "Security file - " << row_count << " rows" << endl;
+    cout << setw(16) << "Reader" << setw(14) << "Load ms" << setw(14) << "ns/row" << endl;
+    //the first pass warms the page cache, so both readers see the file in memory
+    run_stream_reader(row_count);
+    run_mapped_reader(row_count);
+    run_stream_reader(row_count);
+    run_mapped_reader(row_count);
+    remove(BENCHMARK_FILE);
+    return 0;
+}
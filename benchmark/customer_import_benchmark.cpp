@@ -0,0 +1,135 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include "../supporting_func_structs.h"
+
+using namespace std;
+
+/*
+    Times load_customer_data on a synthetic customer balance file with an increasing number of threads. Customers
+    have four accounts on average, and their rows are scattered through the file, so most customers are split
+    across chunks and merged. Every load is checked against the single thread load - same customers, the same accounts
+    in the same order and the same totals.
+
+    Build from the project folder:
+        g++ -O2 -std=c++17 benchmark/customer_import_benchmark.cpp supporting_func_structs.cpp red_black_tree.cpp csv_reader.cpp security_index.cpp bplus_tree.cpp state_journal.cpp security_catalog.cpp customer_store.cpp deficit_queue.cpp allocation_engine.cpp -o customer_import_benchmark -pthread
+    Run:
+        ./customer_import_benchmark [account row count - 4000000 by default]
+*/
+
+#define BENCHMARK_FILE "customer_import_benchmark.csv" //written to the working folder and removed at the end
+
+
+/*----------------------------------------------------- Benchmark Input Functions ----------------------------------------------*/
+
+void write_customer_file(size_t row_count)
+{
+    mt19937_64 random(2024);
+    size_t customer_count = row_count / 4 + 1;
+    ofstream customer_file(BENCHMARK_FILE);
+    customer_file << "Pledge ID,Tax ID Number,Name1,Name2,Account Number,Effective Interest Rate,Account Type,"
+                  << "Class Code Description,Current Balance" << endl;
+    for(size_t i = 0; i < row_count; i++)
+    {
+        size_t customer = random() % customer_count;
+        uint64_t cents = random() % 100000000;
+        customer_file << (customer + 10000) << "," << (2000000000 + customer) << ",";
+        customer_file << ((customer % 7 == 0) ? "\"Customer " + to_string(customer) + ", Inc.\"" : "Customer " + to_string(customer));
+        customer_file << ",," << (300000 + i) << ",1.00%,DDA,Demand Deposit,";
+        customer_file << (cents / 100) << ((cents % 100 < 10) ? ".0" : ".") << (cents % 100) << "\n";
+    }
+}
+
+
+/*--------------------------------------------------- Benchmark Timing Functions -----------------------------------------------*/
+
+double elapsed_ms(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+bool same_customers(Customer_Store& first, Customer_Store& second)
+{
+    if(first.size() != second.size())
+    {
+        return false;
+    }
+    for(size_t position = 0; position < first.size(); position++)
+    {
+        Customer_Node* customer = first.at(position);
+        Customer_Node* other = second.find(customer->pledge_code);
+        if(other == nullptr || customer->name1 != other->name1
+           || customer->total_balance() != other->total_balance()
+           || customer->over_under() != other->over_under()
+           || customer->accounts.size() != other->accounts.size())
+        {
+            return false;
+        }
+        for(size_t i = 0; i < customer->accounts.size(); i++)
+        {
+            if(customer->accounts.at(i).account_number != other->accounts.at(i).account_number)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+    size_t row_count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 4000000;
+    if(row_count == 0)
+    {
+        return 0;
+    }
+    write_customer_file(row_count);
+
+    //at least four threads are run, so the chunk merge is checked even on a machine with fewer
+    size_t hardware_threads = max(thread::hardware_concurrency(), 4u);
+    vector<size_t> thread_counts(1, 1);
+    for(size_t threads = 2; threads < hardware_threads; threads *= 2)
+    {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(hardware_threads);
+
+    cout << endl << "Customer file - " << row_count << " account rows" << endl;
+    cout << setw(10) << "Threads" << setw(14) << "Load ms" << setw(14) << "ns/row" << setw(12) << "Customers"
+         << setw(16) << "Same as 1" << endl;
+    Customer_Store single_thread;
+    for(size_t i = 0; i < thread_counts.size(); i++)
+    {
+        Mapped_File customer_file;
+        customer_file.open(BENCHMARK_FILE);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        Customer_Store customers = load_customer_data(customer_file, thread_counts.at(i));
+        double load_ms = elapsed_ms(start);
+        bool same = (i == 0) || same_customers(single_thread, customers);
+
+        cout << fixed << setprecision(1)
+             << setw(10) << thread_counts.at(i)
+             << setw(14) << load_ms
+             << setw(14) << load_ms * 1e6 / row_count
+             << setw(12) << customers.size()
+             << setw(16) << (same ? "Passed" : "Failed") << endl;
+        if(i == 0)
+        {
+            single_thread = move(customers);
+        }
+        else
+        {
+            clear_customers(customers);
+        }
+    }
+    clear_customers(single_thread);
+    remove(BENCHMARK_FILE);
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include "../supporting_func_structs.h"
+
+using namespace std;
+
+/*
+    Compares the per-customer scans of the pledging functions - the underpledged filter of update_customers, the total
+    deficit and the overage test of test_overage - on the two customer layouts. The node layout is the one the
+    customers had before the customer store held the totals: one allocated node per customer with its totals in it
+    and each account allocated on its own, reached through the store's handles. The column layout is the customer
+    store, where the scans sweep the contiguous totals columns. Both hold the same synthetic customers (two accounts
+    each, a third underpledged and a third over the overage limit), allocated in file order with pledge codes
+    scattered, and the scans are checked to give the same results.
+
+    Build from the project folder:
+        g++ -O2 -std=c++17 benchmark/customer_scan_benchmark.cpp supporting_func_structs.cpp red_black_tree.cpp csv_reader.cpp security_index.cpp bplus_tree.cpp state_journal.cpp security_catalog.cpp customer_store.cpp deficit_queue.cpp allocation_engine.cpp -o customer_scan_benchmark -pthread
+    Run:
+        ./customer_scan_benchmark [customer count - 1000000 by default]
+*/
+
+#define SCAN_REPEATS 20 //each scan is timed over this many passes
+
+
+/*----------------------------------------------------- Node Layout Structures -------------------------------------------------*/
+
+//the customer node as it was - the totals are read through the node, the accounts through their own pointers
+struct Node_Layout_Customer
+{
+    int pledge_code;
+    long int tax_ID;
+    string name1;
+    string name2;
+    vector<Account_Node*> accounts;
+    vector<RBT_Security_Node*> pledged_to_customer;
+    Money total_pledged;
+    Money total_balance;
+    Money over_under;
+};
+
+struct Scan_Result
+{
+    size_t underpledged = 0;
+    Money deficit;
+    size_t overage = 0;
+};
+
+
+/*---------------------------------------------------------- Scan Functions ----------------------------------------------------*/
+
+Scan_Result node_scan(vector<Node_Layout_Customer*>& customers, vector<Node_Layout_Customer*>& updates_needed)
+{
+    Scan_Result result;
+    updates_needed.clear();
+    for(size_t i = 0; i < customers.size(); i++)
+    {
+        if(customers.at(i)->over_under < Money())
+        {
+            updates_needed.push_back(customers.at(i));
+        }
+    }
+    result.underpledged = updates_needed.size();
+    for(size_t i = 0; i < customers.size(); i++)
+    {
+        if(customers.at(i)->over_under < Money())
+        {
+            result.deficit -= customers.at(i)->over_under;
+        }
+    }
+    for(size_t i = 0; i < customers.size(); i++)
+    {
+        if(customers.at(i)->over_under > customers.at(i)->total_balance.scaled(.5))
+        {
+            result.overage++;
+        }
+    }
+    return result;
+}
+
+Scan_Result column_scan(Customer_Store& customers, vector<Customer_Node*>& updates_needed)
+{
+    Scan_Result result;
+    updates_needed.clear();
+    const Money* over_under = customers.over_under_column();
+    const Money* total_balance = customers.balance_column();
+    for(size_t i = 0; i < customers.size(); i++)
+    {
+        if(over_under[i] < Money())
+        {
+            updates_needed.push_back(customers.at(i));
+        }
+    }
+    result.underpledged = updates_needed.size();
+    //swept rather than read from the deficit queue, so both layouts time the same scan
+    for(size_t i = 0; i < customers.size(); i++)
+    {
+        if(over_under[i] < Money())
+        {
+            result.deficit -= over_under[i];
+        }
+    }
+    for(size_t i = 0; i < customers.size(); i++)
+    {
+        if(over_under[i] > total_balance[i].scaled(.5))
+        {
+            result.overage++;
+        }
+    }
+    return result;
+}
+
+
+/*--------------------------------------------------- Benchmark Timing Functions -----------------------------------------------*/
+
+double elapsed_ms(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+
+int main(int argc, char* argv[])
+{
+    size_t customer_count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 1000000;
+    if(customer_count == 0)
+    {
+        return 0;
+    }
+    mt19937_64 random(2024);
+    vector<int> pledge_codes(customer_count);
+    for(size_t i = 0; i < customer_count; i++)
+    {
+        pledge_codes.at(i) = 10000 + i;
+    }
+    shuffle(pledge_codes.begin(), pledge_codes.end(), random);
+
+    //both layouts are built from the same customers, in the same (file) order
+    vector<Node_Layout_Customer*> node_customers;
+    vector<Customer_Node*> store_customers;
+    node_customers.reserve(customer_count);
+    store_customers.reserve(customer_count);
+    for(size_t i = 0; i < customer_count; i++)
+    {
+        Node_Layout_Customer* node = new Node_Layout_Customer;
+        Customer_Node* customer = new Customer_Node;
+        node->pledge_code = customer->pledge_code = pledge_codes.at(i);
+        node->tax_ID = customer->tax_ID = 2000000000 + i;
+        node->name1 = customer->name1 = "Customer " + to_string(i);
+        for(int j = 0; j < 2; j++)
+        {
+            Account_Node* account = new Account_Node;
+            account->account_number = 300000 + i * 2 + j;
+            account->interest_rate = "1.00%";
+            account->account_type = "DDA";
+            account->class_code_description = "Demand Deposit";
+            account->current_balance = Money::from_cents(random() % 100000000);
+            node->accounts.push_back(account);
+            node->total_balance += account->current_balance;
+            customer->add_account(*account);
+        }
+        //about a third of the customers are short of collateral and a third have over half their balance to spare
+        double coverage[] = {.5, 1.2, 1.8};
+        node->total_pledged = node->total_balance.scaled(coverage[random() % 3]);
+        node->over_under = node->total_pledged - node->total_balance;
+        node_customers.push_back(node);
+        store_customers.push_back(customer);
+    }
+    sort(node_customers.begin(), node_customers.end(), [](const Node_Layout_Customer* first, const Node_Layout_Customer* second)
+    {
+        return first->pledge_code < second->pledge_code;
+    });
+    Customer_Store customers;
+    customers.assign(store_customers);
+    //the pledged totals are set straight into the columns, as the synthetic customers pledge no security records
+    for(size_t i = 0; i < customers.size(); i++)
+    {
+        customers.set_totals(i, node_customers.at(i)->total_balance, node_customers.at(i)->total_pledged);
+    }
+
+    cout << endl << "Customer scans - " << customer_count << " customers, " << SCAN_REPEATS << " passes" << endl;
+    cout << setw(10) << "Layout" << setw(14) << "ms/pass" << setw(14) << "ns/customer" << setw(14) << "Underpledged"
+         << setw(20) << "Deficit" << setw(10) << "Overage" << endl;
+
+    vector<Node_Layout_Customer*> node_updates;
+    Scan_Result node_result;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int pass = 0; pass < SCAN_REPEATS; pass++)
+    {
+        node_result = node_scan(node_customers, node_updates);
+    }
+    double node_ms = elapsed_ms(start) / SCAN_REPEATS;
+
+    vector<Customer_Node*> column_updates;
+    Scan_Result column_result;
+    start = chrono::steady_clock::now();
+    for(int pass = 0; pass < SCAN_REPEATS; pass++)
+    {
+        column_result = column_scan(customers, column_updates);
+    }
+    double column_ms = elapsed_ms(start) / SCAN_REPEATS;
+
+    cout << fixed << setprecision(2)
+         << setw(10) << "Node" << setw(14) << node_ms << setw(14) << node_ms * 1e6 / customer_count
+         << setw(14) << node_result.underpledged << setw(20) << node_result.deficit << setw(10) << node_result.overage << endl
+         << setw(10) << "Column" << setw(14) << column_ms << setw(14) << column_ms * 1e6 / customer_count
+         << setw(14) << column_result.underpledged << setw(20) << column_result.deficit << setw(10) << column_result.overage << endl;
+
+    bool same = node_result.underpledged == column_result.underpledged && node_result.deficit == column_result.deficit
+                && node_result.overage == column_result.overage;
+    for(size_t i = 0; same && i < node_updates.size(); i++)
+    {
+        same = node_updates.at(i)->pledge_code == column_updates.at(i)->pledge_code;
+    }
+    cout << endl << "Scans Match: " << (same ? "Passed" : "Failed") << "  Speedup: " << node_ms / column_ms << "x" << endl;
+
+    for(size_t i = 0; i < node_customers.size(); i++)
+    {
+        for(size_t j = 0; j < node_customers.at(i)->accounts.size(); j++)
+        {
+            delete node_customers.at(i)->accounts.at(j);
+        }
+        delete node_customers.at(i);
+    }
+    clear_customers(customers);
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include "../red_black_tree.h"
+#include "../generic_rbt.h"
+
+using namespace std;
+
+/*
+    Compares the security tree (RBT) with instantiations of the generic red-black tree on the same security keys
+    (market value, then ticket). Each tree is built one insert at a time from random lots, then timed on exact finds
+    of known lots, removing and re-adding known lots, and an in-order walk of the whole tree. RBT is itself the packed
+    color, parent linked instantiation with the subtree counts and market value totals kept through the augment
+    hook, which the other instantiations do without.
+
+    Build from the project folder:
+        g++ -O2 -std=c++17 benchmark/generic_rbt_benchmark.cpp red_black_tree.cpp csv_reader.cpp -o generic_rbt_benchmark -pthread
+    Run:
+        ./generic_rbt_benchmark [lot count - 1000000 by default]
+*/
+
+#define BENCHMARK_OPERATIONS 1000000 //operations timed for each step
+
+
+/*------------------------------------------------------ Security Key Instantiations -------------------------------------------*/
+
+struct Security_Key
+{
+    Money market_value;
+    int ticket;
+};
+
+struct Security_Key_Less
+{
+    bool operator()(const Security_Key& first, const Security_Key& second) const
+    {
+        return first.market_value < second.market_value
+               || (first.market_value == second.market_value && first.ticket < second.ticket);
+    }
+};
+
+typedef Generic_RBT<Security_Key, RBT_Security_Node*, Security_Key_Less, RBT_Default_Policy> Byte_Color_Tree;
+typedef Generic_RBT<Security_Key, RBT_Security_Node*, Security_Key_Less, RBT_Packed_Policy> Packed_Color_Tree;
+typedef Generic_RBT<Security_Key, RBT_Security_Node*, Security_Key_Less, RBT_Compact_Policy> Compact_Tree;
+
+
+/*--------------------------------------------------- Benchmark Timing Functions -----------------------------------------------*/
+
+double elapsed_ms(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+void print_row(const string& name, size_t node_bytes, double insert_ms, double find_ns, double erase_ns, double walk_ms, double checksum)
+{
+    cout << fixed << setprecision(1)
+         << setw(22) << name
+         << setw(12) << node_bytes
+         << setw(14) << insert_ms
+         << setw(14) << find_ns
+         << setw(20) << erase_ns
+         << setw(12) << walk_ms
+         << "    (checksum " << setprecision(0) << checksum << ")" << endl;
+}
+
+void run_security_tree(const vector<Security_Key>& keys, const vector<size_t>& picks)
+{
+    vector<RBT_Security_Node*> records;
+    records.reserve(keys.size());
+    for(size_t i = 0; i < keys.size(); i++)
+    {
+        RBT_Security_Node* security = new RBT_Security_Node;
+        security->market_value = keys.at(i).market_value;
+        security->ticket = keys.at(i).ticket;
+        security->pledge_id = 0;
+        records.push_back(security);
+    }
+    RBT tree;
+    double checksum = 0;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        tree.RBT_add_node(records.at(i));
+    }
+    double insert_ms = elapsed_ms(start);
+
+    start = chrono::steady_clock::now();
+    for(size_t i = 0; i < picks.size(); i++)
+    {
+        const Security_Key& key = keys.at(picks.at(i));
+        checksum += tree.find(key.ticket, key.market_value)->key.ticket;
+    }
+    double find_ns = elapsed_ms(start) * 1e6 / picks.size();
+
+    start = chrono::steady_clock::now();
+    for(size_t i = 0; i < picks.size(); i++)
+    {
+        const Security_Key& key = keys.at(picks.at(i));
+        tree.RBT_add_node(tree.erase(key.ticket, key.market_value));
+    }
+    double erase_ns = elapsed_ms(start) * 1e6 / picks.size();
+
+    start = chrono::steady_clock::now();
+    for(RBT::iterator node = tree.begin(); node != tree.end(); ++node)
+    {
+        checksum += node->key.market_value.to_double();
+    }
+    double walk_ms = elapsed_ms(start);
+
+    print_row("RBT (security tree)", sizeof(RBT_Node), insert_ms, find_ns, erase_ns, walk_ms, checksum);
+}
+
+template <typename Tree>
+void run_generic_tree(const string& name, const vector<Security_Key>& keys, const vector<size_t>& picks)
+{
+    Tree tree;
+    double checksum = 0;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(size_t i = 0; i < keys.size(); i++)
+    {
+        tree.insert(keys.at(i), nullptr);
+    }
+    double insert_ms = elapsed_ms(start);
+
+    start = chrono::steady_clock::now();
+    for(size_t i = 0; i < picks.size(); i++)
+    {
+        checksum += tree.find(keys.at(picks.at(i)))->key.ticket;
+    }
+    double find_ns = elapsed_ms(start) * 1e6 / picks.size();
+
+    start = chrono::steady_clock::now();
+    for(size_t i = 0; i < picks.size(); i++)
+    {
+        const Security_Key& key = keys.at(picks.at(i));
+        tree.erase(key);
+        tree.insert(key, nullptr);
+    }
+    double erase_ns = elapsed_ms(start) * 1e6 / picks.size();
+
+    start = chrono::steady_clock::now();
+    tree.for_each([&checksum](typename Tree::Node* node)
+    {
+        checksum += node->key.market_value.to_double();
+    });
+    double walk_ms = elapsed_ms(start);
+
+    print_row(name, sizeof(typename Tree::Node), insert_ms, find_ns, erase_ns, walk_ms, checksum);
+}
+
+
+int main(int argc, char* argv[])
+{
+    size_t lot_count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 1000000;
+    if(lot_count == 0)
+    {
+        return 0;
+    }
+
+    //lots with unique tickets and random market values (whole cents up to $10M), the same for every tree
+    mt19937_64 random(2024);
+    vector<Security_Key> keys;
+    keys.reserve(lot_count);
+    for(size_t i = 0; i < lot_count; i++)
+    {
+        keys.push_back({Money::from_cents(random() % 1000000000), int(i)});
+    }
+    uniform_int_distribution<size_t> pick(0, lot_count - 1);
+    vector<size_t> picks;
+    picks.reserve(BENCHMARK_OPERATIONS);
+    for(int i = 0; i < BENCHMARK_OPERATIONS; i++)
+    {
+        picks.push_back(pick(random));
+    }
+
+    cout << endl << "Security keys - " << lot_count << " lots" << endl;
+    cout << setw(22) << "Tree" << setw(12) << "Node bytes" << setw(14) << "Insert ms" << setw(14) << "Find ns/op"
+         << setw(20) << "Erase+Add ns/op" << setw(12) << "Walk ms" << endl;
+    run_security_tree(keys, picks);
+    run_generic_tree<Byte_Color_Tree>("Generic byte color", keys, picks);
+    run_generic_tree<Packed_Color_Tree>("Generic packed color", keys, picks);
+    run_generic_tree<Compact_Tree>("Generic no parents", keys, picks);
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include "../money.h"
+#include "../generic_rbt.h"
+
+using namespace std;
+
+/*
+    Compares market values held as Money (whole cents in an int64) with the same values held as double. Both trees
+    are the generic red-black tree keyed on (market value, ticket), so the only difference is the key compare. Each
+    tree is timed on exact finds of known lots and lower bound searches for a needed amount; the aggregation step
+    sums every market value in a flat array, as the customer and index totals do.
+
+    Build from the project folder:
+        g++ -O2 -std=c++17 benchmark/money_benchmark.cpp -o money_benchmark
+    Run:
+        ./money_benchmark [lot count - 1000000 by default]
+*/
+
+#define BENCHMARK_OPERATIONS 1000000 //operations timed for each step
+#define SUM_PASSES 20                //passes over the array timed for the aggregation step
+
+
+/*------------------------------------------------------ Market Value Key Types -------------------------------------------------*/
+
+template <typename Amount>
+struct Value_Key
+{
+    Amount market_value;
+    int ticket;
+};
+
+template <typename Amount>
+struct Value_Key_Less
+{
+    bool operator()(const Value_Key<Amount>& first, const Value_Key<Amount>& second) const
+    {
+        return first.market_value < second.market_value
+               || (first.market_value == second.market_value && first.ticket < second.ticket);
+    }
+};
+
+Money to_amount(Money value, Money)
+{
+    return value;
+}
+
+double to_amount(Money value, double)
+{
+    return value.to_double();
+}
+
+double amount_to_double(Money value)
+{
+    return value.to_double();
+}
+
+double amount_to_double(double value)
+{
+    return value;
+}
+
+
+/*--------------------------------------------------- Benchmark Timing Functions -----------------------------------------------*/
+
+double elapsed_ms(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template <typename Amount>
+void run_amount(const string& name, const vector<Money>& values, const vector<size_t>& picks, const vector<Money>& needed)
+{
+    typedef Generic_RBT<Value_Key<Amount>, int, Value_Key_Less<Amount>> Value_Tree;
+    vector<Value_Key<Amount>> keys;
+    keys.reserve(values.size());
+    for(size_t i = 0; i < values.size(); i++)
+    {
+        keys.push_back({to_amount(values.at(i), Amount()), int(i)});
+    }
+    Value_Tree tree;
+    for(size_t i = 0; i < keys.size(); i++)
+    {
+        tree.insert(keys.at(i), keys.at(i).ticket);
+    }
+    double checksum = 0;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(size_t i = 0; i < picks.size(); i++)
+    {
+        checksum += tree.find(keys.at(picks.at(i)))->value;
+    }
+    double find_ns = elapsed_ms(start) * 1e6 / picks.size();
+
+    start = chrono::steady_clock::now();
+    for(size_t i = 0; i < needed.size(); i++)
+    {
+        typename Value_Tree::Node* lot = tree.lower_bound({to_amount(needed.at(i), Amount()), 0});
+        checksum += (lot != nullptr) ? lot->value : 0;
+    }
+    double lower_bound_ns = elapsed_ms(start) * 1e6 / needed.size();
+
+    vector<Amount> amounts;
+    amounts.reserve(keys.size());
+    for(size_t i = 0; i < keys.size(); i++)
+    {
+        amounts.push_back(keys.at(i).market_value);
+    }
+    Amount total = Amount();
+    start = chrono::steady_clock::now();
+    for(int pass = 0; pass < SUM_PASSES; pass++)
+    {
+        Amount sum = Amount();
+        for(size_t i = 0; i < amounts.size(); i++)
+        {
+            sum += amounts[i];
+        }
+        total += sum;
+    }
+    double sum_ms = elapsed_ms(start) / SUM_PASSES;
+
+    cout << fixed << setprecision(1)
+         << setw(10) << name
+         << setw(14) << find_ns
+         << setw(20) << lower_bound_ns
+         << setw(14) << setprecision(3) << sum_ms
+         << "    (checksum " << setprecision(0) << checksum << ", total " << setprecision(2)
+         << amount_to_double(total) / SUM_PASSES << ")" << endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    size_t lot_count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 1000000;
+    if(lot_count == 0)
+    {
+        return 0;
+    }
+
+    //lots with unique tickets and random market values (whole cents up to $10M), the same for both amount types
+    mt19937_64 random(2024);
+    vector<Money> values;
+    values.reserve(lot_count);
+    for(size_t i = 0; i < lot_count; i++)
+    {
+        values.push_back(Money::from_cents(random() % 1000000000));
+    }
+    uniform_int_distribution<size_t> pick(0, lot_count - 1);
+    vector<size_t> picks;
+    vector<Money> needed;
+    picks.reserve(BENCHMARK_OPERATIONS);
+    needed.reserve(BENCHMARK_OPERATIONS);
+    for(int i = 0; i < BENCHMARK_OPERATIONS; i++)
+    {
+        picks.push_back(pick(random));
+        needed.push_back(Money::from_cents(random() % 1000000000));
+    }
+
+    cout << endl << "Market values - " << lot_count << " lots" << endl;
+    cout << setw(10) << "Amount" << setw(14) << "Find ns/op" << setw(20) << "Lower bound ns/op"
+         << setw(14) << "Sum ms" << endl;
+    run_amount<double>("double", values, picks, needed);
+    run_amount<Money>("Money", values, picks, needed);
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include "../red_black_tree.h"
+
+using namespace std;
+
+/*
+    Compares the pledging range search (find_security, now take_security) on the tree node layout from before
+    the security records were split out with the compact tree node used now. The old node carried every field
+    of the security - seven strings, the color as a string and the market value as a double - next to its links;
+    the compact node holds only the key, links, color bit and a pointer to the record.
+
+    The same random lots are loaded into the security tree, and the old layout is linked into the exact shape
+    of that tree, so both searches visit the same nodes and only the memory they touch differs. Each is timed on
+    the range search update_customers runs (the first lot between the amount needed and 50% above it, found
+    without taking it out) and on an exact search for a known lot.
+
+    Build from the project folder:
+        g++ -O2 -std=c++17 benchmark/range_search_benchmark.cpp red_black_tree.cpp csv_reader.cpp -o range_search_benchmark -pthread
+    Run:
+        ./range_search_benchmark [lot count - 1000000 by default]
+*/
+
+#define BENCHMARK_OPERATIONS 1000000 //searches timed for each layout
+
+
+/*------------------------------------------------------ Pre-Split Tree Node ---------------------------------------------------*/
+
+//the security tree node as it was before the split - the record's fields and the tree links in one node
+struct Pre_Split_Node
+{
+    string portfolio;
+    string cusip;
+    int ticket;
+    string maturity;
+    int pledge_id;
+    string pledge_description;
+    double pledge_amount;
+    double par_value;
+    double market_value;
+    string group;
+    string security_description;
+
+    string change_status;
+
+    string node_color; // black or red
+    Pre_Split_Node* parent = nullptr;
+    Pre_Split_Node* left_child = nullptr;
+    Pre_Split_Node* right_child = nullptr;
+};
+
+//links the old layout nodes into the shape of the security tree - each lot's ticket is its position in old_nodes
+Pre_Split_Node* mirror_tree(RBT_Node* node, vector<Pre_Split_Node>& old_nodes, Pre_Split_Node* parent)
+{
+    if(node == nullptr)
+    {
+        return nullptr;
+    }
+    Pre_Split_Node* copy = &old_nodes.at(node->key.ticket);
+    copy->node_color = node->is_red() ? "red" : "black";
+    copy->parent = parent;
+    copy->left_child = mirror_tree(node->left(), old_nodes, copy);
+    copy->right_child = mirror_tree(node->right(), old_nodes, copy);
+    return copy;
+}
+
+
+/*------------------------------------------------------ Range Search Functions ------------------------------------------------*/
+
+//find_security as it was before the split
+Pre_Split_Node* pre_split_find_security(Pre_Split_Node* root, double min, double max)
+{
+    Pre_Split_Node* cursor = root;
+    while(cursor != nullptr)
+    {
+        if(cursor->market_value >= min && cursor->market_value <= max)
+        {
+            return cursor;
+        }
+        else if(min < cursor->market_value)
+        {
+            cursor = cursor->left_child;
+        }
+        else
+        {
+            cursor = cursor->right_child;
+        }
+    }
+    return nullptr;
+}
+
+//the search take_security runs on the compact nodes, without taking the node out
+RBT_Node* compact_find_security(RBT_Node* root, Money min, Money max)
+{
+    RBT_Node* cursor = root;
+    while(cursor != nullptr)
+    {
+        if(cursor->key.market_value >= min && cursor->key.market_value <= max)
+        {
+            return cursor;
+        }
+        else if(min < cursor->key.market_value)
+        {
+            cursor = cursor->left();
+        }
+        else
+        {
+            cursor = cursor->right();
+        }
+    }
+    return nullptr;
+}
+
+//the exact search for a lot by market value and ticket on the old layout
+Pre_Split_Node* pre_split_find_node(Pre_Split_Node* root, double market_value, int ticket)
+{
+    Pre_Split_Node* cursor = root;
+    while(cursor != nullptr && (cursor->market_value != market_value || cursor->ticket != ticket))
+    {
+        bool less = market_value < cursor->market_value || (market_value == cursor->market_value && ticket < cursor->ticket);
+        cursor = less ? cursor->left_child : cursor->right_child;
+    }
+    return cursor;
+}
+
+
+/*--------------------------------------------------- Benchmark Timing Functions -----------------------------------------------*/
+
+double elapsed_ns(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / BENCHMARK_OPERATIONS;
+}
+
+void print_row(const string& search, double before_ns, double after_ns, bool same)
+{
+    cout << setw(16) << search << setw(16) << before_ns << setw(16) << after_ns
+         << setw(12) << before_ns / after_ns << "x" << setw(14) << (same ? "Passed" : "Failed") << endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+    size_t lot_count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 1000000;
+    if(lot_count == 0)
+    {
+        return 0;
+    }
+
+    //lots with unique tickets and random market values (whole cents up to $10M), in the same order for both
+    //layouts so both are allocated in load order
+    mt19937_64 random(2024);
+    vector<RBT_Security_Node*> securities;
+    vector<Pre_Split_Node> old_nodes(lot_count);
+    for(size_t i = 0; i < lot_count; i++)
+    {
+        RBT_Security_Node* security = new RBT_Security_Node;
+        security->portfolio = "Justin Investments LLC";
+        security->cusip = "3131" + to_string(random() % 100000);
+        security->ticket = i;
+        security->maturity = "12/31/2035";
+        security->pledge_id = 0;
+        security->market_value = Money::from_cents(random() % 1000000000);
+        security->par_value = security->market_value;
+        security->group = "MBS";
+        security->security_description = "Federal Home Loan Mortgage Corp";
+        securities.push_back(security);
+
+        Pre_Split_Node& old_node = old_nodes.at(i);
+        old_node.portfolio = security->portfolio;
+        old_node.cusip = security->cusip;
+        old_node.ticket = security->ticket;
+        old_node.maturity = security->maturity;
+        old_node.pledge_id = 0;
+        old_node.pledge_amount = 0;
+        old_node.par_value = security->par_value.to_double();
+        old_node.market_value = security->market_value.to_double();
+        old_node.group = security->group;
+        old_node.security_description = security->security_description;
+    }
+    RBT tree;
+    tree.RBT_bulk_add(securities);
+    Pre_Split_Node* old_root = mirror_tree(tree.get_root(), old_nodes, nullptr);
+
+    cout << endl << "Range search - " << lot_count << " lots" << endl;
+    cout << "Pre-split node: " << sizeof(Pre_Split_Node) << " bytes  Compact node: " << sizeof(RBT_Node) << " bytes" << endl;
+    cout << setw(16) << "Search" << setw(16) << "Before ns/op" << setw(16) << "After ns/op"
+         << setw(13) << "Speedup" << setw(14) << "Same Lots" << endl;
+    cout << fixed << setprecision(1);
+
+    //the amounts needed are drawn once, so both layouts search for the same ranges
+    vector<int64_t> needed(BENCHMARK_OPERATIONS);
+    for(int64_t& cents : needed)
+    {
+        cents = random() % 1000000000;
+    }
+    long long before_checksum = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int64_t cents : needed)
+    {
+        Pre_Split_Node* found = pre_split_find_security(old_root, cents / 100.0, cents * 1.5 / 100.0);
+        before_checksum += (found == nullptr) ? -1 : found->ticket;
+    }
+    double before_ns = elapsed_ns(start);
+    long long after_checksum = 0;
+    start = chrono::steady_clock::now();
+    for(int64_t cents : needed)
+    {
+        Money min = Money::from_cents(cents);
+        RBT_Node* found = compact_find_security(tree.get_root(), min, min.scaled(1.5));
+        after_checksum += (found == nullptr) ? -1 : found->key.ticket;
+    }
+    print_row("Range", before_ns, elapsed_ns(start), before_checksum == after_checksum);
+
+    //known lots picked at random
+    vector<size_t> picks(BENCHMARK_OPERATIONS);
+    for(size_t& pick : picks)
+    {
+        pick = random() % lot_count;
+    }
+    before_checksum = 0;
+    start = chrono::steady_clock::now();
+    for(size_t pick : picks)
+    {
+        before_checksum += pre_split_find_node(old_root, old_nodes.at(pick).market_value, old_nodes.at(pick).ticket)->ticket;
+    }
+    before_ns = elapsed_ns(start);
+    after_checksum = 0;
+    start = chrono::steady_clock::now();
+    for(size_t pick : picks)
+    {
+        after_checksum += tree.find(securities.at(pick)->ticket, securities.at(pick)->market_value)->key.ticket;
+    }
+    print_row("Exact", before_ns, elapsed_ns(start), before_checksum == after_checksum);
+
+    //the tree deletes the records it holds
+    tree.clear();
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include "../security_index.h"
+
+using namespace std;
+
+/*
+    Compares the security index backends. Each backend is given the same securities - those in each demo
+    security file and then a synthetic file of random lots - and timed on a bulk load followed by the
+    operations the pledging functions perform: ranged take and re-add, smallest / largest lookups and
+    removal of a known record.
+
+    Build from the project folder:
+        g++ -O2 -std=c++17 benchmark/security_index_benchmark.cpp red_black_tree.cpp csv_reader.cpp security_index.cpp bplus_tree.cpp -o index_benchmark -pthread
+    Run:
+        ./index_benchmark [synthetic lot count - 10000000 by default]
+*/
+
+#define BENCHMARK_OPERATIONS 1000000 //operations timed for each step
+
+
+/*----------------------------------------------------- Benchmark Input Functions ----------------------------------------------*/
+
+//reads every security in a security csv file, returns an empty vector if the file cannot be opened
+vector<RBT_Security_Node*> load_demo_securities(const string& file_name)
+{
+    vector<RBT_Security_Node*> securities;
+    ifstream security_file(file_name);
+    string security_line;
+    getline(security_file, security_line);
+    while(getline(security_file, security_line))
+    {
+        stringstream security_detail_line(security_line);
+        string temp_string;
+        vector<string> temp_vector;
+        while(getline(security_detail_line, temp_string, ','))
+        {
+            temp_vector.push_back(temp_string);
+        }
+        securities.push_back(RBT::build_security_node(temp_vector));
+    }
+    return securities;
+}
+
+//builds lots with unique tickets and random market values (whole cents up to $10M)
+vector<RBT_Security_Node*> make_synthetic_securities(size_t lot_count, mt19937_64& random)
+{
+    vector<RBT_Security_Node*> securities;
+    securities.reserve(lot_count);
+    for(size_t i = 0; i < lot_count; i++)
+    {
+        RBT_Security_Node* security = new RBT_Security_Node;
+        security->ticket = i;
+        security->pledge_id = 0;
+        security->market_value = Money::from_cents(random() % 1000000000);
+        securities.push_back(security);
+    }
+    return securities;
+}
+
+
+/*--------------------------------------------------- Benchmark Timing Functions -----------------------------------------------*/
+
+double elapsed_ms(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+void run_backend(const string& backend, vector<RBT_Security_Node*>& securities, Money largest_value)
+{
+    Security_Index* index = create_security_index(backend);
+    mt19937_64 random(7);
+    uniform_int_distribution<int64_t> value(0, largest_value.in_cents());
+    uniform_int_distribution<size_t> pick(0, securities.size() - 1);
+    double checksum = 0;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    index->bulk_add(securities);
+    double load_ms = elapsed_ms(start);
+
+    //the pledging search - take a security within 50% above the amount needed, then put it back
+    start = chrono::steady_clock::now();
+    for(int i = 0; i < BENCHMARK_OPERATIONS; i++)
+    {
+        Money needed = Money::from_cents(value(random));
+        RBT_Security_Node* security = index->take_security(needed, needed.scaled(1.5));
+        if(security != nullptr)
+        {
+            checksum += security->market_value.to_double();
+            index->add_security(security);
+        }
+    }
+    double take_ns = elapsed_ms(start) * 1e6 / BENCHMARK_OPERATIONS;
+
+    start = chrono::steady_clock::now();
+    for(int i = 0; i < BENCHMARK_OPERATIONS; i++)
+    {
+        checksum += (index->smallest_security()->market_value + index->largest_security()->market_value).to_double();
+    }
+    double extreme_ns = elapsed_ms(start) * 1e6 / BENCHMARK_OPERATIONS;
+
+    //taking a known security back out, as update_customers does with the small method securities
+    start = chrono::steady_clock::now();
+    for(int i = 0; i < BENCHMARK_OPERATIONS; i++)
+    {
+        RBT_Security_Node* security = securities.at(pick(random));
+        index->remove_security(security);
+        index->add_security(security);
+    }
+    double remove_ns = elapsed_ms(start) * 1e6 / BENCHMARK_OPERATIONS;
+
+    cout << fixed << setprecision(1)
+         << setw(16) << index->backend_name()
+         << setw(14) << load_ms
+         << setw(18) << take_ns
+         << setw(18) << extreme_ns
+         << setw(20) << remove_ns
+         << "    (checksum " << setprecision(0) << checksum << ")" << endl;
+
+    //the records go back to the caller so the next backend can load the same securities
+    index->release_all();
+    delete index;
+}
+
+void run_all_backends(const string& title, vector<RBT_Security_Node*>& securities)
+{
+    if(securities.empty())
+    {
+        cout << endl << title << " - no securities loaded, skipped" << endl;
+        return;
+    }
+    Money largest_value;
+    for(size_t i = 0; i < securities.size(); i++)
+    {
+        largest_value = max(largest_value, securities.at(i)->market_value);
+    }
+    cout << endl << title << " - " << securities.size() << " securities" << endl;
+    cout << setw(16) << "Backend" << setw(14) << "Load ms" << setw(18) << "Take+Add ns/op"
+         << setw(18) << "Min+Max ns/op" << setw(20) << "Remove+Add ns/op" << endl;
+    run_backend("rbt", securities, largest_value);
+    run_backend("bplus", securities, largest_value);
+    for(size_t i = 0; i < securities.size(); i++)
+    {
+        delete securities.at(i);
+    }
+    securities.clear();
+}
+
+
+int main(int argc, char* argv[])
+{
+    size_t lot_count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 10000000;
+
+    const string demo_files[] = {"securities_demo_exact.csv", "securities_demo_tree.csv", "securities_demo.csv"};
+    for(const string& file_name : demo_files)
+    {
+        vector<RBT_Security_Node*> securities = load_demo_securities(file_name);
+        run_all_backends(file_name, securities);
+    }
+
+    mt19937_64 random(2024);
+    vector<RBT_Security_Node*> securities = make_synthetic_securities(lot_count, random);
+    run_all_backends("Synthetic lots", securities);
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include "../supporting_func_structs.h"
+#include "../state_image.h"
+
+using namespace std;
+
+/*
+    Compares the two ways a session can get to the loaded state: importing the customer and security csv files,
+    or restoring the state image saved after the import. A synthetic customer file and security file are written
+    (a third of the securities pledged to customers), imported once and saved to an image. Then the image is
+    timed on opening alone (the header and checksum check, after which it can be searched in place), on the
+    source file check, and on a full restore into a new index. Both ways are checked to give the same totals.
+
+    Build from the project folder:
+        g++ -O2 -std=c++17 benchmark/state_image_benchmark.cpp state_image.cpp supporting_func_structs.cpp red_black_tree.cpp csv_reader.cpp security_index.cpp bplus_tree.cpp state_journal.cpp security_catalog.cpp customer_store.cpp deficit_queue.cpp allocation_engine.cpp -o state_image_benchmark -pthread
+    Run:
+        ./state_image_benchmark [security count - 1000000 by default]
+*/
+
+#define BENCHMARK_CUSTOMER_FILE "state_image_benchmark_customers.csv" //all three files are written to the working
+#define BENCHMARK_SECURITY_FILE "state_image_benchmark_securities.csv" //folder and removed at the end
+#define BENCHMARK_IMAGE_FILE "state_image_benchmark.img"
+
+
+/*----------------------------------------------------- Benchmark Input Functions ----------------------------------------------*/
+
+string cents_text(uint64_t cents)
+{
+    return to_string(cents / 100) + ((cents % 100 < 10) ? ".0" : ".") + to_string(cents % 100);
+}
+
+void write_source_files(size_t security_count, size_t customer_count)
+{
+    mt19937_64 random(2024);
+    ofstream customer_file(BENCHMARK_CUSTOMER_FILE);
+    customer_file << "Pledge ID,Tax ID Number,Name1,Name2,Account Number,Effective Interest Rate,Account Type,"
+                  << "Class Code Description,Current Balance" << endl;
+    for(size_t i = 0; i < customer_count * 2; i++)
+    {
+        size_t customer = i / 2;
+        customer_file << (customer + 10000) << "," << (2000000000 + customer) << ",Customer " << customer << ",,"
+                      << (300000 + i) << ",1.00%,DDA,Demand Deposit," << cents_text(random() % 100000000) << "\n";
+    }
+
+    ofstream security_file(BENCHMARK_SECURITY_FILE);
+    security_file << "Portfolio,CUSIP,Ticket,Maturity Date,Pledge ID,Pledge Description,Pledge Amount,Par Value,"
+                  << "Market Value,Group,Security Description" << endl;
+    for(size_t i = 0; i < security_count; i++)
+    {
+        string value = cents_text(random() % 1000000000);
+        security_file << "Justin Investments LLC,3131" << (random() % 100000) << "," << i << ","
+                      << (random() % 12 + 1) << "/" << (random() % 28 + 1) << "/" << (2024 + random() % 30) << ","
+                      << ((i % 3 == 0) ? to_string(random() % customer_count + 10000) : "") << ",,"
+                      << value << "," << value << "," << value << ",MBS,Security Name\n";
+    }
+}
+
+
+/*--------------------------------------------------- Benchmark Timing Functions -----------------------------------------------*/
+
+double elapsed_ms(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+Money customer_total(Customer_Store& customers)
+{
+    Money total;
+    const Money* over_under = customers.over_under_column();
+    for(size_t i = 0; i < customers.size(); i++)
+    {
+        total += over_under[i];
+    }
+    return total;
+}
+
+
+int main(int argc, char* argv[])
+{
+    size_t security_count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 1000000;
+    if(security_count == 0)
+    {
+        return 0;
+    }
+    size_t customer_count = security_count / 10 + 1;
+    write_source_files(security_count, customer_count);
+
+    cout << endl << "Loaded state - " << security_count << " securities, " << customer_count << " customers" << endl;
+    cout << setw(24) << "Step" << setw(14) << "ms" << endl;
+
+    //the csv import, as menu options 1 and 2 run it
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    RBT_Security_Index imported_index;
+    Mapped_File customer_file;
+    customer_file.open(BENCHMARK_CUSTOMER_FILE);
+    Customer_Store imported_customers = load_customer_data(customer_file);
+    vector<RBT_Security_Node*> imported_removals;
+    Mapped_File security_file;
+    security_file.open(BENCHMARK_SECURITY_FILE);
+    import_and_build_security_index(imported_customers, imported_removals, security_file, imported_index);
+    cout << fixed << setprecision(2) << setw(24) << "Csv import" << setw(14) << elapsed_ms(start) << endl;
+
+    start = chrono::steady_clock::now();
+    bool saved = State_Image::save(BENCHMARK_IMAGE_FILE, BENCHMARK_CUSTOMER_FILE, BENCHMARK_SECURITY_FILE,
+                                   imported_index, imported_customers, imported_removals);
+    cout << setw(24) << "Image save" << setw(14) << elapsed_ms(start) << (saved ? "" : "    (failed)") << endl;
+
+    start = chrono::steady_clock::now();
+    State_Image image;
+    bool opened = image.open(BENCHMARK_IMAGE_FILE);
+    cout << setw(24) << "Image open" << setw(14) << elapsed_ms(start) << (opened ? "" : "    (failed)") << endl;
+
+    start = chrono::steady_clock::now();
+    bool sources_match = image.sources_match();
+    cout << setw(24) << "Source file check" << setw(14) << elapsed_ms(start) << (sources_match ? "" : "    (failed)") << endl;
+
+    start = chrono::steady_clock::now();
+    double checksum = 0;
+    for(int i = 0; i < 1000; i++)
+    {
+        size_t lot = image.lower_bound(Money::from_cents(i * 1000000));
+        checksum += (lot < image.free_count()) ? image.securities()[lot].ticket : 0;
+    }
+    cout << setw(24) << "1000 in-place searches" << setw(14) << elapsed_ms(start) << "    (checksum "
+         << setprecision(0) << checksum << ")" << setprecision(2) << endl;
+
+    start = chrono::steady_clock::now();
+    RBT_Security_Index restored_index;
+    Customer_Store restored_customers;
+    vector<RBT_Security_Node*> restored_removals;
+    image.restore(restored_index, restored_customers, restored_removals);
+    cout << setw(24) << "Image restore" << setw(14) << elapsed_ms(start) << endl;
+
+    bool same = restored_index.security_count() == imported_index.security_count()
+                && restored_index.market_value_total() == imported_index.market_value_total()
+                && restored_customers.size() == imported_customers.size()
+                && customer_total(restored_customers) == customer_total(imported_customers)
+                && restored_removals.size() == imported_removals.size();
+    cout << endl << "Restored State Matches Import: " << (same ? "Passed" : "Failed") << endl;
+
+    clear_customers(imported_customers);
+    clear_customers(restored_customers);
+    clear_vector(imported_removals);
+    clear_vector(restored_removals);
+    image.close();
+    remove(BENCHMARK_CUSTOMER_FILE);
+    remove(BENCHMARK_SECURITY_FILE);
+    remove(BENCHMARK_IMAGE_FILE);
+    return 0;
+}
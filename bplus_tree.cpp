@@ -0,0 +1,1037 @@
+#include "bplus_tree.h"
+
+using namespace std;
+
+
+/*------------------------------------------------- B+ Tree Node Pool Functions ------------------------------------------------*/
+
+void* BPlus_Leaf::operator new(size_t size)
+{
+    return pool().allocate(size);
+}
+
+void BPlus_Leaf::operator delete(void* node, size_t size)
+{
+    pool().release(node, size);
+}
+
+Node_Pool<BPlus_Leaf>& BPlus_Leaf::pool()
+{
+    static Node_Pool<BPlus_Leaf> leaf_pool;
+    return leaf_pool;
+}
+
+void* BPlus_Inner::operator new(size_t size)
+{
+    return pool().allocate(size);
+}
+
+void BPlus_Inner::operator delete(void* node, size_t size)
+{
+    pool().release(node, size);
+}
+
+Node_Pool<BPlus_Inner>& BPlus_Inner::pool()
+{
+    static Node_Pool<BPlus_Inner> inner_pool;
+    return inner_pool;
+}
+
+
+/*------------------------------------------------ B+ Tree Constructor / Deconstructor -----------------------------------------*/
+
+BPlus_Tree::BPlus_Tree(){}
+
+BPlus_Tree::~BPlus_Tree()
+{
+    delete_nodes(root, height, true);
+}
+
+string BPlus_Tree::backend_name()
+{
+    return "B+ Tree";
+}
+
+
+/*---------------------------------------------- B+ Tree Public Add and Remove Functions ---------------------------------------*/
+
+void BPlus_Tree::add_security(RBT_Security_Node* security)
+{
+    entry_count++;
+    total_value += security->market_value;
+    if(root == nullptr)
+    {
+        root = new BPlus_Leaf;
+        height = 1;
+    }
+    BPlus_Leaf* leaf = find_leaf(security->market_value, security->ticket, true);
+
+    //new entries go after every entry with an equal key
+    int position = 0;
+    while(position < leaf->count
+          && !key_less(security->market_value, security->ticket, leaf->market_value[position], leaf->ticket[position]))
+    {
+        position++;
+    }
+    if(leaf->count < BPLUS_SLOTS)
+    {
+        insert_into_leaf(leaf, position, security);
+        return;
+    }
+
+    //the leaf is full - move its upper half into a new leaf, then add the entry to whichever half covers its position
+    BPlus_Leaf* right = new BPlus_Leaf;
+    int half = BPLUS_SLOTS / 2;
+    for(int i = half; i < BPLUS_SLOTS; i++)
+    {
+        right->market_value[i - half] = leaf->market_value[i];
+        right->ticket[i - half] = leaf->ticket[i];
+        right->record[i - half] = leaf->record[i];
+    }
+    right->count = BPLUS_SLOTS - half;
+    leaf->count = half;
+    right->next = leaf->next;
+    if(right->next != nullptr)
+    {
+        right->next->previous = right;
+    }
+    right->previous = leaf;
+    leaf->next = right;
+    right->parent = leaf->parent;
+
+    if(position > half)
+    {
+        insert_into_leaf(right, position - half, security);
+    }
+    else
+    {
+        insert_into_leaf(leaf, position, security);
+    }
+    insert_into_parent(leaf, right->market_value[0], right->ticket[0], right, true);
+}
+
+void BPlus_Tree::bulk_add(const vector<RBT_Security_Node*>& securities)
+{
+    if(securities.empty())
+    {
+        return;
+    }
+    size_t total = entry_count + securities.size();
+    //same trade off as the red-black tree - a few securities going into a large tree are inserted one at a time
+    if(entry_count > 0 && securities.size() * log2(total) < total)
+    {
+        for(size_t i = 0; i < securities.size(); i++)
+        {
+            add_security(securities.at(i));
+        }
+        return;
+    }
+
+    vector<BPlus_Entry> new_entries;
+    new_entries.reserve(securities.size());
+    for(size_t i = 0; i < securities.size(); i++)
+    {
+        new_entries.push_back({securities.at(i)->market_value, securities.at(i)->ticket, securities.at(i)});
+    }
+    sort(new_entries.begin(), new_entries.end(), entry_less);
+
+    //the entries already in the tree come off the leaf links in order, so they only need to be merged in
+    vector<BPlus_Entry> existing_entries;
+    existing_entries.reserve(entry_count);
+    collect_entries(existing_entries);
+    vector<BPlus_Entry> all_entries(total);
+    merge(existing_entries.begin(), existing_entries.end(), new_entries.begin(), new_entries.end(), all_entries.begin(), entry_less);
+
+    delete_nodes(root, height, false);
+    build_from_sorted(all_entries);
+}
+
+RBT_Security_Node* BPlus_Tree::take_security(Money min, Money max)
+{
+    BPlus_Leaf* leaf;
+    int position;
+    //the first entry at or above min is the smallest security that could be in range
+    if(!lower_bound(min, INT_MIN, leaf, position) || leaf->market_value[position] > max)
+    {
+        return nullptr;
+    }
+    RBT_Security_Node* security = leaf->record[position];
+    remove_entry(leaf, position);
+    return security;
+}
+
+bool BPlus_Tree::remove_security(RBT_Security_Node* security)
+{
+    BPlus_Leaf* leaf;
+    int position;
+    if(!lower_bound(security->market_value, security->ticket, leaf, position))
+    {
+        return false;
+    }
+    //identical lots share a key - walk the equal keys, across leaves if needed, until this exact record is found
+    while(leaf != nullptr && leaf->market_value[position] == security->market_value && leaf->ticket[position] == security->ticket)
+    {
+        if(leaf->record[position] == security)
+        {
+            remove_entry(leaf, position);
+            return true;
+        }
+        position++;
+        if(position == leaf->count)
+        {
+            leaf = leaf->next;
+            position = 0;
+        }
+    }
+    return false;
+}
+
+RBT_Security_Node* BPlus_Tree::take_smallest()
+{
+    if(root == nullptr)
+    {
+        return nullptr;
+    }
+    BPlus_Leaf* leaf = first_leaf();
+    RBT_Security_Node* security = leaf->record[0];
+    remove_entry(leaf, 0);
+    return security;
+}
+
+RBT_Security_Node* BPlus_Tree::take_largest()
+{
+    if(root == nullptr)
+    {
+        return nullptr;
+    }
+    BPlus_Leaf* leaf = last_leaf();
+    RBT_Security_Node* security = leaf->record[leaf->count - 1];
+    remove_entry(leaf, leaf->count - 1);
+    return security;
+}
+
+RBT_Security_Node* BPlus_Tree::erase(int ticket, Money market_value)
+{
+    BPlus_Leaf* leaf;
+    int position;
+    if(!lower_bound(market_value, ticket, leaf, position)
+       || leaf->market_value[position] != market_value || leaf->ticket[position] != ticket)
+    {
+        return nullptr;
+    }
+    RBT_Security_Node* security = leaf->record[position];
+    remove_entry(leaf, position);
+    return security;
+}
+
+void BPlus_Tree::release_all()
+{
+    delete_nodes(root, height, false);
+    root = nullptr;
+    height = 0;
+    entry_count = 0;
+    total_value = Money();
+}
+
+
+/*------------------------------------------------- B+ Tree Public Lookup Functions --------------------------------------------*/
+
+RBT_Security_Node* BPlus_Tree::smallest_security()
+{
+    BPlus_Leaf* leaf = first_leaf();
+    return leaf == nullptr ? nullptr : leaf->record[0];
+}
+
+RBT_Security_Node* BPlus_Tree::largest_security()
+{
+    BPlus_Leaf* leaf = last_leaf();
+    return leaf == nullptr ? nullptr : leaf->record[leaf->count - 1];
+}
+
+int BPlus_Tree::security_count()
+{
+    return entry_count;
+}
+
+Money BPlus_Tree::market_value_total()
+{
+    return total_value;
+}
+
+void BPlus_Tree::collect_securities(vector<RBT_Security_Node*>& securities)
+{
+    securities.reserve(securities.size() + entry_count);
+    for(BPlus_Leaf* leaf = first_leaf(); leaf != nullptr; leaf = leaf->next)
+    {
+        securities.insert(securities.end(), leaf->record, leaf->record + leaf->count);
+    }
+}
+
+size_t BPlus_Tree::memory_footprint()
+{
+    return sizeof(BPlus_Tree) + node_footprint(root, height);
+}
+
+
+/*-------------------------------------------------- B+ Tree Public Test Functions ---------------------------------------------*/
+
+void BPlus_Tree::print_index()
+{
+    if(root != nullptr)
+    {
+        print_node(root, height, 0);
+    }
+}
+
+bool BPlus_Validation_Report::valid() const
+{
+    return keys_ordered && node_occupancy && parent_links && leaf_links && count_and_total && records_match;
+}
+
+BPlus_Validation_Report BPlus_Tree::validate()
+{
+    BPlus_Validation_Report report;
+    if(root != nullptr)
+    {
+        test_node(root, height, nullptr, nullptr, nullptr, report);
+    }
+    test_leaf_chain(report);
+    return report;
+}
+
+void BPlus_Tree::run_tests()
+{
+    BPlus_Validation_Report report = validate();
+    cout << endl;
+    cout << "B+ Tree Key Order: " << (report.keys_ordered ? "Correct" : "Incorrect") << endl;
+    cout << "B+ Tree Node Occupancy: " << (report.node_occupancy ? "Correct" : "Incorrect") << endl;
+    cout << "B+ Tree Parent Links: " << (report.parent_links ? "Correct" : "Incorrect") << endl;
+    cout << "B+ Tree Leaf Links: " << (report.leaf_links ? "Correct" : "Incorrect") << endl;
+    cout << "B+ Tree Security Count and Total: " << (report.count_and_total ? "Correct" : "Incorrect") << endl;
+    cout << "B+ Tree Record Values: " << (report.records_match ? "Correct" : "Incorrect") << endl;
+    if(report.valid())
+    {
+        cout << endl << "B+ Tree Invariants Are Correct" << endl;
+    }
+    else
+    {
+        cout << endl << "B+ Tree Invariants Are Incorrect" << endl;
+    }
+    cout << endl << "B+ Tree Height: " << height << " Levels" << endl << endl;
+}
+
+void BPlus_Tree::print_node_usage()
+{
+    cout << "B+ Tree Leaves Live: " << BPlus_Leaf::pool().live_count()
+         << "  Peak: " << BPlus_Leaf::pool().peak_count() << endl;
+    cout << "B+ Tree Inner Nodes Live: " << BPlus_Inner::pool().live_count()
+         << "  Peak: " << BPlus_Inner::pool().peak_count() << endl;
+}
+
+
+/*----------------------------------------------- B+ Tree Private Search Helper Functions --------------------------------------*/
+
+bool BPlus_Tree::key_less(Money first_value, int first_ticket, Money second_value, int second_ticket)
+{
+    if(first_value != second_value)
+    {
+        return first_value < second_value;
+    }
+    return first_ticket < second_ticket;
+}
+
+BPlus_Leaf* BPlus_Tree::find_leaf(Money market_value, int ticket, bool after_equal)
+{
+    void* cursor = root;
+    for(int level = height; level > 1; level--)
+    {
+        BPlus_Inner* node = static_cast<BPlus_Inner*>(cursor);
+        //take the first child whose separator is above the key (after_equal) or not below it
+        int child = 0;
+        while(child < node->count - 1)
+        {
+            bool go_left = after_equal
+                ? key_less(market_value, ticket, node->market_value[child], node->ticket[child])
+                : !key_less(node->market_value[child], node->ticket[child], market_value, ticket);
+            if(go_left)
+            {
+                break;
+            }
+            child++;
+        }
+        cursor = node->children[child];
+    }
+    return static_cast<BPlus_Leaf*>(cursor);
+}
+
+bool BPlus_Tree::lower_bound(Money market_value, int ticket, BPlus_Leaf*& leaf, int& position)
+{
+    if(root == nullptr)
+    {
+        return false;
+    }
+    leaf = find_leaf(market_value, ticket, false);
+    position = 0;
+    while(position < leaf->count && key_less(leaf->market_value[position], leaf->ticket[position], market_value, ticket))
+    {
+        position++;
+    }
+    //every entry of this leaf is smaller - the first entry of the next leaf is the bound
+    if(position == leaf->count)
+    {
+        leaf = leaf->next;
+        position = 0;
+    }
+    return leaf != nullptr;
+}
+
+BPlus_Leaf* BPlus_Tree::first_leaf()
+{
+    void* cursor = root;
+    for(int level = height; level > 1; level--)
+    {
+        cursor = static_cast<BPlus_Inner*>(cursor)->children[0];
+    }
+    return static_cast<BPlus_Leaf*>(cursor);
+}
+
+BPlus_Leaf* BPlus_Tree::last_leaf()
+{
+    void* cursor = root;
+    for(int level = height; level > 1; level--)
+    {
+        BPlus_Inner* node = static_cast<BPlus_Inner*>(cursor);
+        cursor = node->children[node->count - 1];
+    }
+    return static_cast<BPlus_Leaf*>(cursor);
+}
+
+
+/*---------------------------------------------- B+ Tree Private Insert and Remove Functions -----------------------------------*/
+
+void BPlus_Tree::insert_into_leaf(BPlus_Leaf* leaf, int position, RBT_Security_Node* security)
+{
+    for(int i = leaf->count; i > position; i--)
+    {
+        leaf->market_value[i] = leaf->market_value[i - 1];
+        leaf->ticket[i] = leaf->ticket[i - 1];
+        leaf->record[i] = leaf->record[i - 1];
+    }
+    leaf->market_value[position] = security->market_value;
+    leaf->ticket[position] = security->ticket;
+    leaf->record[position] = security;
+    leaf->count++;
+}
+
+void BPlus_Tree::insert_into_parent(void* left, Money market_value, int ticket, void* right, bool leaves)
+{
+    BPlus_Inner* parent = leaves ? static_cast<BPlus_Leaf*>(left)->parent : static_cast<BPlus_Inner*>(left)->parent;
+    if(parent == nullptr)
+    {
+        //the root was split, so the tree grows a level
+        BPlus_Inner* new_root = new BPlus_Inner;
+        new_root->leaf_children = leaves;
+        new_root->children[0] = left;
+        new_root->children[1] = right;
+        new_root->market_value[0] = market_value;
+        new_root->ticket[0] = ticket;
+        new_root->count = 2;
+        adopt_child(new_root, 0);
+        adopt_child(new_root, 1);
+        root = new_root;
+        height++;
+        return;
+    }
+    int index = child_index(parent, left);
+    if(parent->count < BPLUS_SLOTS)
+    {
+        for(int i = parent->count; i > index + 1; i--)
+        {
+            parent->children[i] = parent->children[i - 1];
+            parent->market_value[i - 1] = parent->market_value[i - 2];
+            parent->ticket[i - 1] = parent->ticket[i - 2];
+        }
+        parent->children[index + 1] = right;
+        parent->market_value[index] = market_value;
+        parent->ticket[index] = ticket;
+        parent->count++;
+        adopt_child(parent, index + 1);
+        return;
+    }
+
+    //the parent is full as well - line its children up with the new one and split them between two inner nodes
+    void* children[BPLUS_SLOTS + 1];
+    Money separator_values[BPLUS_SLOTS];
+    int separator_tickets[BPLUS_SLOTS];
+    for(int i = 0, from = 0; i < BPLUS_SLOTS + 1; i++)
+    {
+        children[i] = (i == index + 1) ? right : parent->children[from++];
+    }
+    for(int i = 0, from = 0; i < BPLUS_SLOTS; i++)
+    {
+        if(i == index)
+        {
+            separator_values[i] = market_value;
+            separator_tickets[i] = ticket;
+        }
+        else
+        {
+            separator_values[i] = parent->market_value[from];
+            separator_tickets[i] = parent->ticket[from];
+            from++;
+        }
+    }
+    int left_count = (BPLUS_SLOTS + 1) / 2;
+    BPlus_Inner* sibling = new BPlus_Inner;
+    sibling->leaf_children = parent->leaf_children;
+    sibling->parent = parent->parent;
+    parent->count = left_count;
+    sibling->count = BPLUS_SLOTS + 1 - left_count;
+    for(int i = 0; i < left_count; i++)
+    {
+        parent->children[i] = children[i];
+        adopt_child(parent, i);
+    }
+    for(int i = 0; i < left_count - 1; i++)
+    {
+        parent->market_value[i] = separator_values[i];
+        parent->ticket[i] = separator_tickets[i];
+    }
+    for(int i = 0; i < sibling->count; i++)
+    {
+        sibling->children[i] = children[left_count + i];
+        adopt_child(sibling, i);
+    }
+    for(int i = 0; i < sibling->count - 1; i++)
+    {
+        sibling->market_value[i] = separator_values[left_count + i];
+        sibling->ticket[i] = separator_tickets[left_count + i];
+    }
+    //the separator between the two halves moves up a level
+    insert_into_parent(parent, separator_values[left_count - 1], separator_tickets[left_count - 1], sibling, false);
+}
+
+void BPlus_Tree::remove_entry(BPlus_Leaf* leaf, int position)
+{
+    entry_count--;
+    total_value -= leaf->market_value[position];
+    for(int i = position; i < leaf->count - 1; i++)
+    {
+        leaf->market_value[i] = leaf->market_value[i + 1];
+        leaf->ticket[i] = leaf->ticket[i + 1];
+        leaf->record[i] = leaf->record[i + 1];
+    }
+    leaf->count--;
+    if(leaf->parent == nullptr)
+    {
+        //a root leaf may hold any number of entries, the tree is only empty once it holds none
+        if(leaf->count == 0)
+        {
+            delete leaf;
+            root = nullptr;
+            height = 0;
+        }
+        return;
+    }
+    if(leaf->count < BPLUS_MIN_SLOTS)
+    {
+        rebalance_leaf(leaf);
+    }
+}
+
+void BPlus_Tree::rebalance_leaf(BPlus_Leaf* leaf)
+{
+    BPlus_Inner* parent = leaf->parent;
+    int index = child_index(parent, leaf);
+    BPlus_Leaf* left = (index > 0) ? static_cast<BPlus_Leaf*>(parent->children[index - 1]) : nullptr;
+    BPlus_Leaf* right = (index + 1 < parent->count) ? static_cast<BPlus_Leaf*>(parent->children[index + 1]) : nullptr;
+
+    if(left != nullptr && left->count > BPLUS_MIN_SLOTS)
+    {
+        //borrow the largest entry of the left sibling
+        for(int i = leaf->count; i > 0; i--)
+        {
+            leaf->market_value[i] = leaf->market_value[i - 1];
+            leaf->ticket[i] = leaf->ticket[i - 1];
+            leaf->record[i] = leaf->record[i - 1];
+        }
+        left->count--;
+        leaf->market_value[0] = left->market_value[left->count];
+        leaf->ticket[0] = left->ticket[left->count];
+        leaf->record[0] = left->record[left->count];
+        leaf->count++;
+        parent->market_value[index - 1] = leaf->market_value[0];
+        parent->ticket[index - 1] = leaf->ticket[0];
+        return;
+    }
+    if(right != nullptr && right->count > BPLUS_MIN_SLOTS)
+    {
+        //borrow the smallest entry of the right sibling
+        leaf->market_value[leaf->count] = right->market_value[0];
+        leaf->ticket[leaf->count] = right->ticket[0];
+        leaf->record[leaf->count] = right->record[0];
+        leaf->count++;
+        for(int i = 0; i < right->count - 1; i++)
+        {
+            right->market_value[i] = right->market_value[i + 1];
+            right->ticket[i] = right->ticket[i + 1];
+            right->record[i] = right->record[i + 1];
+        }
+        right->count--;
+        parent->market_value[index] = right->market_value[0];
+        parent->ticket[index] = right->ticket[0];
+        return;
+    }
+
+    //neither sibling can spare an entry - merge with one of them, the right hand leaf of the pair is freed
+    if(left == nullptr)
+    {
+        left = leaf;
+        leaf = right;
+        index++;
+    }
+    for(int i = 0; i < leaf->count; i++)
+    {
+        left->market_value[left->count + i] = leaf->market_value[i];
+        left->ticket[left->count + i] = leaf->ticket[i];
+        left->record[left->count + i] = leaf->record[i];
+    }
+    left->count += leaf->count;
+    left->next = leaf->next;
+    if(left->next != nullptr)
+    {
+        left->next->previous = left;
+    }
+    delete leaf;
+    remove_child(parent, index);
+    rebalance_inner(parent);
+}
+
+void BPlus_Tree::rebalance_inner(BPlus_Inner* node)
+{
+    if(node->parent == nullptr)
+    {
+        if(node->count == 1)
+        {
+            //the root is down to a single child, so the tree loses a level
+            root = node->children[0];
+            if(node->leaf_children)
+            {
+                static_cast<BPlus_Leaf*>(root)->parent = nullptr;
+            }
+            else
+            {
+                static_cast<BPlus_Inner*>(root)->parent = nullptr;
+            }
+            delete node;
+            height--;
+        }
+        return;
+    }
+    if(node->count >= BPLUS_MIN_SLOTS)
+    {
+        return;
+    }
+    BPlus_Inner* parent = node->parent;
+    int index = child_index(parent, node);
+    BPlus_Inner* left = (index > 0) ? static_cast<BPlus_Inner*>(parent->children[index - 1]) : nullptr;
+    BPlus_Inner* right = (index + 1 < parent->count) ? static_cast<BPlus_Inner*>(parent->children[index + 1]) : nullptr;
+
+    if(left != nullptr && left->count > BPLUS_MIN_SLOTS)
+    {
+        //rotate the last child of the left sibling through the parent separator
+        for(int i = node->count; i > 0; i--)
+        {
+            node->children[i] = node->children[i - 1];
+        }
+        for(int i = node->count - 1; i > 0; i--)
+        {
+            node->market_value[i] = node->market_value[i - 1];
+            node->ticket[i] = node->ticket[i - 1];
+        }
+        node->children[0] = left->children[left->count - 1];
+        node->market_value[0] = parent->market_value[index - 1];
+        node->ticket[0] = parent->ticket[index - 1];
+        parent->market_value[index - 1] = left->market_value[left->count - 2];
+        parent->ticket[index - 1] = left->ticket[left->count - 2];
+        left->count--;
+        node->count++;
+        adopt_child(node, 0);
+        return;
+    }
+    if(right != nullptr && right->count > BPLUS_MIN_SLOTS)
+    {
+        //rotate the first child of the right sibling through the parent separator
+        node->children[node->count] = right->children[0];
+        node->market_value[node->count - 1] = parent->market_value[index];
+        node->ticket[node->count - 1] = parent->ticket[index];
+        parent->market_value[index] = right->market_value[0];
+        parent->ticket[index] = right->ticket[0];
+        for(int i = 0; i < right->count - 1; i++)
+        {
+            right->children[i] = right->children[i + 1];
+        }
+        for(int i = 0; i < right->count - 2; i++)
+        {
+            right->market_value[i] = right->market_value[i + 1];
+            right->ticket[i] = right->ticket[i + 1];
+        }
+        right->count--;
+        node->count++;
+        adopt_child(node, node->count - 1);
+        return;
+    }
+
+    //merge with a sibling - the parent separator between the pair comes down between their children
+    if(left == nullptr)
+    {
+        left = node;
+        node = right;
+        index++;
+    }
+    left->market_value[left->count - 1] = parent->market_value[index - 1];
+    left->ticket[left->count - 1] = parent->ticket[index - 1];
+    for(int i = 0; i < node->count; i++)
+    {
+        left->children[left->count + i] = node->children[i];
+        adopt_child(left, left->count + i);
+    }
+    for(int i = 0; i < node->count - 1; i++)
+    {
+        left->market_value[left->count + i] = node->market_value[i];
+        left->ticket[left->count + i] = node->ticket[i];
+    }
+    left->count += node->count;
+    delete node;
+    remove_child(parent, index);
+    rebalance_inner(parent);
+}
+
+void BPlus_Tree::remove_child(BPlus_Inner* parent, int child)
+{
+    //the separator to the left of the child goes with it
+    for(int i = child; i < parent->count - 1; i++)
+    {
+        parent->children[i] = parent->children[i + 1];
+    }
+    for(int i = child - 1; i < parent->count - 2; i++)
+    {
+        parent->market_value[i] = parent->market_value[i + 1];
+        parent->ticket[i] = parent->ticket[i + 1];
+    }
+    parent->count--;
+}
+
+int BPlus_Tree::child_index(BPlus_Inner* parent, void* child)
+{
+    int index = 0;
+    while(parent->children[index] != child)
+    {
+        index++;
+    }
+    return index;
+}
+
+void BPlus_Tree::adopt_child(BPlus_Inner* node, int child)
+{
+    if(node->leaf_children)
+    {
+        static_cast<BPlus_Leaf*>(node->children[child])->parent = node;
+    }
+    else
+    {
+        static_cast<BPlus_Inner*>(node->children[child])->parent = node;
+    }
+}
+
+
+/*------------------------------------------------- B+ Tree Private Bulk Load Functions ----------------------------------------*/
+
+bool BPlus_Tree::entry_less(const BPlus_Entry& first, const BPlus_Entry& second)
+{
+    return key_less(first.market_value, first.ticket, second.market_value, second.ticket);
+}
+
+void BPlus_Tree::collect_entries(vector<BPlus_Entry>& entries)
+{
+    if(root == nullptr)
+    {
+        return;
+    }
+    for(BPlus_Leaf* leaf = first_leaf(); leaf != nullptr; leaf = leaf->next)
+    {
+        for(int i = 0; i < leaf->count; i++)
+        {
+            entries.push_back({leaf->market_value[i], leaf->ticket[i], leaf->record[i]});
+        }
+    }
+}
+
+void BPlus_Tree::build_from_sorted(vector<BPlus_Entry>& entries)
+{
+    root = nullptr;
+    height = 0;
+    entry_count = entries.size();
+    total_value = Money();
+    if(entries.empty())
+    {
+        return;
+    }
+
+    //spreading the entries evenly over as few leaves as possible leaves every leaf at least half full
+    size_t leaf_total = (entries.size() + BPLUS_SLOTS - 1) / BPLUS_SLOTS;
+    vector<void*> level;
+    vector<BPlus_Entry> first_keys; //smallest key beneath each node of the level, used for the separators above it
+    BPlus_Leaf* previous = nullptr;
+    for(size_t i = 0; i < leaf_total; i++)
+    {
+        size_t start = entries.size() * i / leaf_total;
+        size_t end = entries.size() * (i + 1) / leaf_total;
+        BPlus_Leaf* leaf = new BPlus_Leaf;
+        for(size_t j = start; j < end; j++)
+        {
+            leaf->market_value[j - start] = entries.at(j).market_value;
+            leaf->ticket[j - start] = entries.at(j).ticket;
+            leaf->record[j - start] = entries.at(j).record;
+            total_value += entries.at(j).market_value;
+        }
+        leaf->count = end - start;
+        leaf->previous = previous;
+        if(previous != nullptr)
+        {
+            previous->next = leaf;
+        }
+        previous = leaf;
+        level.push_back(leaf);
+        first_keys.push_back(entries.at(start));
+    }
+    height = 1;
+
+    //each inner level is built over the one below it the same way until a single root remains
+    bool leaves = true;
+    while(level.size() > 1)
+    {
+        size_t parent_total = (level.size() + BPLUS_SLOTS - 1) / BPLUS_SLOTS;
+        vector<void*> parents;
+        vector<BPlus_Entry> parent_keys;
+        for(size_t i = 0; i < parent_total; i++)
+        {
+            size_t start = level.size() * i / parent_total;
+            size_t end = level.size() * (i + 1) / parent_total;
+            BPlus_Inner* node = new BPlus_Inner;
+            node->leaf_children = leaves;
+            for(size_t j = start; j < end; j++)
+            {
+                node->children[j - start] = level.at(j);
+                adopt_child(node, j - start);
+                if(j > start)
+                {
+                    node->market_value[j - start - 1] = first_keys.at(j).market_value;
+                    node->ticket[j - start - 1] = first_keys.at(j).ticket;
+                }
+            }
+            node->count = end - start;
+            parents.push_back(node);
+            parent_keys.push_back(first_keys.at(start));
+        }
+        level.swap(parents);
+        first_keys.swap(parent_keys);
+        leaves = false;
+        height++;
+    }
+    root = level.at(0);
+}
+
+void BPlus_Tree::delete_nodes(void* node, int level, bool delete_records)
+{
+    if(node == nullptr)
+    {
+        return;
+    }
+    if(level == 1)
+    {
+        BPlus_Leaf* leaf = static_cast<BPlus_Leaf*>(node);
+        if(delete_records)
+        {
+            for(int i = 0; i < leaf->count; i++)
+            {
+                delete leaf->record[i];
+            }
+        }
+        delete leaf;
+        return;
+    }
+    BPlus_Inner* inner = static_cast<BPlus_Inner*>(node);
+    for(int i = 0; i < inner->count; i++)
+    {
+        delete_nodes(inner->children[i], level - 1, delete_records);
+    }
+    delete inner;
+}
+
+size_t BPlus_Tree::node_footprint(void* node, int level)
+{
+    if(node == nullptr)
+    {
+        return 0;
+    }
+    if(level == 1)
+    {
+        BPlus_Leaf* leaf = static_cast<BPlus_Leaf*>(node);
+        size_t bytes = sizeof(BPlus_Leaf);
+        for(int i = 0; i < leaf->count; i++)
+        {
+            bytes += leaf->record[i]->footprint();
+        }
+        return bytes;
+    }
+    BPlus_Inner* inner = static_cast<BPlus_Inner*>(node);
+    size_t bytes = sizeof(BPlus_Inner);
+    for(int i = 0; i < inner->count; i++)
+    {
+        bytes += node_footprint(inner->children[i], level - 1);
+    }
+    return bytes;
+}
+
+
+/*--------------------------------------------------- B+ Tree Private Test Functions -------------------------------------------*/
+
+void BPlus_Tree::test_node(void* node, int level, BPlus_Inner* parent, const BPlus_Entry* low, const BPlus_Entry* high,
+                          BPlus_Validation_Report& report)
+{
+    if(level == 1)
+    {
+        BPlus_Leaf* leaf = static_cast<BPlus_Leaf*>(node);
+        if(leaf->parent != parent)
+        {
+            report.parent_links = false;
+        }
+        if(leaf->count > BPLUS_SLOTS || leaf->count < 1 || (parent != nullptr && leaf->count < BPLUS_MIN_SLOTS))
+        {
+            report.node_occupancy = false;
+        }
+        //a count outside the node can't be trusted to read its entries
+        int entries = min(max(leaf->count, 0), BPLUS_SLOTS);
+        for(int i = 0; i < entries; i++)
+        {
+            bool below_low = low != nullptr && key_less(leaf->market_value[i], leaf->ticket[i], low->market_value, low->ticket);
+            bool above_high = high != nullptr && key_less(high->market_value, high->ticket, leaf->market_value[i], leaf->ticket[i]);
+            bool out_of_order = i > 0 && key_less(leaf->market_value[i], leaf->ticket[i], leaf->market_value[i - 1], leaf->ticket[i - 1]);
+            if(below_low || above_high || out_of_order)
+            {
+                report.keys_ordered = false;
+            }
+            if(leaf->record[i]->market_value != leaf->market_value[i])
+            {
+                report.records_match = false;
+            }
+        }
+        return;
+    }
+
+    BPlus_Inner* inner = static_cast<BPlus_Inner*>(node);
+    int minimum_children = (parent == nullptr) ? 2 : BPLUS_MIN_SLOTS;
+    if(inner->parent != parent || inner->leaf_children != (level == 2))
+    {
+        report.parent_links = false;
+    }
+    if(inner->count > BPLUS_SLOTS || inner->count < minimum_children)
+    {
+        report.node_occupancy = false;
+    }
+    int children = min(max(inner->count, 0), BPLUS_SLOTS);
+    for(int i = 0; i < children; i++)
+    {
+        //the separators on either side of a child bound every key beneath it
+        BPlus_Entry lower;
+        BPlus_Entry upper;
+        const BPlus_Entry* child_low = low;
+        const BPlus_Entry* child_high = high;
+        if(i > 0)
+        {
+            lower = {inner->market_value[i - 1], inner->ticket[i - 1], nullptr};
+            child_low = &lower;
+        }
+        if(i < children - 1)
+        {
+            upper = {inner->market_value[i], inner->ticket[i], nullptr};
+            child_high = &upper;
+        }
+        test_node(inner->children[i], level - 1, inner, child_low, child_high, report);
+    }
+}
+
+void BPlus_Tree::test_leaf_chain(BPlus_Validation_Report& report)
+{
+    int entries = 0;
+    Money total;
+    BPlus_Leaf* previous = nullptr;
+    int previous_count = 0;
+    //a chain longer than the entries it could hold has looped back on itself
+    int leaves_left = entry_count + 1;
+    for(BPlus_Leaf* leaf = (root == nullptr) ? nullptr : first_leaf(); leaf != nullptr; leaf = leaf->next)
+    {
+        if(leaves_left-- == 0)
+        {
+            report.leaf_links = false;
+            return;
+        }
+        if(leaf->previous != previous)
+        {
+            report.leaf_links = false;
+        }
+        int count = min(max(leaf->count, 0), BPLUS_SLOTS);
+        if(count > 0 && previous_count > 0
+           && key_less(leaf->market_value[0], leaf->ticket[0], previous->market_value[previous_count - 1], previous->ticket[previous_count - 1]))
+        {
+            report.keys_ordered = false;
+        }
+        for(int i = 0; i < count; i++)
+        {
+            total += leaf->market_value[i];
+        }
+        entries += count;
+        previous = leaf;
+        previous_count = count;
+    }
+    if(previous != ((root == nullptr) ? nullptr : last_leaf()))
+    {
+        report.leaf_links = false;
+    }
+    if(entries != entry_count || total != total_value)
+    {
+        report.count_and_total = false;
+    }
+}
+
+void BPlus_Tree::print_node(void* node, int level, int empty_space)
+{
+    string space = "";
+    for(int i = 0; i < empty_space; i++)
+    {
+        space += "    ";
+    }
+    cout << fixed << setprecision(2) << space;
+    if(level == 1)
+    {
+        BPlus_Leaf* leaf = static_cast<BPlus_Leaf*>(node);
+        for(int i = 0; i < leaf->count; i++)
+        {
+            cout << leaf->market_value[i] << " ";
+        }
+        cout << endl;
+        return;
+    }
+    BPlus_Inner* inner = static_cast<BPlus_Inner*>(node);
+    cout << "[ ";
+    for(int i = 0; i < inner->count - 1; i++)
+    {
+        cout << inner->market_value[i] << " ";
+    }
+    cout << "]" << endl;
+    for(int i = 0; i < inner->count; i++)
+    {
+        print_node(inner->children[i], level - 1, empty_space + 1);
+    }
+}
@@ -0,0 +1,240 @@
+#ifndef BPLUS_TREE_H
+#define BPLUS_TREE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include "node_pool.h"
+#include "security_index.h"
+
+
+using namespace std;
+#define BPLUS_SLOTS 16 //entries per leaf and children per inner node - each key array fills whole cache lines
+#define BPLUS_MIN_SLOTS (BPLUS_SLOTS / 2) //fewest entries or children a node other than the root may hold
+
+
+/*----------------------------------------------------- B+ Tree Node Structures ------------------------------------------------*/
+
+struct BPlus_Inner;
+
+/*
+    This structure is a leaf of the B+ tree. The keys of the leaf (market value and ticket) are stored in their own
+    arrays at the front of the node, so a search within the leaf only reads a couple of cache lines. Leaves are
+    linked in key order, so neighboring securities are reached without going back through the inner nodes.
+*/
+struct alignas(64) BPlus_Leaf
+{
+    Money market_value[BPLUS_SLOTS];
+    int ticket[BPLUS_SLOTS];
+    RBT_Security_Node* record[BPLUS_SLOTS];
+    int count = 0; //number of entries held
+    BPlus_Leaf* next = nullptr;
+    BPlus_Leaf* previous = nullptr;
+    BPlus_Inner* parent = nullptr;
+
+    static void* operator new(size_t size);
+    static void operator delete(void* node, size_t size);
+    static Node_Pool<BPlus_Leaf>& pool();
+};
+
+/*
+    This structure is an inner node of the B+ tree. Separator i sits between child i and child i + 1 - every
+    entry beneath child i is no larger than separator i and no smaller than separator i - 1. The children are
+    either all leaves or all inner nodes.
+*/
+struct alignas(64) BPlus_Inner
+{
+    Money market_value[BPLUS_SLOTS]; //separator keys, the last slot is unused
+    int ticket[BPLUS_SLOTS];
+    void* children[BPLUS_SLOTS];
+    int count = 0; //number of children held
+    bool leaf_children = false;
+    BPlus_Inner* parent = nullptr;
+
+    static void* operator new(size_t size);
+    static void operator delete(void* node, size_t size);
+    static Node_Pool<BPlus_Inner>& pool();
+};
+
+/*
+    This structure is an entry used while bulk loading the B+ tree, sorted on market value and then ticket.
+*/
+struct BPlus_Entry
+{
+    Money market_value;
+    int ticket;
+    RBT_Security_Node* record;
+};
+
+/*
+    This structure is the result of checking the B+ tree. Each check is reported on its own, so every invariant
+    that fails is named rather than only the first one found.
+*/
+struct BPlus_Validation_Report
+{
+    bool keys_ordered = true; //keys in order within each leaf, between the separators above it and along the leaf chain
+    bool node_occupancy = true; //no node over BPLUS_SLOTS, and every node other than the root at least half full
+    bool parent_links = true; //every node points back at its parent, and inner nodes know whether their children are leaves
+    bool leaf_links = true; //the leaves are linked first to last, each pointing back at the one before it
+    bool count_and_total = true; //stored security count and market value total match the leaves
+    bool records_match = true; //every record's market value is the key it is stored under
+
+    //true when every check passed
+    bool valid() const;
+};
+
+
+/* ---------------------------------------------------------B+ Tree Class-------------------------------------------------------*/
+
+/*
+    Security index backed by an in-memory B+ tree. Every security sits in a leaf, the inner nodes only guide the
+    search. A search for a market value range takes the smallest security within the range. The market value total
+    is kept up to date through every insert and removal.
+*/
+class BPlus_Tree : public Security_Index
+{
+public:
+
+    //Tree Constructor
+    BPlus_Tree();
+
+    //Tree Deconstructor - frees every node along with the security records still in the tree
+    ~BPlus_Tree();
+
+    //the tree owns its nodes, copying it would free them twice
+    BPlus_Tree(const BPlus_Tree&) = delete;
+    BPlus_Tree& operator=(const BPlus_Tree&) = delete;
+
+    string backend_name();
+
+    /*------------------------------------------- B+ Tree Public Add and Remove Functions --------------------------------------*/
+
+    void add_security(RBT_Security_Node* security);
+
+    /*
+        Function adds many securities at once. The securities are sorted and merged with the entries already
+        in the tree, then the leaves are packed evenly and the inner levels built above them in O(N). When only
+        a few securities are added to a large tree they are inserted one at a time instead.
+    */
+    void bulk_add(const vector<RBT_Security_Node*>& securities);
+
+    RBT_Security_Node* take_security(Money min, Money max);
+
+    bool remove_security(RBT_Security_Node* security);
+
+    RBT_Security_Node* take_smallest();
+
+    RBT_Security_Node* take_largest();
+
+    RBT_Security_Node* erase(int ticket, Money market_value);
+
+    void release_all();
+
+    /*---------------------------------------------- B+ Tree Public Lookup Functions -------------------------------------------*/
+
+    RBT_Security_Node* smallest_security();
+
+    RBT_Security_Node* largest_security();
+
+    int security_count();
+
+    Money market_value_total();
+
+    //walks the leaf chain, so the inner nodes are never visited
+    void collect_securities(vector<RBT_Security_Node*>& securities);
+
+    size_t memory_footprint();
+
+    /*----------------------------------------------- B+ Tree Public Test Functions --------------------------------------------*/
+
+    /*
+        Function prints the tree one node per line, indented by depth. Inner nodes show their separators
+        and leaves show the market values they hold.
+    */
+    void print_index();
+
+    /*
+        Function checks the B+ tree invariants - key ordering within and between nodes, every node other than
+        the root at least half full, parent links, the leaf links and the stored count and total - and returns
+        the report. Every node is checked, a failed check doesn't stop the others.
+    */
+    BPlus_Validation_Report validate();
+
+    /*
+        Function validates the tree and prints whether each check passed, then the overall result.
+    */
+    void run_tests();
+
+    void print_node_usage();
+
+private:
+
+    //the root is a leaf while the tree has a single level
+    void* root = nullptr;
+
+    //number of levels, 1 when the root is a leaf and 0 when the tree is empty
+    int height = 0;
+
+    int entry_count = 0;
+
+    Money total_value;
+
+    /*-------------------------------------------- B+ Tree Private Search Helper Functions -------------------------------------*/
+
+    static bool key_less(Money first_value, int first_ticket, Money second_value, int second_ticket);
+
+
+    BPlus_Leaf* find_leaf(Money market_value, int ticket, bool after_equal);
+
+    bool lower_bound(Money market_value, int ticket, BPlus_Leaf*& leaf, int& position);
+
+    BPlus_Leaf* first_leaf();
+
+    BPlus_Leaf* last_leaf();
+
+    /*------------------------------------------- B+ Tree Private Insert and Remove Functions ----------------------------------*/
+
+    void insert_into_leaf(BPlus_Leaf* leaf, int position, RBT_Security_Node* security);
+
+    void insert_into_parent(void* left, Money market_value, int ticket, void* right, bool leaves);
+
+    void remove_entry(BPlus_Leaf* leaf, int position);
+
+    void rebalance_leaf(BPlus_Leaf* leaf);
+
+    void rebalance_inner(BPlus_Inner* node);
+
+    void remove_child(BPlus_Inner* parent, int child);
+
+    static int child_index(BPlus_Inner* parent, void* child);
+
+    static void adopt_child(BPlus_Inner* node, int child);
+
+    /*---------------------------------------------- B+ Tree Private Bulk Load Functions ---------------------------------------*/
+
+    static bool entry_less(const BPlus_Entry& first, const BPlus_Entry& second);
+
+    void collect_entries(vector<BPlus_Entry>& entries);
+
+    void build_from_sorted(vector<BPlus_Entry>& entries);
+
+    void delete_nodes(void* node, int level, bool delete_records);
+
+    size_t node_footprint(void* node, int level);
+
+    /*----------------------------------------------- B+ Tree Private Test Functions -------------------------------------------*/
+
+    void test_node(void* node, int level, BPlus_Inner* parent, const BPlus_Entry* low, const BPlus_Entry* high,
+                   BPlus_Validation_Report& report);
+
+    void test_leaf_chain(BPlus_Validation_Report& report);
+
+    void print_node(void* node, int level, int empty_space);
+};
+
+
+#endif
@@ -0,0 +1,343 @@
+#include "csv_reader.h"
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+
+/*---------------------------------------------------- Mapped File Functions ---------------------------------------------------*/
+
+Mapped_File::~Mapped_File()
+{
+    close();
+}
+
+bool Mapped_File::open(const string& file_name, bool copy_on_write)
+{
+    close();
+    int descriptor = ::open(file_name.c_str(), O_RDONLY);
+    if(descriptor < 0)
+    {
+        return false;
+    }
+    struct stat file_status;
+    if(fstat(descriptor, &file_status) == 0 && S_ISREG(file_status.st_mode) && file_status.st_size > 0)
+    {
+        int protection = copy_on_write ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void* view = mmap(nullptr, file_status.st_size, protection, MAP_PRIVATE, descriptor, 0);
+        if(view != MAP_FAILED)
+        {
+            //rows are parsed front to back, so the kernel can read ahead aggressively
+            madvise(view, file_status.st_size, MADV_SEQUENTIAL);
+            contents = static_cast<const char*>(view);
+            length = file_status.st_size;
+            mapped = true;
+        }
+    }
+    ::close(descriptor);
+
+    if(!mapped)
+    {   //the file could not be mapped - read it into the buffer instead
+        ifstream file(file_name, ios::in | ios::binary);
+        if(!file.is_open())
+        {
+            return false;
+        }
+        stringstream file_text;
+        file_text << file.rdbuf();
+        buffer = file_text.str();
+        contents = buffer.data();
+        length = buffer.size();
+    }
+    writable = copy_on_write;
+    opened = true;
+    return true;
+}
+
+void Mapped_File::close()
+{
+    if(mapped)
+    {
+        munmap(const_cast<char*>(contents), length);
+    }
+    contents = nullptr;
+    length = 0;
+    mapped = false;
+    writable = false;
+    opened = false;
+    buffer.clear();
+    buffer.shrink_to_fit();
+}
+
+bool Mapped_File::is_open() const
+{
+    return opened;
+}
+
+const char* Mapped_File::data() const
+{
+    return contents;
+}
+
+size_t Mapped_File::size() const
+{
+    return length;
+}
+
+char* Mapped_File::writable_data()
+{
+    return writable ? const_cast<char*>(contents) : nullptr;
+}
+
+
+/*----------------------------------------------------- Csv Reader Functions ---------------------------------------------------*/
+
+/*
+    Function returns the first comma or newline at or after from, or end if there is none. With SSE2 16 bytes are
+    compared against both delimiters at once.
+*/
+static const char* find_delimiter(const char* from, const char* end)
+{
+#if defined(__SSE2__)
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    while(end - from >= 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from));
+        int hits = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, comma), _mm_cmpeq_epi8(block, newline)));
+        if(hits != 0)
+        {
+            return from + __builtin_ctz(hits);
+        }
+        from += 16;
+    }
+#endif
+    while(from < end && *from != ',' && *from != '\n')
+    {
+        from++;
+    }
+    return from;
+}
+
+Csv_Reader::Csv_Reader(const char* text, size_t length)
+    : begin(text), position(text), end(text + length)
+{
+}
+
+Csv_Reader::Csv_Reader(const Mapped_File& file)
+    : Csv_Reader(file.data(), file.size())
+{
+}
+
+bool Csv_Reader::next_row(vector<string_view>& fields)
+{
+    fields.clear();
+    return read_row(&fields);
+}
+
+bool Csv_Reader::skip_row()
+{
+    return read_row(nullptr);
+}
+
+size_t Csv_Reader::rows_read() const
+{
+    return row_count;
+}
+
+size_t Csv_Reader::offset() const
+{
+    return position - begin;
+}
+
+vector<size_t> Csv_Reader::row_chunks(const char* text, size_t length, size_t chunk_count)
+{
+    vector<size_t> bounds(1, 0);
+    bool quoted = memchr(text, '"', length) != nullptr;
+    size_t share = length / max(chunk_count, size_t(1)) + 1;
+    Csv_Reader rows(text, length);
+    size_t start = 0;
+    while(bounds.size() < chunk_count && start + share < length)
+    {
+        size_t target = start + share;
+        size_t next = length;
+        if(quoted)
+        {
+            while(rows.offset() < target && rows.skip_row())
+            {
+            }
+            next = rows.offset();
+        }
+        else
+        {
+            const char* newline = static_cast<const char*>(memchr(text + target, '\n', length - target));
+            next = (newline != nullptr) ? newline - text + 1 : length;
+        }
+        if(next >= length)
+        {
+            break;
+        }
+        bounds.push_back(next);
+        start = next;
+    }
+    bounds.push_back(length);
+    return bounds;
+}
+
+bool Csv_Reader::read_row(vector<string_view>* fields)
+{
+    unescaped.clear();
+    while(position < end && (*position == '\n' || *position == '\r'))
+    {
+        position++;
+    }
+    if(position >= end)
+    {
+        return false;
+    }
+    while(true)
+    {
+        string_view field = (*position == '"') ? read_quoted_field() : read_plain_field();
+        if(fields != nullptr)
+        {
+            fields->push_back(field);
+        }
+        if(position < end && *position == ',')
+        {
+            position++;
+            continue;
+        }
+        if(position < end)
+        {   //the newline ending the row
+            position++;
+        }
+        break;
+    }
+    row_count++;
+    return true;
+}
+
+string_view Csv_Reader::read_plain_field()
+{
+    const char* start = position;
+    position = (position < end) ? find_delimiter(position, end) : end;
+    const char* field_end = position;
+    if(field_end > start && (position == end || *position == '\n') && field_end[-1] == '\r')
+    {
+        field_end--;
+    }
+    return string_view(start, field_end - start);
+}
+
+string_view Csv_Reader::read_quoted_field()
+{
+    position++; //opening quote
+    const char* start = position;
+    const char* field_end = end;
+    string* copy = nullptr;
+    while(position < end)
+    {
+        const char* quote = static_cast<const char*>(memchr(position, '"', end - position));
+        if(quote == nullptr)
+        {   //no closing quote - the field runs to the end of the text
+            if(copy != nullptr)
+            {
+                copy->append(position, end);
+            }
+            position = end;
+            break;
+        }
+        if(quote + 1 < end && quote[1] == '"')
+        {   //a doubled quote is one quote in the field, so the field can't be a view of the text
+            if(copy == nullptr)
+            {
+                unescaped.emplace_back();
+                copy = &unescaped.back();
+            }
+            copy->append(position, quote + 1);
+            position = quote + 2;
+            continue;
+        }
+        if(copy != nullptr)
+        {
+            copy->append(position, quote);
+        }
+        field_end = quote;
+        position = quote + 1;
+        break;
+    }
+    //anything between the closing quote and the delimiter is dropped
+    while(position < end && *position != ',' && *position != '\n')
+    {
+        position++;
+    }
+    return (copy != nullptr) ? string_view(*copy) : string_view(start, field_end - start);
+}
+
+
+/*----------------------------------------------------- Csv Field Functions ----------------------------------------------------*/
+
+template <typename Integer>
+static Integer field_to_integer(string_view field)
+{
+    size_t first = 0;
+    size_t last = field.size();
+    while(first < last && field[first] == ' ')
+    {
+        first++;
+    }
+    while(last > first && (field[last - 1] == ' ' || field[last - 1] == '\r'))
+    {
+        last--;
+    }
+    if(first < last && field[first] == '+')
+    {
+        first++;
+    }
+    Integer value = 0;
+    from_chars_result result = from_chars(field.data() + first, field.data() + last, value);
+    if(first == last || result.ec != errc() || result.ptr != field.data() + last)
+    {
+        throw invalid_argument("\"" + string(field) + "\" is not a whole number");
+    }
+    return value;
+}
+
+int field_to_int(string_view field)
+{
+    return field_to_integer<int>(field);
+}
+
+long field_to_long(string_view field)
+{
+    return field_to_integer<long>(field);
+}
+
+string csv_field(const string& text)
+{
+    if(text.find_first_of(",\"\r\n") == string::npos)
+    {
+        return text;
+    }
+    string quoted = "\"";
+    for(size_t i = 0; i < text.size(); i++)
+    {
+        if(text[i] == '"')
+        {
+            quoted += '"';
+        }
+        quoted += text[i];
+    }
+    return quoted + "\"";
+}
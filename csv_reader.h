@@ -0,0 +1,142 @@
+#ifndef CSV_READER_H
+#define CSV_READER_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+
+
+using namespace std;
+
+
+/* -------------------------------------------------------Mapped File Class-----------------------------------------------------*/
+
+/*
+    A file mapped into memory, so rows can be parsed in place without copying them into strings.
+    Files that can't be mapped (an empty file, a pipe) are read into a buffer instead. The file is unmapped when the
+    object is destroyed or another file is opened.
+*/
+class Mapped_File
+{
+public:
+
+    Mapped_File() = default;
+    ~Mapped_File();
+
+    //the mapping is released exactly once, so the file can't be copied
+    Mapped_File(const Mapped_File&) = delete;
+    Mapped_File& operator=(const Mapped_File&) = delete;
+
+    /*
+        Function maps the named file read-only, releasing any file already open. Returns false if the file can't
+        be opened. A copy-on-write mapping can also be changed through writable_data - the changes stay in memory
+        and are never written back to the file.
+    */
+    bool open(const string& file_name, bool copy_on_write = false);
+
+    void close();
+
+    bool is_open() const;
+
+    //contents of the file - valid until the file is closed
+    const char* data() const;
+
+    size_t size() const;
+
+    //contents of a copy-on-write mapping, nullptr if the file was opened read-only
+    char* writable_data();
+
+private:
+
+    const char* contents = nullptr;
+    bool writable = false;
+    size_t length = 0;
+    bool mapped = false; //false when the contents were read into the buffer
+    bool opened = false;
+    string buffer;
+};
+
+
+/* --------------------------------------------------------Csv Reader Class-----------------------------------------------------*/
+
+/*
+    The csv reader splits a block of csv text (usually a Mapped_File) into rows of fields. Each field is a
+    string_view into the text, so nothing is copied - callers convert or copy only the fields they keep.
+
+    Fields may be quoted ("Bonds, Series A"), in which case commas and line breaks inside the quotes belong to the
+    field and the quotes are not part of it. A doubled quote inside a quoted field stands for one quote; only those
+    fields are copied, into storage the reader keeps until the next row is read. Rows end at \n or \r\n, and blank
+    lines are skipped. The scan for the next delimiter checks 16 bytes at a time where SSE2 is available.
+*/
+class Csv_Reader
+{
+public:
+
+    Csv_Reader(const char* text, size_t length);
+
+    explicit Csv_Reader(const Mapped_File& file);
+
+    /*
+        Function reads the next row into fields (which is cleared first). Returns false once every row has been
+        read. The views stay valid until the next row is read or the text is released.
+    */
+    bool next_row(vector<string_view>& fields);
+
+    /*
+        Function skips the next row without splitting it, used for the header line. Returns false if there was
+        no row to skip.
+    */
+    bool skip_row();
+
+    //number of rows returned or skipped so far
+    size_t rows_read() const;
+
+    //offset in the text of the next row to be read
+    size_t offset() const;
+
+    /*
+        Function splits the text into at most chunk_count chunks of about the same size that each start at the
+        beginning of a row, so each chunk can be read by its own reader. Returns the offsets where the chunks
+        start followed by the length of the text. Without quotes in the text a chunk ends at the first newline
+        past its share; otherwise the rows are skipped up to it, so a line break inside quotes is never taken
+        for the end of a row.
+    */
+    static vector<size_t> row_chunks(const char* text, size_t length, size_t chunk_count);
+
+private:
+
+    const char* begin;
+    const char* position;
+    const char* end;
+    size_t row_count = 0;
+    deque<string> unescaped; //quoted fields holding doubled quotes, for the current row
+
+    //reads the next row, into fields when it is not nullptr
+    bool read_row(vector<string_view>* fields);
+
+    string_view read_quoted_field();
+
+    string_view read_plain_field();
+};
+
+
+/*--------------------------------------------------- Csv Field Functions ------------------------------------------------------*/
+
+/*
+    Functions convert a field to an integer with from_chars. Surrounding spaces and a trailing carriage return are
+    allowed. Throws invalid_argument, as stoi does, if the field is not a whole number or does not fit.
+*/
+int field_to_int(string_view field);
+
+long field_to_long(string_view field);
+
+/*
+    Function returns the text written for a field in a csv file - the text itself, or the text in quotes (with its
+    quotes doubled) if it holds a comma, a quote or a line break, so the csv reader reads it back unchanged.
+*/
+string csv_field(const string& text);
+
+
+#endif
@@ -0,0 +1,290 @@
+#include "customer_store.h"
+#include "supporting_func_structs.h"
+#include <algorithm>
+
+using namespace std;
+
+
+/*---------------------------------------------------- Customer Store Move Functions -------------------------------------------*/
+
+Customer_Store::Customer_Store(Customer_Store&& other)
+    : pledge_codes(move(other.pledge_codes)), customers(move(other.customers)), balances(move(other.balances)),
+      pledged(move(other.pledged)), over_unders(move(other.over_unders)), underpledged(move(other.underpledged))
+{
+    other.clear();
+    set_rows(0);
+}
+
+Customer_Store& Customer_Store::operator=(Customer_Store&& other)
+{
+    if(this != &other)
+    {
+        //the store keeps the pledge order it was set to when a loaded store is moved into it
+        Pledge_Order order = underpledged.order();
+        pledge_codes = move(other.pledge_codes);
+        customers = move(other.customers);
+        balances = move(other.balances);
+        pledged = move(other.pledged);
+        over_unders = move(other.over_unders);
+        underpledged = move(other.underpledged);
+        underpledged.set_order(order);
+        other.clear();
+        set_rows(0);
+    }
+    return *this;
+}
+
+
+/*----------------------------------------------- Customer Store Update Functions ----------------------------------------------*/
+
+bool Customer_Store::insert(Customer_Node* customer)
+{
+    size_t position = lower_bound(customer->pledge_code);
+    if(position < pledge_codes.size() && pledge_codes.at(position) == customer->pledge_code)
+    {
+        return false;
+    }
+    Money balance = customer->account_sum();
+    Money pledged_total = customer->pledged_sum();
+    pledge_codes.insert(pledge_codes.begin() + position, customer->pledge_code);
+    customers.insert(customers.begin() + position, customer);
+    balances.insert(balances.begin() + position, balance);
+    pledged.insert(pledged.begin() + position, pledged_total);
+    over_unders.insert(over_unders.begin() + position, pledged_total - balance);
+    set_rows(position);
+    //the rows after it have moved, so the queue is rebuilt - unless the customer was added at the end
+    if(position + 1 == customers.size())
+    {
+        underpledged.update(position, over_unders.at(position));
+    }
+    else
+    {
+        underpledged.rebuild(over_unders.data(), over_unders.size());
+    }
+    return true;
+}
+
+Customer_Node* Customer_Store::erase(int pledge_code)
+{
+    size_t position = lower_bound(pledge_code);
+    if(position == pledge_codes.size() || pledge_codes.at(position) != pledge_code)
+    {
+        return nullptr;
+    }
+    Customer_Node* customer = customers.at(position);
+    customer->table = nullptr;
+    pledge_codes.erase(pledge_codes.begin() + position);
+    customers.erase(customers.begin() + position);
+    balances.erase(balances.begin() + position);
+    pledged.erase(pledged.begin() + position);
+    over_unders.erase(over_unders.begin() + position);
+    set_rows(position);
+    underpledged.rebuild(over_unders.data(), over_unders.size());
+    return customer;
+}
+
+void Customer_Store::insert(vector<Customer_Node*>& added)
+{
+    if(added.empty())
+    {
+        return;
+    }
+    sort(added.begin(), added.end(), [](const Customer_Node* first, const Customer_Node* second)
+    {
+        return first->pledge_code < second->pledge_code;
+    });
+    //merged from the back, so each customer already held moves once, straight to its new row
+    size_t held = customers.size();
+    size_t remaining = added.size();
+    size_t position = held + added.size();
+    resize(position);
+    while(remaining > 0)
+    {
+        position--;
+        if(held > 0 && pledge_codes.at(held - 1) > added.at(remaining - 1)->pledge_code)
+        {
+            held--;
+            move_row(held, position);
+        }
+        else
+        {
+            remaining--;
+            Customer_Node* customer = added.at(remaining);
+            pledge_codes.at(position) = customer->pledge_code;
+            customers.at(position) = customer;
+            balances.at(position) = customer->account_sum();
+            pledged.at(position) = customer->pledged_sum();
+            over_unders.at(position) = pledged.at(position) - balances.at(position);
+        }
+    }
+    set_rows(position);
+    underpledged.rebuild(over_unders.data(), over_unders.size());
+}
+
+void Customer_Store::erase(const vector<Customer_Node*>& removed)
+{
+    if(removed.empty())
+    {
+        return;
+    }
+    //the customers taken out are detached first, so the compaction below knows them by their table
+    size_t first_removed = customers.size();
+    for(Customer_Node* customer : removed)
+    {
+        first_removed = min(first_removed, customer->row);
+        customer->table = nullptr;
+    }
+    size_t kept = first_removed;
+    for(size_t position = first_removed; position < customers.size(); position++)
+    {
+        if(customers.at(position)->table == this)
+        {
+            move_row(position, kept);
+            kept++;
+        }
+    }
+    resize(kept);
+    set_rows(first_removed);
+    underpledged.rebuild(over_unders.data(), over_unders.size());
+}
+
+void Customer_Store::assign(vector<Customer_Node*>& loaded)
+{
+    sort(loaded.begin(), loaded.end(), [](const Customer_Node* first, const Customer_Node* second)
+    {
+        return first->pledge_code < second->pledge_code;
+    });
+    customers = loaded;
+    pledge_codes.resize(customers.size());
+    balances.resize(customers.size());
+    pledged.resize(customers.size());
+    over_unders.resize(customers.size());
+    for(size_t i = 0; i < customers.size(); i++)
+    {
+        pledge_codes.at(i) = customers.at(i)->pledge_code;
+        balances.at(i) = customers.at(i)->account_sum();
+        pledged.at(i) = customers.at(i)->pledged_sum();
+        over_unders.at(i) = pledged.at(i) - balances.at(i);
+    }
+    set_rows(0);
+    underpledged.rebuild(over_unders.data(), over_unders.size());
+}
+
+void Customer_Store::clear()
+{
+    pledge_codes.clear();
+    customers.clear();
+    balances.clear();
+    pledged.clear();
+    over_unders.clear();
+    underpledged.clear();
+}
+
+void Customer_Store::set_pledge_order(Pledge_Order order)
+{
+    underpledged.set_order(order);
+}
+
+Pledge_Order Customer_Store::pledge_order() const
+{
+    return underpledged.order();
+}
+
+void Customer_Store::reserve(size_t count)
+{
+    pledge_codes.reserve(count);
+    customers.reserve(count);
+    balances.reserve(count);
+    pledged.reserve(count);
+    over_unders.reserve(count);
+}
+
+
+/*----------------------------------------------- Customer Store Lookup Functions ----------------------------------------------*/
+
+Customer_Node* Customer_Store::find(int pledge_code) const
+{
+    size_t position = lower_bound(pledge_code);
+    if(position == pledge_codes.size() || pledge_codes.at(position) != pledge_code)
+    {
+        return nullptr;
+    }
+    return customers.at(position);
+}
+
+Customer_Node* Customer_Store::next_underpledged() const
+{
+    return underpledged.empty() ? nullptr : customers.at(underpledged.top());
+}
+
+size_t Customer_Store::underpledged_count() const
+{
+    return underpledged.size();
+}
+
+Money Customer_Store::deficit_total() const
+{
+    return underpledged.deficit_total();
+}
+
+bool Customer_Store::queue_in_sync() const
+{
+    return underpledged.validate(over_unders.data(), over_unders.size());
+}
+
+Customer_Node* Customer_Store::at(size_t position) const
+{
+    return customers.at(position);
+}
+
+size_t Customer_Store::size() const
+{
+    return customers.size();
+}
+
+bool Customer_Store::empty() const
+{
+    return customers.empty();
+}
+
+Customer_Store::const_iterator Customer_Store::begin() const
+{
+    return customers.begin();
+}
+
+Customer_Store::const_iterator Customer_Store::end() const
+{
+    return customers.end();
+}
+
+size_t Customer_Store::lower_bound(int pledge_code) const
+{
+    return std::lower_bound(pledge_codes.begin(), pledge_codes.end(), pledge_code) - pledge_codes.begin();
+}
+
+void Customer_Store::move_row(size_t from, size_t to)
+{
+    pledge_codes.at(to) = pledge_codes.at(from);
+    customers.at(to) = customers.at(from);
+    balances.at(to) = balances.at(from);
+    pledged.at(to) = pledged.at(from);
+    over_unders.at(to) = over_unders.at(from);
+}
+
+void Customer_Store::resize(size_t count)
+{
+    pledge_codes.resize(count);
+    customers.resize(count);
+    balances.resize(count);
+    pledged.resize(count);
+    over_unders.resize(count);
+}
+
+void Customer_Store::set_rows(size_t first_position)
+{
+    for(size_t i = first_position; i < customers.size(); i++)
+    {
+        customers.at(i)->table = this;
+        customers.at(i)->row = i;
+    }
+}
@@ -0,0 +1,172 @@
+#ifndef CUSTOMER_STORE_H
+#define CUSTOMER_STORE_H
+
+#include <iostream>
+#include <vector>
+#include "money.h"
+#include "deficit_queue.h"
+
+
+using namespace std;
+
+struct Customer_Node;
+
+
+/* ----------------------------------------------------Customer Store Class-----------------------------------------------------*/
+
+/*
+    The customer store is the table of every loaded customer, keyed on pledge code. It is held as columns: the pledge
+    codes, the customer handles and each customer's total balance, total pledged and over_under are separate arrays
+    kept in pledge code order, so a lookup is a binary search over contiguous integers and a scan of the totals
+    (finding the underpledged customers, the total deficit, the overage test) is one sweep over contiguous amounts
+    that never touches the customer nodes.
+
+    The totals live only here. Each customer holds the table it is in and its row, and moves its totals through them
+    as accounts and securities are attached and detached (see Customer_Node). Every change of an over_under also
+    updates the deficit queue, so the underpledged customers are always at hand in the chosen pledge order, with
+    their total deficit, without scanning the table. The customer nodes are allocated on
+    their own and never move, so a Customer_Node* taken from the store stays valid until that customer is erased
+    and freed. The store can't be copied; functions take it by reference, and a loaded store is moved into place.
+*/
+class Customer_Store
+{
+public:
+
+    typedef vector<Customer_Node*>::const_iterator const_iterator;
+
+    Customer_Store() = default;
+    Customer_Store(const Customer_Store&) = delete;
+    Customer_Store& operator=(const Customer_Store&) = delete;
+
+    //the customers are pointed at the store they were moved into
+    Customer_Store(Customer_Store&& other);
+    Customer_Store& operator=(Customer_Store&& other);
+
+    /*--------------------------------------------- Customer Store Update Functions --------------------------------------------*/
+
+    /*
+        Function adds the customer under its pledge code, summing its accounts and pledged securities into its
+        totals. Returns false, leaving the store unchanged, if a customer with that code is already held. O(logN) to
+        find its place, plus the customers after it moved along (none when customers are added in pledge code order).
+    */
+    bool insert(Customer_Node* customer);
+
+    /*
+        Function takes the customer with the passed in pledge code out of the store and returns it, or nullptr if
+        there is none. The customer is not freed, and no longer has stored totals.
+    */
+    Customer_Node* erase(int pledge_code);
+
+    /*
+        Functions add or take out many customers at once - each is one pass over the store (a merge of the customers
+        added, sorted once, or a compaction around the customers taken out) and one rebuild of the deficit queue,
+        rather than one of each per customer. The customers added should have pledge codes not already held, and
+        their totals are summed as insert does. The customers taken out must be held by this store - they are not
+        freed, and no longer have stored totals. O(N + KlogK) for K customers
+    */
+    void insert(vector<Customer_Node*>& added);
+
+    void erase(const vector<Customer_Node*>& removed);
+
+    /*
+        Function replaces the contents of the store with the customers passed in, sorting them once and summing the
+        totals of each. Each pledge code should appear only once. O(NlogN)
+    */
+    void assign(vector<Customer_Node*>& customers);
+
+    //drops every customer from the store without touching them - they may already have been freed (see clear_customers)
+    void clear();
+
+    void reserve(size_t count);
+
+    /*
+        Functions change the totals of the customer in a row, used by Customer_Node as its accounts and pledged
+        securities change. O(1)
+    */
+    void move_totals(size_t row, Money balance_change, Money pledged_change)
+    {
+        balances[row] += balance_change;
+        pledged[row] += pledged_change;
+        over_unders[row] = pledged[row] - balances[row];
+        underpledged.update(row, over_unders[row]);
+    }
+
+    void set_totals(size_t row, Money balance, Money pledged_total)
+    {
+        balances[row] = balance;
+        pledged[row] = pledged_total;
+        over_unders[row] = pledged_total - balance;
+        underpledged.update(row, over_unders[row]);
+    }
+
+    /*
+        Function sets the order the underpledged customers are handed out in. The store keeps it when a loaded
+        store is moved into it. O(N) if it changes, otherwise O(1)
+    */
+    void set_pledge_order(Pledge_Order order);
+
+    Pledge_Order pledge_order() const;
+
+    /*--------------------------------------------- Customer Store Lookup Functions --------------------------------------------*/
+
+    /*
+        Function returns the customer with the passed in pledge code, or nullptr if there is none. O(logN)
+    */
+    Customer_Node* find(int pledge_code) const;
+
+    //customer at a position, in pledge code order
+    Customer_Node* at(size_t position) const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
+    /*
+        Function returns the next underpledged customer in the pledge order, or nullptr if every customer is
+        covered. O(1)
+    */
+    Customer_Node* next_underpledged() const;
+
+    size_t underpledged_count() const;
+
+    //total amount the underpledged customers are short of collateral, as a positive amount. O(1)
+    Money deficit_total() const;
+
+    //checks the deficit queue holds exactly the underpledged customers, in heap order. O(N)
+    bool queue_in_sync() const;
+
+    //the totals columns, one entry per customer in the same order as at()
+    const Money* balance_column() const { return balances.data(); }
+
+    const Money* pledged_column() const { return pledged.data(); }
+
+    const Money* over_under_column() const { return over_unders.data(); }
+
+private:
+
+    //position of the first pledge code not below the one passed in
+    size_t lower_bound(int pledge_code) const;
+
+    //points the customers from a position on at their rows in this store
+    void set_rows(size_t first_position);
+
+    //copies a row of every column to another position
+    void move_row(size_t from, size_t to);
+
+    //resizes every column to the number of customers passed in
+    void resize(size_t count);
+
+    vector<int> pledge_codes;
+    vector<Customer_Node*> customers;
+    vector<Money> balances;
+    vector<Money> pledged;
+    vector<Money> over_unders;
+    Deficit_Queue underpledged;
+};
+
+
+#endif
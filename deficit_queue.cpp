@@ -0,0 +1,250 @@
+#include "deficit_queue.h"
+
+using namespace std;
+
+
+/*------------------------------------------------- Deficit Queue Update Functions ---------------------------------------------*/
+
+void Deficit_Queue::update(size_t row, Money over_under)
+{
+    if(row >= positions.size())
+    {
+        positions.resize(row + 1, NOT_QUEUED);
+    }
+    size_t position = positions.at(row);
+    if(position != NOT_QUEUED)
+    {
+        deficit += heap.at(position).over_under;
+        if(over_under >= Money())
+        {
+            remove_at(position);
+            return;
+        }
+        //the heap is keyed on the old value - the entry moves whichever way the new one takes it
+        Queue_Entry entry = {row, over_under};
+        heap.at(position) = entry;
+        deficit -= over_under;
+        sift_up(position);
+        sift_down(positions.at(row));
+        return;
+    }
+    if(over_under < Money())
+    {
+        Queue_Entry entry = {row, over_under};
+        heap.push_back(entry);
+        positions.at(row) = heap.size() - 1;
+        deficit -= over_under;
+        sift_up(heap.size() - 1);
+    }
+}
+
+void Deficit_Queue::rebuild(const Money* over_under, size_t row_count)
+{
+    heap.clear();
+    positions.assign(row_count, NOT_QUEUED);
+    deficit = Money();
+    for(size_t row = 0; row < row_count; row++)
+    {
+        if(over_under[row] < Money())
+        {
+            Queue_Entry entry = {row, over_under[row]};
+            positions.at(row) = heap.size();
+            heap.push_back(entry);
+            deficit -= over_under[row];
+        }
+    }
+    //bottom up heap build - each parent is sifted down below its children
+    for(size_t position = heap.size() / 2; position > 0; position--)
+    {
+        sift_down(position - 1);
+    }
+}
+
+void Deficit_Queue::set_order(Pledge_Order order)
+{
+    if(order == current_order)
+    {
+        return;
+    }
+    current_order = order;
+    for(size_t position = heap.size() / 2; position > 0; position--)
+    {
+        sift_down(position - 1);
+    }
+}
+
+void Deficit_Queue::clear()
+{
+    heap.clear();
+    positions.clear();
+    deficit = Money();
+}
+
+
+/*------------------------------------------------- Deficit Queue Lookup Functions ---------------------------------------------*/
+
+Pledge_Order Deficit_Queue::order() const
+{
+    return current_order;
+}
+
+size_t Deficit_Queue::top() const
+{
+    return heap.front().row;
+}
+
+bool Deficit_Queue::empty() const
+{
+    return heap.empty();
+}
+
+size_t Deficit_Queue::size() const
+{
+    return heap.size();
+}
+
+Money Deficit_Queue::deficit_total() const
+{
+    return deficit;
+}
+
+bool Deficit_Queue::validate(const Money* over_under, size_t row_count) const
+{
+    if(positions.size() < row_count)
+    {
+        return false;
+    }
+    Money expected;
+    size_t queued = 0;
+    for(size_t row = 0; row < row_count; row++)
+    {
+        size_t position = positions.at(row);
+        if(over_under[row] < Money())
+        {
+            expected -= over_under[row];
+            queued++;
+            if(position >= heap.size() || heap.at(position).row != row || heap.at(position).over_under != over_under[row])
+            {
+                return false;
+            }
+        }
+        else if(position != NOT_QUEUED)
+        {
+            return false;
+        }
+    }
+    for(size_t position = 1; position < heap.size(); position++)
+    {
+        if(before(heap.at(position), heap.at((position - 1) / 2)))
+        {
+            return false;
+        }
+    }
+    return queued == heap.size() && expected == deficit;
+}
+
+bool Deficit_Queue::order_from_name(const string& name, Pledge_Order& order)
+{
+    if(name == "code")
+    {
+        order = PLEDGE_ORDER_CODE;
+    }
+    else if(name == "largest")
+    {
+        order = PLEDGE_ORDER_LARGEST_DEFICIT;
+    }
+    else if(name == "smallest")
+    {
+        order = PLEDGE_ORDER_SMALLEST_DEFICIT;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+string Deficit_Queue::order_name(Pledge_Order order)
+{
+    if(order == PLEDGE_ORDER_LARGEST_DEFICIT)
+    {
+        return "Largest Deficit First";
+    }
+    if(order == PLEDGE_ORDER_SMALLEST_DEFICIT)
+    {
+        return "Smallest Deficit First";
+    }
+    return "Pledge Code";
+}
+
+
+/*------------------------------------------------- Deficit Queue Heap Functions -----------------------------------------------*/
+
+bool Deficit_Queue::before(const Queue_Entry& entry, const Queue_Entry& other) const
+{
+    //over_under is negative, so the largest deficit is the smallest over_under
+    if(current_order == PLEDGE_ORDER_LARGEST_DEFICIT && entry.over_under != other.over_under)
+    {
+        return entry.over_under < other.over_under;
+    }
+    if(current_order == PLEDGE_ORDER_SMALLEST_DEFICIT && entry.over_under != other.over_under)
+    {
+        return entry.over_under > other.over_under;
+    }
+    return entry.row < other.row;
+}
+
+void Deficit_Queue::sift_up(size_t position)
+{
+    Queue_Entry entry = heap.at(position);
+    while(position > 0 && before(entry, heap.at((position - 1) / 2)))
+    {
+        place(heap.at((position - 1) / 2), position);
+        position = (position - 1) / 2;
+    }
+    place(entry, position);
+}
+
+void Deficit_Queue::sift_down(size_t position)
+{
+    Queue_Entry entry = heap.at(position);
+    while(true)
+    {
+        size_t child = position * 2 + 1;
+        if(child >= heap.size())
+        {
+            break;
+        }
+        if(child + 1 < heap.size() && before(heap.at(child + 1), heap.at(child)))
+        {
+            child++;
+        }
+        if(!before(heap.at(child), entry))
+        {
+            break;
+        }
+        place(heap.at(child), position);
+        position = child;
+    }
+    place(entry, position);
+}
+
+void Deficit_Queue::place(const Queue_Entry& entry, size_t position)
+{
+    heap.at(position) = entry;
+    positions.at(entry.row) = position;
+}
+
+void Deficit_Queue::remove_at(size_t position)
+{
+    positions.at(heap.at(position).row) = NOT_QUEUED;
+    Queue_Entry last = heap.back();
+    heap.pop_back();
+    if(position == heap.size())
+    {
+        return;
+    }
+    place(last, position);
+    sift_up(position);
+    sift_down(positions.at(last.row));
+}
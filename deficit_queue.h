@@ -0,0 +1,104 @@
+#ifndef DEFICIT_QUEUE_H
+#define DEFICIT_QUEUE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "money.h"
+
+
+using namespace std;
+
+//order the underpledged customers are pledged to
+enum Pledge_Order {PLEDGE_ORDER_CODE, PLEDGE_ORDER_LARGEST_DEFICIT, PLEDGE_ORDER_SMALLEST_DEFICIT};
+
+
+/* -----------------------------------------------------Deficit Queue Class-----------------------------------------------------*/
+
+/*
+    The deficit queue holds the rows of the customer store whose over_under is below zero, as an indexed binary heap:
+    the position of each row in the heap is kept, so a row whose over_under changes is moved up or down, added or
+    taken out in O(logN) without searching for it. The total deficit of the rows held is kept as they change.
+
+    The top of the heap is the next customer to pledge to, in the chosen order - pledge code (the row itself), the
+    largest deficit first or the smallest deficit first. Ties go to the lower pledge code.
+*/
+class Deficit_Queue
+{
+public:
+
+    /*
+        Function sets the over_under of a row - the row is added to the queue if it is now below zero, moved if it
+        was already held and taken out if it is not. O(logN)
+    */
+    void update(size_t row, Money over_under);
+
+    /*
+        Function rebuilds the queue from the over_under of every row of the store. O(N)
+    */
+    void rebuild(const Money* over_under, size_t row_count);
+
+    /*
+        Function changes the order of the queue, rebuilding the heap if it differs. O(N) when it does.
+    */
+    void set_order(Pledge_Order order);
+
+    Pledge_Order order() const;
+
+    //row at the top of the queue - only valid when the queue isn't empty
+    size_t top() const;
+
+    bool empty() const;
+
+    size_t size() const;
+
+    //sum of the deficits of every row held, as a positive amount
+    Money deficit_total() const;
+
+    void clear();
+
+    /*
+        Function checks that every row below zero is held at its recorded position, the heap order holds and the
+        deficit total is right, against the over_under of every row passed in. O(N)
+    */
+    bool validate(const Money* over_under, size_t row_count) const;
+
+    /*
+        Function reads the order from its name - "code", "largest" or "smallest". Returns false if the name is
+        not one of them.
+    */
+    static bool order_from_name(const string& name, Pledge_Order& order);
+
+    static string order_name(Pledge_Order order);
+
+private:
+
+    static constexpr size_t NOT_QUEUED = SIZE_MAX;
+
+    struct Queue_Entry
+    {
+        size_t row;
+        Money over_under;
+    };
+
+    //true if the entry should come out of the queue before the other
+    bool before(const Queue_Entry& entry, const Queue_Entry& other) const;
+
+    void sift_up(size_t position);
+
+    void sift_down(size_t position);
+
+    //moves an entry to a heap position and records where it is
+    void place(const Queue_Entry& entry, size_t position);
+
+    void remove_at(size_t position);
+
+    Pledge_Order current_order = PLEDGE_ORDER_CODE;
+    vector<Queue_Entry> heap;
+    vector<size_t> positions; //heap position of each row of the store, NOT_QUEUED if it isn't held
+    Money deficit;
+};
+
+
+#endif
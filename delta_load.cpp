@@ -0,0 +1,326 @@
+#include "delta_load.h"
+#include "supporting_func_structs.h"
+#include <set>
+#include <unordered_map>
+#include <cctype>
+
+using namespace std;
+
+
+/*----------------------------------------------------- Delta Row Functions ----------------------------------------------------*/
+
+enum Delta_Change
+{
+    DELTA_UPDATE,
+    DELTA_REMOVE,
+    DELTA_UNKNOWN
+};
+
+//reads the Change column - the word is matched without regard to case
+static Delta_Change read_change(string_view change, bool security_file)
+{
+    string word;
+    for(size_t i = 0; i < change.size(); i++)
+    {
+        if(change[i] != ' ' && change[i] != '\r')
+        {
+            word += tolower(static_cast<unsigned char>(change[i]));
+        }
+    }
+    if(word == "update" || word == "add")
+    {
+        return DELTA_UPDATE;
+    }
+    if((security_file && word == "sell") || (!security_file && word == "close"))
+    {
+        return DELTA_REMOVE;
+    }
+    return DELTA_UNKNOWN;
+}
+
+/*
+    Function releases every security pledged to a customer that is being removed. Each is unpledged (a copy is
+    added to the pledge removals for the export) and added back to the index.
+*/
+static void release_customer_securities(Customer_Node* customer, Security_Index& tree, vector<RBT_Security_Node*>& pledge_removals)
+{
+    vector<RBT_Security_Node*> released = customer->release_pledged();
+    for(size_t i = 0; i < released.size(); i++)
+    {
+        RBT_Security_Node* security = released.at(i);
+        RBT_Security_Node* security_copy = RBT::RBT_copy_node(security);
+        security_copy->change_status = "Unpledge";
+        pledge_removals.push_back(security_copy);
+        security->pledge_id = 0;
+        security->pledge_description = "";
+        tree.add_security(security);
+    }
+}
+
+/*
+    This structure holds the customers a customer delta adds and closes until every row is read, so the store is
+    changed once for all of them (see Customer_Store::insert and erase) rather than once per customer.
+*/
+struct Pending_Customers
+{
+    unordered_map<int, Customer_Node*> added; //new customers, by pledge code - not in the store yet
+    set<Customer_Node*> closed; //customers of the store that closed every account - still in it, but not found
+};
+
+//returns the customer with the pledge code as the delta has left it - added by an earlier row, or held by the store
+//and not closed - or nullptr if there is none
+static Customer_Node* find_customer(int pledge_id, Customer_Store& customers, Pending_Customers& pending)
+{
+    Customer_Node* customer = customers.find(pledge_id);
+    if(customer != nullptr && pending.closed.count(customer) == 0)
+    {
+        return customer;
+    }
+    unordered_map<int, Customer_Node*>::iterator added = pending.added.find(pledge_id);
+    return (added != pending.added.end()) ? added->second : nullptr;
+}
+
+static void apply_account_change(const vector<string_view>& row, Delta_Change change, Customer_Store& customers,
+                                 Pending_Customers& pending, Security_Index& tree, vector<RBT_Security_Node*>& pledge_removals,
+                                 set<Customer_Node*>& changed_customers, Delta_Summary& summary)
+{
+    int pledge_id = field_to_int(row.at(0));
+    int account_number = field_to_int(row.at(4));
+    Customer_Node* customer = find_customer(pledge_id, customers, pending);
+    size_t account = 0;
+    if(customer != nullptr)
+    {
+        while(account < customer->accounts.size() && customer->accounts.at(account).account_number != account_number)
+        {
+            account++;
+        }
+    }
+
+    if(change == DELTA_REMOVE)
+    {
+        if(customer == nullptr || account == customer->accounts.size())
+        {
+            summary.skipped++;
+            return;
+        }
+        customer->remove_account(account);
+        summary.removed++;
+        if(customer->accounts.empty())
+        {   //the customer has closed every account - its securities go back to the tree
+            release_customer_securities(customer, tree, pledge_removals);
+            changed_customers.erase(customer);
+            if(pending.added.erase(pledge_id) > 0)
+            {   //added by this delta, so never in the store
+                delete customer;
+            }
+            else
+            {
+                pending.closed.insert(customer);
+            }
+            return;
+        }
+        changed_customers.insert(customer);
+        return;
+    }
+
+    if(customer == nullptr)
+    {
+        customer = build_customer_node(row);
+        pending.added.emplace(pledge_id, customer);
+        summary.added++;
+    }
+    else if(account == customer->accounts.size())
+    {
+        customer->add_account(build_account_node(row));
+        summary.added++;
+    }
+    else
+    {
+        Account_Node details = build_account_node(row);
+        Account_Node& held = customer->accounts.at(account);
+        held.interest_rate = details.interest_rate;
+        held.account_type = details.account_type;
+        held.class_code_description = details.class_code_description;
+        customer->set_account_balance(account, details.current_balance);
+        summary.updated++;
+    }
+    changed_customers.insert(customer);
+}
+
+/*
+    Function returns the customer a lot is pledged to, with the lot's position in its pledged securities, or nullptr
+    if the lot is free.
+*/
+static Customer_Node* pledged_customer(RBT_Security_Node* lot, Customer_Store& customers, size_t& position)
+{
+    Customer_Node* customer = (lot->pledge_id != 0) ? customers.find(lot->pledge_id) : nullptr;
+    if(customer == nullptr)
+    {
+        return nullptr;
+    }
+    vector<RBT_Security_Node*>& pledged = customer->pledged_to_customer;
+    for(position = 0; position < pledged.size(); position++)
+    {
+        if(pledged.at(position) == lot)
+        {
+            return customer;
+        }
+    }
+    return nullptr;
+}
+
+static void apply_security_change(const vector<string_view>& row, Delta_Change change, Customer_Store& customers,
+                                  Security_Index& tree, Security_Catalog& catalog, vector<RBT_Security_Node*>& pledge_removals,
+                                  set<Customer_Node*>& changed_customers, Delta_Summary& summary)
+{
+    RBT_Security_Node* details = RBT::build_security_node(row);
+    RBT_Security_Node* lot = catalog.find_ticket(details->ticket);
+
+    if(lot == nullptr)
+    {
+        if(change == DELTA_REMOVE)
+        {
+            delete details;
+            summary.skipped++;
+            return;
+        }
+        //a new lot is placed as the import would place it
+        Customer_Node* customer = place_loaded_security(customers, pledge_removals, details);
+        if(customer != nullptr)
+        {
+            catalog.register_record(details);
+            changed_customers.insert(customer);
+        }
+        else
+        {
+            tree.add_security(details);
+        }
+        summary.added++;
+        return;
+    }
+
+    //the lot leaves the catalog (its maturity and group may change) and a free lot the index (its key may change).
+    //Taking a lot out of the index keeps it in the catalog, as pledged lots stay there, so it is unregistered here
+    size_t position = 0;
+    Customer_Node* customer = pledged_customer(lot, customers, position);
+    if(customer == nullptr)
+    {
+        tree.remove_security(lot);
+    }
+    catalog.unregister_record(lot);
+
+    if(change == DELTA_REMOVE)
+    {
+        if(customer != nullptr)
+        {   //the pledge is released - a copy goes to the pledge removals for the export, as for a removed customer
+            RBT_Security_Node* lot_copy = RBT::RBT_copy_node(lot);
+            lot_copy->change_status = "Unpledge";
+            pledge_removals.push_back(lot_copy);
+            customer->unpledge_security(position);
+            changed_customers.insert(customer);
+        }
+        delete lot;
+        delete details;
+        summary.removed++;
+        return;
+    }
+
+    lot->portfolio = details->portfolio;
+    lot->cusip = details->cusip;
+    lot->maturity = details->maturity;
+    lot->pledge_amount = details->pledge_amount;
+    lot->par_value = details->par_value;
+    lot->group = details->group;
+    lot->security_description = details->security_description;
+
+    if(customer != nullptr)
+    {   //the customer's pledged total moves by the change in value
+        customer->set_pledged_value(lot, details->market_value);
+        delete details;
+        catalog.register_record(lot);
+        changed_customers.insert(customer);
+    }
+    else
+    {   //added back under its new market value - the index registers it in the catalog again
+        lot->market_value = details->market_value;
+        delete details;
+        tree.add_security(lot);
+    }
+    summary.updated++;
+}
+
+
+/*----------------------------------------------------- Delta Load Functions ---------------------------------------------------*/
+
+Delta_Summary apply_delta_file(Mapped_File& delta_file, Customer_Store& customers, Security_Index& tree,
+                               Security_Catalog& catalog, vector<RBT_Security_Node*>& pledge_removals)
+{
+    Delta_Summary summary;
+    Csv_Reader delta_rows(delta_file);
+    vector<string_view> delta_fields;
+
+    //the header tells a security delta (it has a CUSIP column) from a customer delta
+    if(!delta_rows.next_row(delta_fields))
+    {
+        delta_file.close();
+        return summary;
+    }
+    for(size_t i = 0; i < delta_fields.size(); i++)
+    {
+        summary.security_file = summary.security_file || delta_fields.at(i) == "CUSIP";
+    }
+
+    set<Customer_Node*> changed_customers;
+    Pending_Customers pending;
+    vector<string_view> row;
+    while(delta_rows.next_row(delta_fields))
+    {
+        summary.rows_read++;
+        Delta_Change change = read_change(delta_fields.at(0), summary.security_file);
+        if(change == DELTA_UNKNOWN)
+        {
+            summary.skipped++;
+            continue;
+        }
+        //the rest of the row has the columns of the full file
+        row.assign(delta_fields.begin() + 1, delta_fields.end());
+        if(summary.security_file)
+        {
+            apply_security_change(row, change, customers, tree, catalog, pledge_removals, changed_customers, summary);
+        }
+        else
+        {
+            apply_account_change(row, change, customers, pending, tree, pledge_removals, changed_customers, summary);
+        }
+    }
+    delta_file.close();
+
+    //the customers closed and added are taken out of and merged into the store in one pass each
+    vector<Customer_Node*> closed(pending.closed.begin(), pending.closed.end());
+    customers.erase(closed);
+    for(Customer_Node* customer : closed)
+    {
+        delete customer;
+    }
+    vector<Customer_Node*> added;
+    added.reserve(pending.added.size());
+    for(const pair<const int, Customer_Node*>& customer : pending.added)
+    {
+        added.push_back(customer.second);
+    }
+    customers.insert(added);
+
+    //the totals of each customer changed were moved with every account or pledged lot changed
+    summary.customers_changed = changed_customers.size();
+    return summary;
+}
+
+void display_delta_summary(const Delta_Summary& summary)
+{
+    cout << (summary.security_file ? "Security" : "Customer") << " Delta Rows Read: " << summary.rows_read << endl;
+    cout << (summary.security_file ? "Lots Added: " : "Accounts Added: ") << summary.added
+         << "  Updated: " << summary.updated
+         << (summary.security_file ? "  Sold: " : "  Closed: ") << summary.removed
+         << "  Skipped: " << summary.skipped << endl;
+    cout << "Customer Totals Changed: " << summary.customers_changed << endl;
+}
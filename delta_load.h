@@ -0,0 +1,63 @@
+#ifndef DELTA_LOAD_H
+#define DELTA_LOAD_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "security_index.h"
+#include "security_catalog.h"
+#include "csv_reader.h"
+#include "customer_store.h"
+
+
+using namespace std;
+
+
+/*--------------------------------------------------- Delta Load Structures ----------------------------------------------------*/
+
+/*
+    This structure reports what a delta file changed.
+*/
+struct Delta_Summary
+{
+    bool security_file = false; //false for a customer delta file
+    int rows_read = 0;
+    int added = 0; //accounts / lots that were not held before
+    int updated = 0; //accounts / lots changed in place (repriced lots are re-keyed in the index)
+    int removed = 0; //accounts closed / lots sold
+    int skipped = 0; //rows with an unknown change or naming an account / lot that is not held
+    int customers_changed = 0; //customers whose accounts or pledged lots changed
+};
+
+
+/*----------------------------------------------------- Delta Load Functions ---------------------------------------------------*/
+
+/*
+    Function applies a delta file - only the rows that changed since the files were loaded - to the loaded state in
+    place, instead of clearing everything and importing the full files again.
+
+    A delta file has the columns of the customer or security file with a Change column in front, and which kind
+    it is is read from its header:
+        customer rows - "Update" adds the account, or replaces the details and balance of an account already held
+                        (a new pledge ID adds the customer). "Close" closes the account; a customer left without
+                        accounts is removed and its pledged securities are released to the index as unpledges.
+        security rows - "Update" adds the lot, placed as an import places it, or replaces the details and market
+                        value of the lot with that ticket. A repriced free lot is taken out of the index and added
+                        back under its new key. The pledge of a lot already held is left as it is. "Sell" removes
+                        the lot, from the index or from the customer it is pledged to.
+    "Add" is read as "Update", so applying the same file twice leaves the same state.
+
+    The catalog is kept in sync with every lot changed. Customer totals are moved by each account or pledged lot
+    changed, so nothing is summed again. The index should be the journal the catalog is attached to - it registers
+    the free lots it adds, and the lots pledged to customers are registered here - committed once the delta is applied.
+*/
+Delta_Summary apply_delta_file(Mapped_File& delta_file, Customer_Store& customers, Security_Index& tree,
+                               Security_Catalog& catalog, vector<RBT_Security_Node*>& pledge_removals);
+
+/*
+    Function prints the summary of a delta file applied.
+*/
+void display_delta_summary(const Delta_Summary& summary);
+
+
+#endif
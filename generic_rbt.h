@@ -0,0 +1,848 @@
+#ifndef GENERIC_RBT_H
+#define GENERIC_RBT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <cstdint>
+#include "node_pool.h"
+
+
+using namespace std;
+#define GENERIC_RBT_MAX_DEPTH 130 //deepest path a red-black tree of 2^64 nodes can have (2 * 64), plus room for a rotation
+
+
+/*------------------------------------------------- Generic Red-Black Tree Policies --------------------------------------------*/
+
+/*
+    The node policy chooses how a tree node is laid out. The color is either kept in its own byte or packed into the
+    lowest bit of the left child pointer (nodes are always at least 2 byte aligned, so that bit is otherwise 0).
+    Nodes either keep a parent pointer or do without one - inserts and removals keep the path from the root on a
+    small stack, so parent pointers are only needed to step from a node to the next one or to remove a node by its
+    handle. Everything is chosen at compile time, so no policy costs a branch or a virtual call in the hot path.
+
+    The policy's augment is kept in every node as well - data about the node's whole subtree, such as its size or a
+    total of its keys. The tree calls the augment's update hook on a node whenever the node's children change (the
+    path above a node linked in or removed, and both nodes of a rotation), lower nodes first, so the hook only has
+    to read the node and its two children. RBT_No_Augment keeps nothing and its hook compiles away.
+*/
+struct RBT_No_Augment
+{
+    template <typename Node>
+    static void update(Node*) {}
+};
+
+template <bool Packed_Color, bool Parent_Links, typename Augment = RBT_No_Augment>
+struct RBT_Policy
+{
+    static constexpr bool packed_color = Packed_Color;
+    static constexpr bool parent_links = Parent_Links;
+    typedef Augment augment;
+};
+
+//color byte and parent pointers
+typedef RBT_Policy<false, true> RBT_Default_Policy;
+
+//color packed into the left child pointer, parent pointers kept
+typedef RBT_Policy<true, true> RBT_Packed_Policy;
+
+//color packed and no parent pointers - two pointers per node, for trees that are only searched and walked in order
+typedef RBT_Policy<true, false> RBT_Compact_Policy;
+
+
+/*-------------------------------------------------- Generic Red-Black Tree Nodes ----------------------------------------------*/
+
+template <typename Node, bool Packed_Color>
+struct Generic_RBT_Links;
+
+//child links with the color in its own byte
+template <typename Node>
+struct Generic_RBT_Links<Node, false>
+{
+    Node* left_link = nullptr;
+    Node* right_link = nullptr;
+    bool red = false;
+
+    Node* left() const { return left_link; }
+    Node* right() const { return right_link; }
+    void set_left(Node* node) { left_link = node; }
+    void set_right(Node* node) { right_link = node; }
+    bool is_red() const { return red; }
+    void set_red(bool is_red) { red = is_red; }
+};
+
+//child links with the color in the lowest bit of the left child pointer (1 is red)
+template <typename Node>
+struct Generic_RBT_Links<Node, true>
+{
+    uintptr_t left_bits = 0;
+    Node* right_link = nullptr;
+
+    Node* left() const { return reinterpret_cast<Node*>(left_bits & ~uintptr_t(1)); }
+    Node* right() const { return right_link; }
+    void set_left(Node* node) { left_bits = reinterpret_cast<uintptr_t>(node) | (left_bits & 1); }
+    void set_right(Node* node) { right_link = node; }
+    bool is_red() const { return left_bits & 1; }
+    void set_red(bool is_red) { left_bits = (left_bits & ~uintptr_t(1)) | uintptr_t(is_red); }
+};
+
+//without parent links the base is empty and takes no space in the node
+template <typename Node, bool Parent_Links>
+struct Generic_RBT_Parent
+{
+    Node* parent() const { return nullptr; }
+    void set_parent(Node*) {}
+};
+
+template <typename Node>
+struct Generic_RBT_Parent<Node, true>
+{
+    Node* parent_link = nullptr;
+
+    Node* parent() const { return parent_link; }
+    void set_parent(Node* node) { parent_link = node; }
+};
+
+/*
+    This structure is a node of the generic tree - the links chosen by the policy and its augment, then the key
+    and the payload.
+*/
+template <typename Key, typename Value, typename Policy>
+struct Generic_RBT_Node : Generic_RBT_Links<Generic_RBT_Node<Key, Value, Policy>, Policy::packed_color>,
+                          Generic_RBT_Parent<Generic_RBT_Node<Key, Value, Policy>, Policy::parent_links>,
+                          Policy::augment
+{
+    Key key;
+    Value value;
+
+    Generic_RBT_Node(const Key& key, const Value& value) : key(key), value(value) {}
+};
+
+
+/* ---------------------------------------------- Generic Red-Black Tree Class--------------------------------------------------*/
+
+/*
+    Header-only red-black tree over any key, payload and comparator. Equal keys are allowed and kept in the order
+    they were inserted. Nodes come from a slab pool owned by the tree, so clearing the tree is a pool reset and
+    nodes keep their address for as long as they are in the tree - removals relink nodes rather than moving keys.
+
+    Every red-black rule lives here. The security tree (RBT) is an instantiation keyed on market value and ticket,
+    whose policy's augment keeps subtree counts and market value totals - RBT adds the security records, bulk load
+    ordering, the cached extremes and its validator on top. The security catalog's ordered indexes are further
+    instantiations, and benchmark/generic_rbt_benchmark.cpp compares the policies against RBT on security keys.
+*/
+template <typename Key, typename Value, typename Compare = less<Key>, typename Policy = RBT_Default_Policy>
+class Generic_RBT
+{
+public:
+
+    typedef Generic_RBT_Node<Key, Value, Policy> Node;
+
+    //Tree Constructor
+    Generic_RBT(const Compare& compare = Compare()) : compare(compare), pool(new Node_Pool<Node>) {}
+
+    //Tree Deconstructor - the pool destroys every node still in the tree
+    ~Generic_RBT() {}
+
+    //the tree owns its nodes, so it can be moved but not copied (see RBT)
+    Generic_RBT(const Generic_RBT&) = delete;
+    Generic_RBT& operator=(const Generic_RBT&) = delete;
+
+    Generic_RBT(Generic_RBT&& other) noexcept
+        : root(other.root), count(other.count), compare(move(other.compare)), pool(move(other.pool))
+    {
+        other.root = nullptr;
+        other.count = 0;
+        other.pool.reset(new Node_Pool<Node>);
+    }
+
+    Generic_RBT& operator=(Generic_RBT&& other) noexcept
+    {
+        if(this != &other)
+        {
+            swap(root, other.root);
+            swap(count, other.count);
+            swap(compare, other.compare);
+            swap(pool, other.pool);
+            other.clear();
+        }
+        return *this;
+    }
+
+    /*---------------------------------- Generic Red-Black Tree Insert and Remove Functions --------------------------------*/
+
+    /*
+        Function adds the key and payload to the tree and returns the new node. Equal keys go after those
+        already in the tree. O(logN)
+    */
+    Node* insert(const Key& key, const Value& value)
+    {
+        Node* path[GENERIC_RBT_MAX_DEPTH];
+        int depth = 0;
+        bool went_left = false;
+        for(Node* cursor = root; cursor != nullptr; cursor = went_left ? cursor->left() : cursor->right())
+        {
+            path[depth++] = cursor;
+            went_left = compare(key, cursor->key);
+        }
+        Node* node = new (pool->allocate()) Node(key, value);
+        node->set_red(true);
+        if(depth == 0)
+        {
+            root = node;
+        }
+        else
+        {
+            went_left ? path[depth - 1]->set_left(node) : path[depth - 1]->set_right(node);
+            node->set_parent(path[depth - 1]);
+        }
+        count++;
+        path[depth] = node;
+        //the new node is beneath every node on its path - their augments are refreshed bottom up before rebalancing
+        for(int level = depth; level >= 0; level--)
+        {
+            Policy::augment::update(path[level]);
+        }
+        insert_fixup(path, depth);
+        return node;
+    }
+
+    /*
+        Function removes the first node (in key order) with the passed in key. Returns false if there is none.
+        O(logN)
+    */
+    bool erase(const Key& key)
+    {
+        Node* path[GENERIC_RBT_MAX_DEPTH];
+        int depth = 0;
+        int found = -1;
+        for(Node* cursor = root; cursor != nullptr; depth++)
+        {
+            path[depth] = cursor;
+            if(compare(cursor->key, key))
+            {
+                cursor = cursor->right();
+            }
+            else
+            {
+                //not below the key - the first equal key is this node or to its left
+                if(!compare(key, cursor->key))
+                {
+                    found = depth;
+                }
+                cursor = cursor->left();
+            }
+        }
+        if(found < 0)
+        {
+            return false;
+        }
+        erase_at(path, found);
+        return true;
+    }
+
+    /*
+        Function removes the passed in node from the tree. The path to the node is found through its parent
+        links, so only parent linked policies can remove by handle. O(logN)
+    */
+    void erase(Node* node)
+    {
+        static_assert(Policy::parent_links, "removing a node by its handle needs parent links");
+        Node* path[GENERIC_RBT_MAX_DEPTH];
+        int depth = 0;
+        for(Node* cursor = node; cursor != nullptr; cursor = cursor->parent())
+        {
+            depth++;
+        }
+        int position = depth - 1;
+        for(Node* cursor = node; cursor != nullptr; cursor = cursor->parent())
+        {
+            path[position--] = cursor;
+        }
+        erase_at(path, depth - 1);
+    }
+
+    /*
+        Function returns a new node from the tree's pool that is not linked into the tree yet - it joins the tree
+        through link_sorted. O(1)
+    */
+    Node* make_node(const Key& key, const Value& value)
+    {
+        return new (pool->allocate()) Node(key, value);
+    }
+
+    /*
+        Function relinks the nodes passed in into a balanced tree in O(N), splitting at the middle so every leaf
+        is on the last two levels, with every level black except the deepest, partially filled level, which is red.
+        The nodes must be in key order and must be every node of the tree - those already in it along with any new
+        ones from make_node. Nodes keep their address, so handles to them stay valid.
+    */
+    void link_sorted(const vector<Node*>& nodes)
+    {
+        count = nodes.size();
+        if(nodes.empty())
+        {
+            root = nullptr;
+            return;
+        }
+        int red_depth = 0;
+        while((size_t(2) << red_depth) <= count)
+        {
+            red_depth++;
+        }
+        root = link_balanced(nodes, 0, count, nullptr, 0, red_depth);
+    }
+
+    /*
+        Function drops every node at once through the pool - O(1) when the key and payload have
+        nothing to destroy.
+    */
+    void clear()
+    {
+        pool->reset();
+        root = nullptr;
+        count = 0;
+    }
+
+    /*------------------------------------------- Generic Red-Black Tree Lookup Functions ----------------------------------*/
+
+    //top of the tree, nullptr if the tree is empty
+    Node* root_node() const
+    {
+        return root;
+    }
+
+    /*
+        Function returns the first node (in key order) with the passed in key, or nullptr if there is none. O(logN)
+    */
+    Node* find(const Key& key) const
+    {
+        Node* first = lower_bound(key);
+        return (first != nullptr && !compare(key, first->key)) ? first : nullptr;
+    }
+
+    /*
+        Functions return the first node with a key not below / above the key passed in, or nullptr if there
+        is none. O(logN)
+    */
+    Node* lower_bound(const Key& key) const
+    {
+        Node* bound = nullptr;
+        for(Node* cursor = root; cursor != nullptr;)
+        {
+            if(compare(cursor->key, key))
+            {
+                cursor = cursor->right();
+            }
+            else
+            {
+                bound = cursor;
+                cursor = cursor->left();
+            }
+        }
+        return bound;
+    }
+
+    Node* upper_bound(const Key& key) const
+    {
+        Node* bound = nullptr;
+        for(Node* cursor = root; cursor != nullptr;)
+        {
+            if(compare(key, cursor->key))
+            {
+                bound = cursor;
+                cursor = cursor->left();
+            }
+            else
+            {
+                cursor = cursor->right();
+            }
+        }
+        return bound;
+    }
+
+    //nodes with the smallest / largest key, nullptr if the tree is empty. O(logN)
+    Node* minimum() const
+    {
+        Node* cursor = root;
+        while(cursor != nullptr && cursor->left() != nullptr)
+        {
+            cursor = cursor->left();
+        }
+        return cursor;
+    }
+
+    Node* maximum() const
+    {
+        Node* cursor = root;
+        while(cursor != nullptr && cursor->right() != nullptr)
+        {
+            cursor = cursor->right();
+        }
+        return cursor;
+    }
+
+    /*
+        Function returns the node after the passed in node in key order, or nullptr if it is the largest.
+        Steps follow the parent links, so walking the whole tree is O(N). Parent linked policies only -
+        trees without parent links are walked with for_each.
+    */
+    static Node* next(Node* node)
+    {
+        static_assert(Policy::parent_links, "stepping from a node needs parent links");
+        if(node->right() != nullptr)
+        {
+            node = node->right();
+            while(node->left() != nullptr)
+            {
+                node = node->left();
+            }
+            return node;
+        }
+        Node* parent = node->parent();
+        while(parent != nullptr && node == parent->right())
+        {
+            node = parent;
+            parent = parent->parent();
+        }
+        return parent;
+    }
+
+    //mirror image of next - the node before, or nullptr if it is the smallest
+    static Node* previous(Node* node)
+    {
+        static_assert(Policy::parent_links, "stepping from a node needs parent links");
+        if(node->left() != nullptr)
+        {
+            node = node->left();
+            while(node->right() != nullptr)
+            {
+                node = node->right();
+            }
+            return node;
+        }
+        Node* parent = node->parent();
+        while(parent != nullptr && node == parent->left())
+        {
+            node = parent;
+            parent = parent->parent();
+        }
+        return parent;
+    }
+
+    /*
+        Function calls visit on every node in key order. The walk keeps its own stack, so it needs no
+        parent links. O(N)
+    */
+    template <typename Visit>
+    void for_each(Visit visit) const
+    {
+        Node* stack[GENERIC_RBT_MAX_DEPTH];
+        int depth = 0;
+        Node* cursor = root;
+        while(cursor != nullptr || depth > 0)
+        {
+            while(cursor != nullptr)
+            {
+                stack[depth++] = cursor;
+                cursor = cursor->left();
+            }
+            cursor = stack[--depth];
+            visit(cursor);
+            cursor = cursor->right();
+        }
+    }
+
+    /*
+        Function calls visit on every node with a key between first and last (inclusive), in key order.
+        O(logN) plus the nodes visited.
+    */
+    template <typename Visit>
+    void for_each_in_range(const Key& first, const Key& last, Visit visit) const
+    {
+        Node* stack[GENERIC_RBT_MAX_DEPTH];
+        int depth = 0;
+        //only the nodes not below first are stacked - the rest of the left edge of the range is skipped
+        for(Node* cursor = root; cursor != nullptr;)
+        {
+            if(compare(cursor->key, first))
+            {
+                cursor = cursor->right();
+            }
+            else
+            {
+                stack[depth++] = cursor;
+                cursor = cursor->left();
+            }
+        }
+        while(depth > 0)
+        {
+            Node* node = stack[--depth];
+            if(compare(last, node->key))
+            {
+                return;
+            }
+            visit(node);
+            for(Node* cursor = node->right(); cursor != nullptr; cursor = cursor->left())
+            {
+                stack[depth++] = cursor;
+            }
+        }
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    //bytes held by the tree and its nodes, not counting anything the keys or payloads point to
+    size_t memory_footprint() const
+    {
+        return sizeof(Generic_RBT) + count * sizeof(Node);
+    }
+
+    //the pool the tree's nodes come from, for its live and peak node counts
+    const Node_Pool<Node>& node_pool() const
+    {
+        return *pool;
+    }
+
+    /*------------------------------------------- Generic Red-Black Tree Test Functions ------------------------------------*/
+
+    /*
+        Function checks the red-black tree invariants - keys in order, a black root, no red node with a red child,
+        the same black height on every path and, for parent linked policies, every child pointing back at its
+        parent. The walk keeps its own stack. O(N)
+    */
+    bool validate() const
+    {
+        if(root == nullptr)
+        {
+            return count == 0;
+        }
+        if(root->is_red() || root->parent() != nullptr)
+        {
+            return false;
+        }
+        //depth first, each node stacked with the black nodes above it - every empty child must see the same number
+        vector<pair<Node*, int>> stack;
+        stack.push_back({root, 0});
+        int black_height = -1;
+        size_t visited = 0;
+        while(!stack.empty())
+        {
+            Node* node = stack.back().first;
+            int blacks = stack.back().second + (node->is_red() ? 0 : 1);
+            stack.pop_back();
+            visited++;
+            if(visited > count)
+            {
+                return false;
+            }
+            Node* children[2] = {node->left(), node->right()};
+            for(int side = 0; side < 2; side++)
+            {
+                Node* child = children[side];
+                if(child == nullptr)
+                {
+                    if(black_height < 0)
+                    {
+                        black_height = blacks;
+                    }
+                    else if(black_height != blacks)
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                if((node->is_red() && child->is_red()) || (Policy::parent_links && child->parent() != node))
+                {
+                    return false;
+                }
+                stack.push_back({child, blacks});
+            }
+        }
+        //an in-order walk of a search tree never steps back to a smaller key
+        bool ordered = true;
+        Node* previous = nullptr;
+        for_each([&](Node* node)
+        {
+            if(previous != nullptr && compare(node->key, previous->key))
+            {
+                ordered = false;
+            }
+            previous = node;
+        });
+        return ordered && visited == count;
+    }
+
+private:
+
+    Node* root = nullptr;
+    size_t count = 0;
+    Compare compare;
+    unique_ptr<Node_Pool<Node>> pool;
+
+    static bool is_red(Node* node)
+    {
+        return node != nullptr && node->is_red();
+    }
+
+    //links nodes[low, high) beneath parent and returns the middle node, which heads them
+    Node* link_balanced(const vector<Node*>& nodes, size_t low, size_t high, Node* parent, int depth, int red_depth)
+    {
+        if(low >= high)
+        {
+            return nullptr;
+        }
+        //the lower middle of an even range, so the left half is never the larger one
+        size_t middle = low + (high - 1 - low) / 2;
+        Node* node = nodes[middle];
+        node->set_parent(parent);
+        //the root is always black, even when the whole tree is a single level
+        node->set_red(depth == red_depth && depth > 0);
+        node->set_left(link_balanced(nodes, low, middle, node, depth + 1, red_depth));
+        node->set_right(link_balanced(nodes, middle + 1, high, node, depth + 1, red_depth));
+        Policy::augment::update(node);
+        return node;
+    }
+
+    //links new_child where old_child hung beneath parent (or at the root when parent is nullptr)
+    void replace_child(Node* parent, Node* old_child, Node* new_child)
+    {
+        if(parent == nullptr)
+        {
+            root = new_child;
+        }
+        else if(parent->left() == old_child)
+        {
+            parent->set_left(new_child);
+        }
+        else
+        {
+            parent->set_right(new_child);
+        }
+        if(new_child != nullptr)
+        {
+            new_child->set_parent(parent);
+        }
+    }
+
+    //rotations take the node's parent from the caller's path and return the node that took its place
+    Node* rotate_left(Node* node, Node* parent)
+    {
+        Node* pivot = node->right();
+        node->set_right(pivot->left());
+        if(pivot->left() != nullptr)
+        {
+            pivot->left()->set_parent(node);
+        }
+        replace_child(parent, node, pivot);
+        pivot->set_left(node);
+        node->set_parent(pivot);
+        //the node is now beneath the pivot - the lower node is refreshed first
+        Policy::augment::update(node);
+        Policy::augment::update(pivot);
+        return pivot;
+    }
+
+    Node* rotate_right(Node* node, Node* parent)
+    {
+        Node* pivot = node->left();
+        node->set_left(pivot->right());
+        if(pivot->right() != nullptr)
+        {
+            pivot->right()->set_parent(node);
+        }
+        replace_child(parent, node, pivot);
+        pivot->set_right(node);
+        node->set_parent(pivot);
+        Policy::augment::update(node);
+        Policy::augment::update(pivot);
+        return pivot;
+    }
+
+    //path[depth] is the red node just linked in, path[0] the root
+    void insert_fixup(Node** path, int depth)
+    {
+        //a red parent is never the root, so there is always a grandparent
+        while(depth >= 2 && path[depth - 1]->is_red())
+        {
+            Node* node = path[depth];
+            Node* parent = path[depth - 1];
+            Node* grandparent = path[depth - 2];
+            Node* above = (depth >= 3) ? path[depth - 3] : nullptr;
+            if(parent == grandparent->left())
+            {
+                Node* uncle = grandparent->right();
+                if(is_red(uncle))
+                {
+                    parent->set_red(false);
+                    uncle->set_red(false);
+                    grandparent->set_red(true);
+                    depth -= 2;
+                    continue;
+                }
+                if(node == parent->right())
+                {
+                    rotate_left(parent, grandparent);
+                    parent = node;
+                }
+                rotate_right(grandparent, above);
+            }
+            else
+            {
+                Node* uncle = grandparent->left();
+                if(is_red(uncle))
+                {
+                    parent->set_red(false);
+                    uncle->set_red(false);
+                    grandparent->set_red(true);
+                    depth -= 2;
+                    continue;
+                }
+                if(node == parent->left())
+                {
+                    rotate_right(parent, grandparent);
+                    parent = node;
+                }
+                rotate_left(grandparent, above);
+            }
+            parent->set_red(false);
+            grandparent->set_red(true);
+            break;
+        }
+        root->set_red(false);
+    }
+
+    //path[depth] is the node to remove, path[0] the root - the path array must have room to grow by the successor's depth
+    void erase_at(Node** path, int depth)
+    {
+        Node* node = path[depth];
+        Node* parent; //parent of the position that lost a node
+        Node* child; //node moved up into that position, may be nullptr
+        bool child_left;
+        bool removed_red;
+        int parent_depth;
+
+        if(node->left() == nullptr || node->right() == nullptr)
+        {
+            child = (node->left() != nullptr) ? node->left() : node->right();
+            parent = (depth > 0) ? path[depth - 1] : nullptr;
+            child_left = (parent != nullptr && parent->left() == node);
+            removed_red = node->is_red();
+            replace_child(parent, node, child);
+            parent_depth = depth - 1;
+        }
+        else
+        {
+            //the successor is relinked into the node's place, so no other node changes its key
+            int successor_depth = depth + 1;
+            Node* successor = node->right();
+            path[successor_depth] = successor;
+            while(successor->left() != nullptr)
+            {
+                successor = successor->left();
+                path[++successor_depth] = successor;
+            }
+            removed_red = successor->is_red();
+            child = successor->right();
+            if(successor_depth == depth + 1)
+            {
+                parent = successor;
+                child_left = false;
+            }
+            else
+            {
+                parent = path[successor_depth - 1];
+                child_left = true;
+                parent->set_left(child);
+                if(child != nullptr)
+                {
+                    child->set_parent(parent);
+                }
+                successor->set_right(node->right());
+                node->right()->set_parent(successor);
+            }
+            replace_child((depth > 0) ? path[depth - 1] : nullptr, node, successor);
+            successor->set_left(node->left());
+            node->left()->set_parent(successor);
+            successor->set_red(node->is_red());
+            path[depth] = successor;
+            parent_depth = successor_depth - 1;
+        }
+        node->~Node();
+        pool->release(node);
+        count--;
+        //every node above the position that lost a node has one less beneath it - the rotations of the fixup
+        //below only refresh the nodes they move
+        for(int level = parent_depth; level >= 0; level--)
+        {
+            Policy::augment::update(path[level]);
+        }
+        if(!removed_red)
+        {
+            erase_fixup(path, parent_depth, child, child_left);
+        }
+    }
+
+    //child is one black short on its side of path[depth]
+    void erase_fixup(Node** path, int depth, Node* child, bool child_left)
+    {
+        while(depth >= 0 && !is_red(child))
+        {
+            Node* parent = path[depth];
+            Node* above = (depth > 0) ? path[depth - 1] : nullptr;
+            Node* sibling = child_left ? parent->right() : parent->left();
+            if(sibling->is_red())
+            {
+                //turn a red sibling black by rotating it above the parent, which goes one level down the path
+                sibling->set_red(false);
+                parent->set_red(true);
+                child_left ? rotate_left(parent, above) : rotate_right(parent, above);
+                path[depth] = sibling;
+                path[depth + 1] = parent;
+                above = sibling;
+                depth++;
+                sibling = child_left ? parent->right() : parent->left();
+            }
+            Node* near_nephew = child_left ? sibling->left() : sibling->right();
+            Node* far_nephew = child_left ? sibling->right() : sibling->left();
+            if(!is_red(near_nephew) && !is_red(far_nephew))
+            {
+                sibling->set_red(true);
+                child = parent;
+                depth--;
+                child_left = (depth >= 0 && path[depth]->left() == child);
+                continue;
+            }
+            if(!is_red(far_nephew))
+            {
+                near_nephew->set_red(false);
+                sibling->set_red(true);
+                sibling = child_left ? rotate_right(sibling, parent) : rotate_left(sibling, parent);
+                far_nephew = child_left ? sibling->right() : sibling->left();
+            }
+            sibling->set_red(parent->is_red());
+            parent->set_red(false);
+            far_nephew->set_red(false);
+            child_left ? rotate_left(parent, above) : rotate_right(parent, above);
+            child = root;
+            break;
+        }
+        if(child != nullptr)
+        {
+            child->set_red(false);
+        }
+    }
+};
+
+
+#endif
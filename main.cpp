@@ -3,27 +3,84 @@
 #include <vector>
 #include <sstream>
 #include <string>
+#include <cstdio>
 #include "red_black_tree.h"
+#include "security_index.h"
+#include "state_journal.h"
+#include "security_catalog.h"
+#include "state_image.h"
+#include "delta_load.h"
 #include "supporting_func_structs.h"
 
 using namespace std;
 
 
-int main()
+int main(int argc, char* argv[])
 {
 
     cout << endl << "Welcome to my Security Pledging Program!" << endl;
 
-    //declare variable to hold the tree object
-    RBT tree_root;
+    //the structure holding the securities can be chosen when starting the program (./main bplus)
+    //the red-black tree is used by default
+    string backend = (argc > 1) ? argv[1] : "rbt";
+    //the order underpledged customers are pledged to can follow (./main rbt largest) - pledge code order by default
+    Pledge_Order pledge_order = PLEDGE_ORDER_CODE;
+    if(argc > 2 && !Deficit_Queue::order_from_name(argv[2], pledge_order))
+    {
+        cout << endl << "Unknown pledge order \"" << argv[2] << "\" - use code, largest or smallest" << endl << endl;
+        return 1;
+    }
+    Security_Index* security_index = create_security_index(backend);
+    if(security_index == nullptr)
+    {
+        cout << endl << "Unknown security index \"" << backend << "\" - use rbt or bplus" << endl << endl;
+        return 1;
+    }
+    //every lot held (free or pledged) indexed on ticket, CUSIP, maturity and group - rebuilt when a file is loaded
+    //and kept in sync by the journal through each pledging run
+    Security_Catalog catalog;
+
+    //declare variable to hold the tree object - every change goes through the journal in front of it, so the
+    //state as loaded can be restored before each pledging run without keeping a copy of it
+    State_Journal tree_root(*security_index, &catalog);
+    size_t loaded_state = tree_root.snapshot();
 
-    //declare new map object to hold customer data and a copy variable to hold original customer data
-    map<int, Customer_Node*> customers, customers_copy;
+    //customer store holding the customer data - passed by reference to every function, never copied
+    Customer_Store customers;
+    customers.set_pledge_order(pledge_order);
 
     //using vectors to store changes - all nodes have to be accessed when exporting
-    vector<RBT_Security_Node*> pledge_removals, pledge_removals_copy;
+    vector<RBT_Security_Node*> pledge_removals;
     vector<RBT_Security_Node*> pledge_additions;
 
+    //the csv files the loaded state came from - the state is saved to an image after each security import, and
+    //the image is restored at startup as long as both files are unchanged. Otherwise they are imported as usual.
+    string customer_source;
+    string security_source;
+    {
+        State_Image saved_state;
+        if(saved_state.open(STATE_IMAGE_FILE))
+        {
+            if(saved_state.sources_match())
+            {
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                saved_state.restore(tree_root, customers, pledge_removals);
+                catalog.rebuild(tree_root, customers);
+                tree_root.commit();
+                loaded_state = tree_root.snapshot();
+                customer_source = saved_state.customer_source();
+                security_source = saved_state.security_source();
+                cout << endl << "Restored " << customers.size() << " Customers and " << saved_state.security_count()
+                     << " Securities from " << STATE_IMAGE_FILE << " in " << fixed << setprecision(2)
+                     << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms" << endl;
+            }
+            else
+            {
+                cout << endl << "Saved state " << STATE_IMAGE_FILE << " is out of date - import the customer and security files" << endl;
+            }
+        }
+    }
+
     
     do
     {
@@ -40,78 +97,77 @@ int main()
         "8. Display Changes Made\n\n"
         "------ Utility Functions ------\n\n"
         "9. Print Tree\n"
-        "10. Test Tree - Tests Red-Black Tree Invariants\n\n";
+        "10. Test Tree - Tests Red-Black Tree Invariants\n"
+        "11. Apply Delta File - Changed Customer or Security Rows\n\n";
 
         cout << "Please Select an Option from the List Above or 'Q' to Quit: ";
 
         int selection = interface_validate();
-        ifstream customer_file;
-        ifstream security_file;
+        Mapped_File customer_file;
+        Mapped_File security_file;
 
         if(selection == 1)
         {
             cout << endl << "Import Customer File Selected" << endl << endl;
-            // If the file is reloaded, clear out the data previously in the map
+            // If the file is reloaded, clear out the data previously in the store
             if(customers.size() > 0)
             {
+                //securities pledged by the last run go back to the tree before the customers holding them are freed
+                tree_root.rollback(loaded_state);
+                tree_root.commit();
                 clear_customers(customers);
-                clear_customers(customers_copy);
             }
-            open_file(customer_file);
+            customer_source = open_file(customer_file);
             customers = load_customer_data(customer_file);
+            catalog.rebuild(tree_root, customers);
+            //the saved image no longer matches the state - it is removed so it can't be restored at the next startup,
+            //and saved again once the securities are imported against these customers
+            remove(STATE_IMAGE_FILE);
             cout << endl << "Customer Balances Successfully Loaded!" << endl;
         }
         else if(selection == 2)
         {
             cout << endl << "Import Security File Selected" << endl << endl;
-            //if loading a second file to 'overwite' the old one, this deletes
+            //if loading a second file to 'overwite' the old one, this releases
             //the tree already entered. All previous addiitons / removals and 
-            //customer pledges are cleared. 
-            if(tree_root.get_root() != nullptr || pledge_additions.size() > 0)
+            //customer pledges are cleared in one reset of the security node pool. 
+            if(tree_root.security_count() > 0 || pledge_additions.size() > 0)
             {
-                clear_pledges(tree_root, customers, pledge_removals, false);
-                clear_changes(pledge_removals, pledge_additions);
-                clear_vector(pledge_removals_copy);
-                tree_root.RBT_delete_tree(tree_root.get_root());
-                tree_root.set_root(nullptr);
+                release_all_securities(tree_root, customers, pledge_removals, pledge_additions);
             }
-            open_file(security_file);
-            tree_root = import_and_build_RBT_tree(customers, pledge_removals, security_file);
+            security_source = open_file(security_file);
+            import_and_build_security_index(customers, pledge_removals, security_file, tree_root);
             cout << endl << "Securities Successfully Loaded!" << endl;
-            //make a copy of the original customer map for restoration purposes 
             //customers with net coverage over 50% of the balance has all securities unpledged and placed into the tree
             test_overage(customers, pledge_removals, tree_root);
-            copy_customer_map(customers, customers_copy, tree_root);
-            pledge_removals_copy = copy_removals(pledge_removals, tree_root);
+            catalog.rebuild(tree_root, customers);
+            //the loaded state is what each pledging run starts from - snapshot it for restoration purposes
+            tree_root.commit();
+            loaded_state = tree_root.snapshot();
+            //the loaded state is saved so the next session can start from it without importing the files again
+            if(customer_source != "" && security_source != ""
+               && State_Image::save(STATE_IMAGE_FILE, customer_source, security_source, tree_root, customers, pledge_removals))
+            {
+                cout << "Loaded State Saved to " << STATE_IMAGE_FILE << endl;
+            }
             //at this point, the customer balances have any securities affilitated with them attached less the securities causing too much excess. 
             //the removal list now consists of the securities added while being inputted and the over excess securities
         }
         else if(selection == 3)
         {   
             cout << endl << "Perform Security Updates Selected" << endl << endl;
-            //test if there are already additions added, if so, additions and removals are cleared/reset prior to update
-            if(pledge_additions.size() > 0)
-            {
-                
-                restore_tree(pledge_additions, tree_root);
-                clear_changes(pledge_removals, pledge_additions);
-                pledge_removals = copy_removals(pledge_removals_copy, tree_root);
-            }
-            //restore customers to its original state
-            copy_customer_map(customers_copy, customers, tree_root); 
-            //need restore any pledges added to additions in 4 below
-            remove_additions(customers, tree_root);
+            //undo any previous run - the customers, tree, additions and removals go back to their loaded state
+            tree_root.rollback(loaded_state);
             bool update_status = update_customers(customers, tree_root, pledge_additions);
             if(!update_status)
             {   //if updates failed, it automatically tries to clear all and repledge securities (redistribution of securities)
                 cout << "Update Failed - Attempting Clear All Securities and Repledge.." << endl << endl; 
-                //replaces the securities within additions back into the tree
-                restore_tree(pledge_additions, tree_root);
-                clear_changes(pledge_removals, pledge_additions);
-                pledge_removals = copy_removals(pledge_removals_copy, tree_root);
-                //reload customer balance to 'reset' the securities pledged to each customer - puts it back in it's original state - this should avoid duplicate removals
-                copy_customer_map(customers_copy, customers, tree_root); //restore customers to  its original state
-                update_status = clear_all_and_repledge(tree_root, customers, pledge_additions, pledge_removals);
+                //undo the failed update to put everything back in its original state - this should avoid duplicate removals
+                tree_root.rollback(loaded_state);
+                Allocation_Report allocation;
+                update_status = clear_all_and_repledge(tree_root, customers, pledge_additions, pledge_removals, allocation);
+                display_allocation_report(allocation);
+                cout << endl;
             }
             if(!update_status)
             {
@@ -123,16 +179,14 @@ int main()
             }
         }
         else if(selection == 4)
-        {  //test if there are already additions added, if so, additions and removals are cleared/reset prior to update
+        {
             cout << endl << "Clear All Securities and Repledge Selected" << endl << endl;
-            if(pledge_additions.size() > 0)
-            {
-                restore_tree(pledge_additions, tree_root);
-                clear_changes(pledge_removals, pledge_additions);
-                pledge_removals = copy_removals(pledge_removals_copy, tree_root);
-            }
-            copy_customer_map(customers_copy, customers, tree_root); //restore customers to  its original state
-            bool repledge_status = clear_all_and_repledge(tree_root, customers, pledge_additions, pledge_removals);
+            //undo any previous run - the customers, tree, additions and removals go back to their loaded state
+            tree_root.rollback(loaded_state);
+            Allocation_Report allocation;
+            bool repledge_status = clear_all_and_repledge(tree_root, customers, pledge_additions, pledge_removals, allocation);
+            display_allocation_report(allocation);
+            cout << endl;
             if(!repledge_status)
             {
                 cout << "Insufficient Securities Available!" << endl;
@@ -171,18 +225,63 @@ int main()
         {
             cout << endl << "Print Tree Selected" << endl << endl;
             cout << endl;
-            tree_root.print_RBT_tree(tree_root.get_root());
+            tree_root.print_index();
             cout << endl;
         }
         else if(selection == 10)
         {
             cout << endl << "Test Tree Selected" << endl << endl;
-            tree_root.run_RBT_tests(tree_root.get_root());
-            cout << "Securities in Tree: " << tree_root.count_nodes(tree_root.get_root()) << endl << endl;
-            cout << "Tree Market Value Sum:  " << fixed << setprecision(2) << tree_root.sum_nodes(tree_root.get_root()) << endl;
+            cout << "Security Index: " << tree_root.backend_name() << endl;
+            tree_root.run_tests();
+            cout << "Securities in Tree: " << tree_root.security_count() << endl << endl;
+            cout << "Tree Market Value Sum:  " << fixed << setprecision(2) << tree_root.market_value_total() << endl;
+            cout << "Security Records Live: " << RBT_Security_Node::pool().live_count()
+                 << "  Peak: " << RBT_Security_Node::pool().peak_count() << endl;
+            tree_root.print_node_usage();
+            cout << "Index Memory Footprint: " << tree_root.memory_footprint() << " bytes" << endl;
+            Catalog_Sync_Report catalog_report = catalog.in_sync(tree_root, customers);
+            cout << "Catalog Lots: " << catalog_report.lot_count << "  Undated: " << catalog_report.undated_lots
+                 << "  In Sync: " << (catalog_report.in_sync() ? "Passed" : "Failed") << endl;
+            cout << "Catalog Lookups Checked: " << catalog_report.lookups_checked
+                 << "  Ticket: " << (catalog_report.ticket_lookup ? "Passed" : "Failed")
+                 << "  CUSIP: " << (catalog_report.cusip_lookup ? "Passed" : "Failed")
+                 << "  Maturity: " << (catalog_report.maturity_lookup ? "Passed" : "Failed")
+                 << "  Group: " << (catalog_report.group_lookup ? "Passed" : "Failed") << endl;
+            //the customer totals are running totals - every customer is summed again to check them
+            int mismatched = audit_customer_totals(customers);
+            cout << "Customer Totals Audited: " << customers.size() << "  Mismatched: " << mismatched << "  Audit: "
+                 << (mismatched == 0 ? "Passed" : "Failed") << endl;
+            cout << "Deficit Queue: " << Deficit_Queue::order_name(customers.pledge_order()) << " Order  Underpledged: "
+                 << customers.underpledged_count() << "  Deficit: " << customers.deficit_total() << "  In Sync: "
+                 << (customers.queue_in_sync() ? "Passed" : "Failed") << endl;
+        }
+        else if(selection == 11)
+        {
+            cout << endl << "Apply Delta File Selected" << endl << endl;
+            Mapped_File delta_file;
+            if(open_file(delta_file) != "")
+            {
+                //the changes are made to the state as loaded - any pledging run is undone first, as when a file is loaded
+                tree_root.rollback(loaded_state);
+                Delta_Summary summary = apply_delta_file(delta_file, customers, tree_root, catalog, pledge_removals);
+                //the changed state becomes the loaded state each pledging run starts from
+                tree_root.commit();
+                loaded_state = tree_root.snapshot();
+                cout << endl;
+                display_delta_summary(summary);
+                if(customer_source != "" && security_source != ""
+                   && State_Image::save(STATE_IMAGE_FILE, customer_source, security_source, tree_root, customers, pledge_removals))
+                {
+                    cout << "Loaded State Saved to " << STATE_IMAGE_FILE << endl;
+                }
+            }
         }
     } while(!cin.fail());
 
+    //free everything still held - the change vectors and customer store own their security records
+    clear_changes(pledge_removals, pledge_additions);
+    clear_customers(customers);
+    delete security_index;
     cout << endl << endl << "Goodbye!" << endl << endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cmath>
+#include <climits>
+#include <stdexcept>
+#include <cctype>
+
+
+using namespace std;
+
+
+/* -------------------------------------------------------Money Class-----------------------------------------------------------*/
+
+/*
+    An amount of money held as a whole number of cents in a 64 bit integer. Balances, market values and their totals
+    are all Money, so sums are exact and comparing two amounts is an integer compare - a customer covered to the cent
+    compares equal to its balance. Amounts are read from the csv files as written (see from_string), never through a
+    double. Conversions to double are only made for percentages and other display math.
+*/
+class Money
+{
+public:
+
+    constexpr Money() : cents(0) {}
+
+    static constexpr Money from_cents(int64_t cents)
+    {
+        return Money(cents);
+    }
+
+    //rounds to the nearest cent, halves away from zero
+    static Money from_double(double amount)
+    {
+        return Money(llround(amount * 100));
+    }
+
+    /*
+        Function reads an amount written in decimal ("2400752", "-81.3", "0.125") into Money. Digits past the
+        cents are rounded, halves away from zero. Surrounding spaces and a trailing carriage return are allowed.
+        Throws invalid_argument, as stod does, if the text is not an amount.
+    */
+    static Money from_string(string_view text)
+    {
+        size_t position = 0;
+        while(position < text.size() && (text[position] == ' ' || text[position] == '\t'))
+        {
+            position++;
+        }
+        bool negative = false;
+        if(position < text.size() && (text[position] == '-' || text[position] == '+'))
+        {
+            negative = text[position] == '-';
+            position++;
+        }
+        int64_t whole = 0;
+        int digits = 0;
+        while(position < text.size() && isdigit(static_cast<unsigned char>(text[position])))
+        {
+            whole = whole * 10 + (text[position] - '0');
+            position++;
+            digits++;
+        }
+        int64_t fraction = 0;
+        if(position < text.size() && text[position] == '.')
+        {
+            position++;
+            int fraction_digits = 0;
+            while(position < text.size() && isdigit(static_cast<unsigned char>(text[position])))
+            {
+                if(fraction_digits < 2)
+                {
+                    fraction = fraction * 10 + (text[position] - '0');
+                }
+                else if(fraction_digits == 2 && text[position] >= '5')
+                {
+                    fraction++;
+                }
+                fraction_digits++;
+                digits++;
+                position++;
+            }
+            if(fraction_digits == 1)
+            {
+                fraction *= 10;
+            }
+        }
+        while(position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\r'))
+        {
+            position++;
+        }
+        if(digits == 0 || position != text.size())
+        {
+            throw invalid_argument("Money::from_string: \"" + string(text) + "\" is not an amount");
+        }
+        int64_t cents = whole * 100 + fraction;
+        return Money(negative ? -cents : cents);
+    }
+
+    //largest amount that can be held - used as an open upper bound on a search
+    static constexpr Money max()
+    {
+        return Money(INT64_MAX);
+    }
+
+    constexpr int64_t in_cents() const
+    {
+        return cents;
+    }
+
+    constexpr double to_double() const
+    {
+        return cents / 100.0;
+    }
+
+    /*
+        Function returns the amount multiplied by a factor (such as 1 + a threshold), rounded to the nearest cent.
+        Amounts that would overflow are held at max().
+    */
+    Money scaled(double factor) const
+    {
+        double scaled_cents = cents * factor;
+        if(scaled_cents >= static_cast<double>(INT64_MAX))
+        {
+            return max();
+        }
+        return Money(llround(scaled_cents));
+    }
+
+    /*--------------------------------------------------- Money Operators ------------------------------------------------------*/
+
+    constexpr Money operator+(Money other) const { return Money(cents + other.cents); }
+    constexpr Money operator-(Money other) const { return Money(cents - other.cents); }
+    constexpr Money operator-() const { return Money(-cents); }
+    Money& operator+=(Money other) { cents += other.cents; return *this; }
+    Money& operator-=(Money other) { cents -= other.cents; return *this; }
+
+    constexpr bool operator==(Money other) const { return cents == other.cents; }
+    constexpr bool operator!=(Money other) const { return cents != other.cents; }
+    constexpr bool operator<(Money other) const { return cents < other.cents; }
+    constexpr bool operator<=(Money other) const { return cents <= other.cents; }
+    constexpr bool operator>(Money other) const { return cents > other.cents; }
+    constexpr bool operator>=(Money other) const { return cents >= other.cents; }
+
+    //written as dollars and cents ("-1234.05"), the stream's width and alignment apply to the whole amount
+    friend ostream& operator<<(ostream& out, Money amount)
+    {
+        uint64_t magnitude = (amount.cents < 0) ? -static_cast<uint64_t>(amount.cents) : amount.cents;
+        string remainder = to_string(magnitude % 100);
+        string text = (amount.cents < 0 ? "-" : "") + to_string(magnitude / 100) + "." + (remainder.size() == 1 ? "0" : "") + remainder;
+        return out << text;
+    }
+
+private:
+
+    int64_t cents;
+
+    constexpr explicit Money(int64_t cents) : cents(cents) {}
+};
+
+
+#endif
@@ -0,0 +1,244 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <type_traits>
+#include <algorithm>
+
+
+using namespace std;
+#define POOL_SLAB_SIZE 4096 //number of nodes carved out of each slab
+
+
+/* -------------------------------------------------Slab Node Pool Class--------------------------------------------------------*/
+
+/*
+    Fixed size node allocator. Memory is requested from the system in slabs of POOL_SLAB_SIZE
+    nodes and handed out one node at a time. Released nodes are kept on a free list and reused
+    before any new slab memory is touched. Slabs are never returned to the system until the pool
+    itself is destroyed, so a reset only rewinds the pool and the slabs are reused by the next load.
+*/
+template <typename T>
+class Node_Pool
+{
+public:
+
+    //Pool Constructor
+    Node_Pool();
+
+    //Pool Deconstructor - releases every slab back to the system
+    ~Node_Pool();
+
+    //pools hand out raw addresses into their slabs, copying one would double free the slabs
+    Node_Pool(const Node_Pool&) = delete;
+    Node_Pool& operator=(const Node_Pool&) = delete;
+
+    /*
+        Function returns uninitialized memory for a single node. The free list is used first,
+        then the unused portion of the current slab, and a new slab is only allocated once
+        all slabs are full.
+    */
+    void* allocate();
+
+    /*
+        Function returns the memory of a single node to the free list. The node's destructor
+        must already have been run by the caller (operator delete does this).
+    */
+    void release(void* node);
+
+    /*
+        Functions allocate and release a node of the size passed in, for a node type's operator new and delete.
+        Only a node of exactly sizeof(T) uses a slot of the pool - any other size (a type derived from the node)
+        is allocated on its own, with the node's alignment, rather than being given a slot too small for it.
+    */
+    void* allocate(size_t size);
+
+    void release(void* node, size_t size);
+
+    /*
+        Function releases every node handed out by the pool at once. Any node still referenced
+        anywhere in the program is invalid after this call. When the node type has nothing to
+        destroy the reset is O(1), otherwise each live node still has its destructor run, but no
+        memory is returned to the system node by node.
+    */
+    void reset();
+
+    //number of nodes currently handed out by the pool
+    size_t live_count() const;
+
+    //largest number of nodes handed out at the same time since the pool was created
+    size_t peak_count() const;
+
+    //number of slabs requested from the system
+    size_t slab_count() const;
+
+private:
+
+    //a slot either holds a node or, while on the free list, the next free slot
+    union Slot
+    {
+        Slot* next_free;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    vector<Slot*> slabs;
+
+    //index of the slab currently being carved and how many of its slots have been handed out
+    size_t current_slab = 0;
+    size_t current_used = 0;
+
+    Slot* free_list = nullptr;
+
+    size_t live_nodes = 0;
+    size_t peak_nodes = 0;
+
+    void destroy_live_nodes();
+};
+
+
+/*---------------------------------------------- Slab Node Pool Functions -----------------------------------------------------*/
+
+template <typename T>
+Node_Pool<T>::Node_Pool(){}
+
+template <typename T>
+Node_Pool<T>::~Node_Pool()
+{
+    reset();
+    for(size_t i = 0; i < slabs.size(); i++)
+    {
+        ::operator delete(slabs.at(i), align_val_t(alignof(Slot)));
+    }
+}
+
+template <typename T>
+void* Node_Pool<T>::allocate()
+{
+    Slot* slot;
+    if(free_list != nullptr)
+    {
+        slot = free_list;
+        free_list = free_list->next_free;
+    }
+    else
+    {
+        //current slab is used up (or there are no slabs yet) - move to the next retained slab or request a new one
+        if(slabs.empty() || current_used == POOL_SLAB_SIZE)
+        {
+            if(!slabs.empty())
+            {
+                current_slab++;
+            }
+            if(current_slab == slabs.size())
+            {
+                //slabs honour the node's alignment, so cache line aligned nodes stay on line boundaries
+                slabs.push_back(static_cast<Slot*>(::operator new(sizeof(Slot) * POOL_SLAB_SIZE, align_val_t(alignof(Slot)))));
+            }
+            current_used = 0;
+        }
+        slot = &slabs.at(current_slab)[current_used];
+        current_used++;
+    }
+    live_nodes++;
+    if(live_nodes > peak_nodes)
+    {
+        peak_nodes = live_nodes;
+    }
+    return slot;
+}
+
+template <typename T>
+void Node_Pool<T>::release(void* node)
+{
+    if(node == nullptr)
+    {
+        return;
+    }
+    Slot* slot = static_cast<Slot*>(node);
+    slot->next_free = free_list;
+    free_list = slot;
+    live_nodes--;
+}
+
+template <typename T>
+void* Node_Pool<T>::allocate(size_t size)
+{
+    if(size != sizeof(T))
+    {
+        return ::operator new(size, align_val_t(alignof(T)));
+    }
+    return allocate();
+}
+
+template <typename T>
+void Node_Pool<T>::release(void* node, size_t size)
+{
+    if(size != sizeof(T))
+    {
+        ::operator delete(node, align_val_t(alignof(T)));
+        return;
+    }
+    release(node);
+}
+
+template <typename T>
+void Node_Pool<T>::reset()
+{
+    if(!is_trivially_destructible<T>::value && live_nodes > 0)
+    {
+        destroy_live_nodes();
+    }
+    current_slab = 0;
+    current_used = 0;
+    free_list = nullptr;
+    live_nodes = 0;
+}
+
+template <typename T>
+size_t Node_Pool<T>::live_count() const
+{
+    return live_nodes;
+}
+
+template <typename T>
+size_t Node_Pool<T>::peak_count() const
+{
+    return peak_nodes;
+}
+
+template <typename T>
+size_t Node_Pool<T>::slab_count() const
+{
+    return slabs.size();
+}
+
+template <typename T>
+void Node_Pool<T>::destroy_live_nodes()
+{
+    //every carved slot that is not sitting on the free list still holds a constructed node
+    vector<Slot*> free_slots;
+    for(Slot* slot = free_list; slot != nullptr; slot = slot->next_free)
+    {
+        free_slots.push_back(slot);
+    }
+    sort(free_slots.begin(), free_slots.end(), less<Slot*>());
+
+    for(size_t i = 0; i < slabs.size() && i <= current_slab; i++)
+    {
+        //only the current slab is partially carved, every slab before it is full
+        size_t carved = (i == current_slab) ? current_used : POOL_SLAB_SIZE;
+        for(size_t j = 0; j < carved; j++)
+        {
+            Slot* slot = &slabs.at(i)[j];
+            if(!binary_search(free_slots.begin(), free_slots.end(), slot, less<Slot*>()))
+            {
+                reinterpret_cast<T*>(slot->storage)->~T();
+            }
+        }
+    }
+}
+
+
+#endif
@@ -1,87 +1,325 @@
 #include "red_black_tree.h"
+#include "csv_reader.h"
 
 
 
+/*------------------------------------------- Security and Tree Node Pool Allocation ------------------------------------------*/
 
-RBT::RBT()
+void* RBT_Security_Node::operator new(size_t size)
 {
-    root = new RBT_Security_Node*;
-    *root = nullptr;
+    return pool().allocate(size);
 }
 
-RBT::~RBT(){}
+void RBT_Security_Node::operator delete(void* node, size_t size)
+{
+    pool().release(node, size);
+}
+
+Node_Pool<RBT_Security_Node>& RBT_Security_Node::pool()
+{
+    //constructed on first use so the pool exists before any node is built
+    static Node_Pool<RBT_Security_Node> security_pool;
+    return security_pool;
+}
+
+size_t RBT_Security_Node::footprint() const
+{
+    //short strings sit inside the record itself, only longer ones own a separate buffer
+    const size_t inline_capacity = string().capacity();
+    const string* fields[] = {&portfolio, &cusip, &maturity, &pledge_description, &group, &security_description, &change_status};
+    size_t bytes = sizeof(RBT_Security_Node);
+    for(const string* field : fields)
+    {
+        if(field->capacity() > inline_capacity)
+        {
+            bytes += field->capacity() + 1;
+        }
+    }
+    return bytes;
+}
+
+RBT::RBT(){}
+
+RBT::~RBT()
+{
+    clear();
+}
+
+RBT::RBT(RBT&& other) noexcept
+    : nodes(move(other.nodes)), minimum_node(other.minimum_node), maximum_node(other.maximum_node)
+{
+    //the nodes change hands along with their pool without being touched, the moved from tree is left empty
+    other.minimum_node = nullptr;
+    other.maximum_node = nullptr;
+}
+
+RBT& RBT::operator=(RBT&& other) noexcept
+{
+    if(this != &other)
+    {
+        clear();
+        nodes = move(other.nodes);
+        minimum_node = other.minimum_node;
+        maximum_node = other.maximum_node;
+        other.minimum_node = nullptr;
+        other.maximum_node = nullptr;
+    }
+    return *this;
+}
 
 /*------------------------------------ Red Black Tree Public Insert and Remove Functions ---------------------------------------*/
 
-void RBT::RBT_add_node(RBT_Security_Node* node)
+RBT_Node* RBT::RBT_add_node(RBT_Security_Node* security)
 {
-    RBT_insert(node);
-    node->node_color = "red";
-    RBT_Balance(node);
+    //the tree node only carries the search key, the descriptive data stays in the security record
+    RBT_Node* node = nodes.insert({security->market_value, security->ticket}, security);
+    //an equal key is inserted after the nodes it matches, so it only becomes the minimum when strictly smaller
+    RBT_Key_Less key_less;
+    if(minimum_node == nullptr || key_less(node->key, minimum_node->key))
+    {
+        minimum_node = node;
+    }
+    if(maximum_node == nullptr || !key_less(node->key, maximum_node->key))
+    {
+        maximum_node = node;
+    }
+    return node;
 }
 
-void RBT::RBT_remove_node(RBT_Security_Node* node)
+RBT_Security_Node* RBT::RBT_remove_node(RBT_Node* node)
 {
-    if(node->left_child != nullptr && node->right_child != nullptr)
+    RBT_Security_Node* record = node->value;
+    //removal keeps the order of the remaining nodes, so the neighbors found now are the new extremes
+    if(node == minimum_node)
+    {
+        minimum_node = RBT_Node_Tree::next(node);
+    }
+    if(node == maximum_node)
     {
-        RBT_Security_Node* predecessor_node = RBT_get_predecessor(node);
-        RBT_Security_Node* temp_node = RBT_copy_node(predecessor_node);
-        //need to create a new / temporary node to hold the the data 
-        //copy node here - maybe create helper function for this
-        //bst removal algorithm in book uses key to find node to remove, could just use the node itself since we may have duplicates?\
-        // first one it finds would be the same one it found in the original search so shouldn't matter
-        RBT_remove_node(predecessor_node);
-        extract_node_data(node, temp_node);  // copy node data back
-        delete temp_node; //free up temp node memory once all data extracted
+        maximum_node = RBT_Node_Tree::previous(node);
+    }
+    //the generic tree relinks the node's successor into its place rather than copying the successor's data
+    //over - no node changes which security it holds during a removal
+    nodes.erase(node);
+    return record;
+}
+
+
+void RBT::RBT_bulk_add(const vector<RBT_Security_Node*>& securities)
+{
+    if(securities.empty())
+    {
+        return;
+    }
+    size_t tree_size = nodes.size();
+    size_t total = tree_size + securities.size();
+    //inserting k securities costs about k * log(N) while a rebuild touches all N nodes
+    //a handful of securities going back into a large tree is cheaper to insert one at a time
+    if(tree_size > 0 && securities.size() * log2(total) < total)
+    {
+        for(size_t i = 0; i < securities.size(); i++)
+        {
+            RBT_add_node(securities.at(i));
+        }
         return;
     }
-    if(node->node_color == "black")
+
+    vector<RBT_Sort_Key> new_keys;
+    new_keys.reserve(securities.size());
+    for(size_t i = 0; i < securities.size(); i++)
+    {
+        RBT_Node* node = nodes.make_node({securities.at(i)->market_value, securities.at(i)->ticket}, securities.at(i));
+        new_keys.push_back({node->key.market_value, node->key.ticket, node});
+    }
+    RBT_sort_keys(new_keys);
+
+    //the nodes already in the tree come out of an in-order walk sorted, so they only need to be merged in
+    vector<RBT_Sort_Key> existing_keys;
+    existing_keys.reserve(tree_size);
+    RBT_collect_in_order(existing_keys);
+    vector<RBT_Sort_Key> all_keys(total);
+    merge(existing_keys.begin(), existing_keys.end(), new_keys.begin(), new_keys.end(), all_keys.begin(), RBT_sort_key_less);
+
+    //the generic tree links the sorted nodes bottom-up, with the last level the only one colored red
+    vector<RBT_Node*> sorted_nodes(total);
+    for(size_t i = 0; i < total; i++)
     {
-        RBT_prepare_for_removal(node);
+        sorted_nodes.at(i) = all_keys.at(i).node;
     }
-    //add to customer node here call copy node and store the new node in the customer this way we only need to code once
-    //this is the node we want to copy over
-    RBT_BST_Remove(node);
+    nodes.link_sorted(sorted_nodes);
+    minimum_node = all_keys.front().node;
+    maximum_node = all_keys.back().node;
+}
+
+RBT_Node* RBT::find(int ticket, Money market_value)
+{
+    return nodes.find({market_value, ticket});
+}
+
+RBT_Security_Node* RBT::erase(int ticket, Money market_value)
+{
+    RBT_Node* node = find(ticket, market_value);
+    if(node == nullptr)
+    {
+        return nullptr;
+    }
+    return RBT_remove_node(node);
+}
+
+RBT_Node* RBT::find_record(RBT_Security_Node* security)
+{
+    //start at the first node whose key is not less than the record's key
+    RBT_Node* candidate = nodes.lower_bound({security->market_value, security->ticket});
+    while(candidate != nullptr && candidate->key.market_value == security->market_value && candidate->key.ticket == security->ticket)
+    {
+        if(candidate->value == security)
+        {
+            return candidate;
+        }
+        candidate = RBT_Node_Tree::next(candidate);
+    }
+    return nullptr;
+}
+
+RBT::iterator RBT::erase(iterator position, RBT_Security_Node*& security)
+{
+    iterator next = position;
+    ++next;
+    security = RBT_remove_node(position.current);
+    return next;
+}
+
+RBT::iterator RBT::erase(iterator position)
+{
+    RBT_Security_Node* security;
+    iterator next = erase(position, security);
+    delete security;
+    return next;
+}
+
+
+/*------------------------------------------ Red Black Tree Public Iterator Functions ------------------------------------------*/
+
+RBT::iterator::iterator(RBT_Node* node, const RBT* tree) : current(node), owner(tree) {}
+
+RBT_Node& RBT::iterator::operator*() const
+{
+    return *current;
+}
+
+RBT_Node* RBT::iterator::operator->() const
+{
+    return current;
+}
+
+RBT::iterator& RBT::iterator::operator++()
+{
+    current = RBT_Node_Tree::next(current);
+    return *this;
+}
+
+RBT::iterator RBT::iterator::operator++(int)
+{
+    iterator before = *this;
+    ++(*this);
+    return before;
+}
+
+RBT::iterator& RBT::iterator::operator--()
+{
+    //stepping back from end() lands on the largest node
+    current = (current == nullptr) ? owner->maximum_node : RBT_Node_Tree::previous(current);
+    return *this;
+}
+
+RBT::iterator RBT::iterator::operator--(int)
+{
+    iterator before = *this;
+    --(*this);
+    return before;
+}
+
+bool RBT::iterator::operator==(const iterator& other) const
+{
+    return current == other.current;
+}
+
+bool RBT::iterator::operator!=(const iterator& other) const
+{
+    return current != other.current;
+}
+
+RBT::iterator RBT::begin() const
+{
+    return iterator(minimum_node, this);
+}
+
+RBT::iterator RBT::end() const
+{
+    return iterator(nullptr, this);
+}
+
+RBT::iterator RBT::lower_bound(Money market_value) const
+{
+    //no ticket is below INT_MIN, so this is the first node of the value or above it
+    return iterator(nodes.lower_bound({market_value, INT_MIN}), this);
+}
+
+RBT::iterator RBT::upper_bound(Money market_value) const
+{
+    //no ticket is above INT_MAX, so this is the first node above the value
+    return iterator(nodes.upper_bound({market_value, INT_MAX}), this);
+}
+
+RBT_Node* RBT::get_minimum() const
+{
+    return minimum_node;
+}
+
+RBT_Node* RBT::get_maximum() const
+{
+    return maximum_node;
 }
 
 
 /*------------------------------------------ Red Black Tree Public Utility Functions -------------------------------------------*/
 
-RBT_Security_Node* RBT::build_security_node(const vector<string>& security_data)
+RBT_Security_Node* RBT::build_security_node(const vector<string_view>& security_data)
 {
     //Security data per daily customer balance report
     RBT_Security_Node* next_security = new RBT_Security_Node;
     next_security->portfolio = security_data.at(0);
     next_security->cusip = security_data.at(1);
-    next_security->ticket = stoi(security_data.at(2));
+    next_security->ticket = field_to_int(security_data.at(2));
     next_security->maturity = security_data.at(3);
     if(security_data.at(4) != "")
     {
-        next_security->pledge_id = stoi(security_data.at(4));
+        next_security->pledge_id = field_to_int(security_data.at(4));
     }
     else
     {
         next_security->pledge_id = 0;
     }
     next_security->pledge_description = security_data.at(5);
-    next_security->pledge_amount = stod(security_data.at(6));
-    next_security->par_value = stod(security_data.at(7));
-    next_security->market_value = stod(security_data.at(8));
+    next_security->pledge_amount = Money::from_string(security_data.at(6));
+    next_security->par_value = Money::from_string(security_data.at(7));
+    next_security->market_value = Money::from_string(security_data.at(8));
     next_security->group = security_data.at(9);
     next_security->security_description = security_data.at(10);
 
     return next_security;
 }
 
-
-RBT_Security_Node* RBT::get_root()
+RBT_Security_Node* RBT::build_security_node(const vector<string>& security_data)
 {
-    return *root;
+    vector<string_view> fields(security_data.begin(), security_data.end());
+    return build_security_node(fields);
 }
 
-void RBT::set_root(RBT_Security_Node* node)
+
+RBT_Node* RBT::get_root()
 {
-    *root = node;
+    return nodes.root_node();
 }
 
 RBT_Security_Node* RBT::RBT_copy_node(RBT_Security_Node* node)
@@ -101,646 +339,524 @@ RBT_Security_Node* RBT::RBT_copy_node(RBT_Security_Node* node)
     return temp_node;
 }
 
-void RBT::RBT_delete_tree(RBT_Security_Node* root)
+void RBT::clear()
 {
-    //post order traversal
-    if(root == nullptr)
+    //the records are the tree's to delete, the nodes go back to the tree's pool together
+    nodes.for_each([](RBT_Node* node)
     {
-        return;
+        delete node->value;
+    });
+    release_nodes();
+}
+
+void RBT::release_nodes()
+{
+    nodes.clear();
+    minimum_node = nullptr;
+    maximum_node = nullptr;
+}
+
+const Node_Pool<RBT_Node>& RBT::node_pool() const
+{
+    return nodes.node_pool();
+}
+
+size_t RBT::memory_footprint()
+{
+    size_t bytes = sizeof(RBT);
+    for(iterator node = begin(); node != end(); ++node)
+    {
+        bytes += sizeof(RBT_Node) + node->value->footprint();
     }
-    RBT_delete_tree(root->left_child);
-    RBT_delete_tree(root->right_child);
-    delete root;
+    return bytes;
 }
 
-RBT_Security_Node* RBT::find_minimum(RBT_Security_Node* root)
+RBT_Node* RBT::find_minimum(RBT_Node* root)
 {
     if(root == nullptr)
     {
         return nullptr;
     }
-    while(root->left_child != nullptr)
+    while(root->left() != nullptr)
     {
-        root = root->left_child;
+        root = root->left();
     }
     return root;
 }
 
-RBT_Security_Node* RBT::find_maximum(RBT_Security_Node* root)
+RBT_Node* RBT::find_maximum(RBT_Node* root)
 {
     if(root == nullptr)
     {
         return nullptr;
     }
-    while(root->right_child != nullptr)
+    while(root->right() != nullptr)
     {
-        root = root->right_child;
+        root = root->right();
     }
     return root;
 }
 
 
-/*------------------------------------------ Red Black Tree Public Test Functions ----------------------------------------------*/
+/*------------------------------------------ Red Black Tree Public Range Functions ---------------------------------------------*/
 
-void RBT::run_RBT_tests(RBT_Security_Node* root)
+int RBT::range_count(Money min, Money max)
 {
-    if(test_invariants(root))
-    {
-        cout << endl << "Red-Black Tree Invariants Are Correct" << endl;
-    }
-    int node_count = count_nodes(root);
-    //compare the actual height of the tree to what it should be 
-    //log based 2 of number of nodes for mininimum height
-    //2 * log based 2 of number of nodes for maximum height
-    int log_height_min = floor(log2(node_count + 1));
-    int log_height_max = log_height_min * 2;
-    int calc_height = get_tree_height(root);
-    if(calc_height >= log_height_min && calc_height <= log_height_max)
-    {
-        cout << endl << "Red-Black Tree Height is within the Acceptable Range" << endl << endl;
-    }
-    else
-    {
-        cout << endl << "Red-Black Tree Height is Incorrect" << endl << endl;
-    }
+    int below_min, through_max;
+    Money unused_sum;
+    count_and_sum_below(min, false, below_min, unused_sum);
+    count_and_sum_below(max, true, through_max, unused_sum);
+    return through_max - below_min;
 }
 
-void RBT::print_RBT_tree(RBT_Security_Node* node, int empty_space)
+Money RBT::range_sum(Money min, Money max)
 {
-
-    if(node == nullptr)
-    {
-        return;
-    }
-
-    empty_space += TOTAL_SPACES;
-
-    //empty space variable increased each call to represent a tree in the terminal
-    print_RBT_tree(node->right_child, empty_space);
-    
-    string space = "";
-
-    for(int i = 0; i < empty_space; i++)
-    {
-        space += "    ";
-    }
-
-    cout << fixed << setprecision(2) <<  space << node->market_value << " " << node->node_color << endl;
-
-    print_RBT_tree(node->left_child, empty_space);
+    int unused_count;
+    Money below_min, through_max;
+    count_and_sum_below(min, false, unused_count, below_min);
+    count_and_sum_below(max, true, unused_count, through_max);
+    return through_max - below_min;
 }
 
-
-/*------------------------------------- Red Black Tree Private Insert and Remove Functions -------------------------------------*/
-
-void RBT::RBT_BST_Remove(RBT_Security_Node* node)
+RBT_Node* RBT::select_by_rank(int rank)
 {
-
-    if (*root == nullptr)
+    if(rank < 0 || rank >= count_nodes(nodes.root_node()))
     {
-        return;
+        return nullptr;
     }
-
-    //no child case
-    if (node->left_child == nullptr && node->right_child == nullptr)
+    RBT_Node* cursor = nodes.root_node();
+    while(cursor != nullptr)
     {
-        if (node->parent != nullptr && node->parent->left_child == node)
+        int left_size = count_nodes(cursor->left());
+        if(rank < left_size)
         {
-            node->parent->left_child = nullptr;
-            delete node;
-
+            cursor = cursor->left();
         }
-        else if (node->parent != nullptr && node->parent->right_child == node)
+        else if(rank == left_size)
         {
-            node->parent->right_child = nullptr;
-            delete node; 
+            return cursor;
         }
         else
         {
-            *root = nullptr;
-            delete node; // simply deletes node if parent is empty / cursor is root
+            rank -= left_size + 1;
+            cursor = cursor->right();
         }
     }
-    // two children case
-    else if (node->left_child != nullptr && node->right_child != nullptr)
-    {
-        RBT_Security_Node* successorNode = node->right_child;
+    return nullptr;
+}
 
-        while (successorNode->left_child != nullptr)
-        {
-            successorNode = successorNode->left_child;
-        }
-        
-        RBT_Security_Node* replacement = RBT_copy_node(successorNode); //temporarily store the replacement values until recursive function returns
+int RBT::rank_of_value(Money market_value)
+{
+    int count;
+    Money unused_sum;
+    count_and_sum_below(market_value, false, count, unused_sum);
+    return count;
+}
 
-        RBT_BST_Remove(successorNode);
 
-        extract_node_data(node, replacement);
+/*------------------------------------------ Red Black Tree Public Test Functions ----------------------------------------------*/
 
-        delete replacement;
+bool RBT_Validation_Report::invariants_hold() const
+{
+    return keys_ordered && no_red_red && root_black && black_height_equal && parent_links && subtree_totals && cached_extremes;
+}
 
+bool RBT_Validation_Report::valid() const
+{
+    return invariants_hold() && height_in_range;
+}
 
-    }
-    else if (node->right_child != nullptr)
-    {
-        bool color_swap = true;
-        if(node->parent == nullptr)
-        {
-            color_swap = false;
-        }
-        extract_node_data(node, node->right_child, color_swap); 
-        delete node->right_child; 
+RBT_Validation_Report RBT::validate() const
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    RBT_Validation_Report report;
 
-        node->right_child = nullptr;
-    }
-    else
+    //a large tree is cut at the depth where there are several subtrees for every thread, so a thread that
+    //draws a small subtree just takes another. The subtrees are checked first and the top of the tree after.
+    int frontier_depth = -1;
+    vector<RBT_Subtree_Check> frontier;
+    size_t workers = thread::hardware_concurrency();
+    RBT_Node* tree_root = nodes.root_node();
+    if(tree_root != nullptr && tree_root->subtree_size >= PARALLEL_VALIDATE_MIN && workers >= 2)
     {
-        bool color_swap = true;
-        if(node->parent == nullptr)
+        frontier_depth = 0;
+        while((size_t(1) << frontier_depth) < workers * 4)
         {
-            color_swap = false;
+            frontier_depth++;
         }
-        extract_node_data(node, node->left_child, color_swap);
-        delete node->left_child; 
-        node->left_child = nullptr;
-    }
-    return;
-}
-
-void RBT::RBT_insert(RBT_Security_Node* new_node)
-{
-    if(*root == nullptr)
-    {
-        *root = new_node;
-    }
-    else
-    {
-        RBT_Security_Node* cursor = *root; //start at the root each time
-        while(cursor != nullptr)
+        vector<RBT_Node*> subtrees;
+        RBT_collect_frontier(tree_root, frontier_depth, subtrees);
+        frontier.resize(subtrees.size());
+
+        //each thread reports into its own copy, the copies are combined once every thread is done
+        vector<RBT_Validation_Report> thread_reports(workers);
+        atomic<size_t> next_subtree(0);
+        vector<thread> checkers;
+        for(size_t worker = 0; worker < workers; worker++)
         {
-            if(new_node->market_value < cursor->market_value)
-            {
-                if(cursor->left_child == nullptr)
-                {
-                    cursor->left_child = new_node;
-                    new_node->parent = cursor;
-                    return;
-                }
-                else
-                {
-                    cursor = cursor->left_child;        
-                }
-            }
-            // securities of the same value go to the right
-            else
+            checkers.push_back(thread([&, worker]()
             {
-                if(cursor->right_child == nullptr)
-                {
-                    cursor->right_child = new_node;
-                    new_node->parent = cursor;
-                    return;
-                }
-                else
+                vector<RBT_Subtree_Check> no_frontier;
+                for(size_t i = next_subtree++; i < subtrees.size(); i = next_subtree++)
                 {
-                    cursor = cursor->right_child;
+                    frontier.at(i) = RBT_check_subtree(subtrees.at(i), -1, no_frontier, thread_reports.at(worker));
                 }
-            }
+            }));
         }
+        for(size_t i = 0; i < checkers.size(); i++)
+        {
+            checkers.at(i).join();
+        }
+        for(size_t i = 0; i < thread_reports.size(); i++)
+        {
+            const RBT_Validation_Report& part = thread_reports.at(i);
+            report.keys_ordered = report.keys_ordered && part.keys_ordered;
+            report.no_red_red = report.no_red_red && part.no_red_red;
+            report.black_height_equal = report.black_height_equal && part.black_height_equal;
+            report.parent_links = report.parent_links && part.parent_links;
+            report.subtree_totals = report.subtree_totals && part.subtree_totals;
+        }
+        report.threads_used = workers;
     }
-}
-
-
-/*--------------------------------- Red Black Tree Rebalancing Private Helper Functions ----------------------------------------*/
-
-void RBT::RBT_Balance(RBT_Security_Node* node)
-{
-    if(node->parent == nullptr)
-    {
-        node->node_color = "black";
-        return;
-    }
-    if(node->parent->node_color == "black")
-    {
-        return;
-    }
-
 
-    RBT_Security_Node* parent = node->parent;
-    RBT_Security_Node* grandparent = get_grandparent_node(node);
-    RBT_Security_Node* uncle = get_uncle_node(node);
-    if(uncle != nullptr && uncle->node_color == "red")
-    {
-        parent->node_color = "black";
-        uncle->node_color = "black";
-        grandparent->node_color = "red";
-        RBT_Balance(grandparent);
-        return;
-    }
-    if(node == parent->right_child && parent == grandparent->left_child)
-    {
-        RBT_rotate_left(parent);
-        node = parent;
-        parent = node->parent;
-    }
-    else if(node == parent->left_child && parent == grandparent->right_child)
-    {
-        RBT_rotate_right(parent);
-        node = parent;
-        parent = node->parent;
-    }
-    parent->node_color = "black";
-    grandparent->node_color = "red";
-    if(node == parent->left_child)
+    RBT_Subtree_Check whole = RBT_check_subtree(tree_root, frontier_depth, frontier, report);
+    report.node_count = whole.node_count;
+    report.height = whole.height;
+    report.black_height = whole.black_height;
+    if(tree_root != nullptr)
     {
-        RBT_rotate_right(grandparent);
+        report.root_black = !tree_root->is_red();
+        report.parent_links = report.parent_links && tree_root->parent() == nullptr;
     }
-    else
-    {
-        RBT_rotate_left(grandparent);
-    }
-}
+    report.cached_extremes = minimum_node == whole.leftmost && maximum_node == whole.rightmost;
+    //the shortest a tree of N nodes can be is log2(N + 1) levels, and a red-black tree is never more than twice that
+    int least_levels = ceil(log2(report.node_count + 1.0));
+    report.height_in_range = report.height >= least_levels && report.height <= 2 * log2(report.node_count + 1.0);
 
-RBT_Security_Node* RBT::get_grandparent_node(RBT_Security_Node* node)
-{
-    if(node->parent == nullptr)
-    {
-        return nullptr;
-    }
-    return node->parent->parent; 
+    report.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return report;
 }
 
-RBT_Security_Node* RBT::get_uncle_node(RBT_Security_Node* node)
+void RBT::run_RBT_tests()
 {
-    RBT_Security_Node* grandparent = nullptr;
-    if(node->parent != nullptr)
+    RBT_Validation_Report report = validate();
+    if(report.invariants_hold())
     {
-        grandparent = node->parent->parent;
-    }
-    if(grandparent == nullptr)
-    {
-        return nullptr; //if there is no grandparent, there can't be an uncle
-    }
-    if(grandparent->left_child == node->parent)
-    {
-        return grandparent->right_child;
+        cout << endl << "Red-Black Tree Invariants Are Correct" << endl;
     }
     else
     {
-        return grandparent->left_child;
+        cout << endl << "Red-Black Tree Invariants Are Incorrect:";
+        cout << (report.keys_ordered ? "" : " key order,") << (report.no_red_red ? "" : " red node with red child,")
+             << (report.root_black ? "" : " red root,") << (report.black_height_equal ? "" : " black height,")
+             << (report.parent_links ? "" : " parent links,") << (report.subtree_totals ? "" : " subtree totals,")
+             << (report.cached_extremes ? "" : " smallest / largest node") << endl;
     }
-}
-
-void RBT::RBT_rotate_right(RBT_Security_Node* node)
-{
-    RBT_Security_Node* left_right_child = node->left_child->right_child;
-    if(node->parent != nullptr)
+    if(report.height_in_range)
     {
-        RBT_replace_child(node->parent, node, node->left_child);
+        cout << endl << "Red-Black Tree Height is within the Acceptable Range" << endl << endl;
     }
     else
     {
-        //order of assigning these two shouldn't matter
-        node->left_child->parent = nullptr;
-        *root = node->left_child;
+        cout << endl << "Red-Black Tree Height is Incorrect" << endl << endl;
     }
-    RBT_set_child(node->left_child, "right", node);
-    RBT_set_child(node, "left", left_right_child);
+    cout << "Validated " << report.node_count << " Nodes (Height " << report.height << ", Black Height " << report.black_height
+         << ") in " << fixed << setprecision(2) << report.milliseconds << " ms on " << report.threads_used
+         << (report.threads_used == 1 ? " Thread" : " Threads") << endl << endl;
 }
 
-void RBT::RBT_rotate_left(RBT_Security_Node* node)
+void RBT::print_RBT_tree(RBT_Node* node, int empty_space)
 {
-    RBT_Security_Node* right_left_child = node->right_child->left_child;
-    if(node->parent != nullptr)
-    {
-        RBT_replace_child(node->parent, node, node->right_child);
-    }
-    else
+    //reverse in-order walk (right, node, left) with its own stack - each level is indented further to represent
+    //a tree in the terminal
+    vector<pair<RBT_Node*, int>> pending;
+    RBT_Node* cursor = node;
+    int cursor_space = empty_space + TOTAL_SPACES;
+    while(cursor != nullptr || !pending.empty())
     {
-        //order of assigning these two shouldn't matter
-        node->right_child->parent = nullptr;
-        *root = node->right_child;
+        while(cursor != nullptr)
+        {
+            pending.push_back({cursor, cursor_space});
+            cursor = cursor->right();
+            cursor_space += TOTAL_SPACES;
+        }
+        RBT_Node* current = pending.back().first;
+        int space_count = pending.back().second;
+        pending.pop_back();
+
+        string space = "";
+        for(int i = 0; i < space_count; i++)
+        {
+            space += "    ";
+        }
+        cout << fixed << setprecision(2) <<  space << current->key.market_value << " " << (current->is_red() ? "red" : "black") << endl;
+
+        cursor = current->left();
+        cursor_space = space_count + TOTAL_SPACES;
     }
-    RBT_set_child(node->right_child, "left", node);
-    RBT_set_child(node, "right", right_left_child);
 }
 
-void RBT::RBT_set_child(RBT_Security_Node* parent, string which_child, RBT_Security_Node* child)
+
+/*------------------------------------------ Red Black Tree Bulk Load Private Functions -----------------------------------------*/
+
+bool RBT::RBT_sort_key_less(const RBT_Sort_Key& first, const RBT_Sort_Key& second)
 {
-    if(which_child == "left")
-    {
-        parent->left_child = child;
-    }
-    else
-    {
-        parent->right_child = child;
-    }
-    if (child != nullptr)
+    if(first.market_value != second.market_value)
     {
-        child->parent = parent;
+        return first.market_value < second.market_value;
     }
+    return first.ticket < second.ticket;
 }
 
-void RBT::RBT_replace_child(RBT_Security_Node* parent, RBT_Security_Node* current_child, RBT_Security_Node* new_child)
+void RBT::RBT_sort_keys(vector<RBT_Sort_Key>& keys)
 {
-    if(parent->left_child == current_child)
+    size_t workers = thread::hardware_concurrency();
+    if(keys.size() < PARALLEL_SORT_MIN || workers < 2)
     {
-        RBT_set_child(parent, "left", new_child);
+        sort(keys.begin(), keys.end(), RBT_sort_key_less);
+        return;
     }
-    else if(parent->right_child == current_child)
+    //each thread sorts its own chunk, the sorted chunks are then merged pairwise
+    size_t chunk = (keys.size() + workers - 1) / workers;
+    vector<thread> sorters;
+    for(size_t start = 0; start < keys.size(); start += chunk)
     {
-        RBT_set_child(parent, "right", new_child);
+        vector<RBT_Sort_Key>::iterator first = keys.begin() + start;
+        vector<RBT_Sort_Key>::iterator last = keys.begin() + min(start + chunk, keys.size());
+        sorters.push_back(thread([first, last]() { sort(first, last, RBT_sort_key_less); }));
     }
-}
-
-RBT_Security_Node* RBT::RBT_get_predecessor(RBT_Security_Node* node)
-{
-    node = node->left_child;
-    while (node->right_child != nullptr)
+    for(size_t i = 0; i < sorters.size(); i++)
     {
-        node = node->right_child;
+        sorters.at(i).join();
     }
-    return node;
-}
-
-RBT_Security_Node* RBT::RBT_get_sibling(RBT_Security_Node* node)
-{
-    if(node->parent != nullptr)
+    for(size_t width = chunk; width < keys.size(); width *= 2)
     {
-        if(node->parent->left_child == node)
+        for(size_t start = 0; start + width < keys.size(); start += width * 2)
         {
-            return node->parent->right_child;
+            size_t end = min(start + width * 2, keys.size());
+            inplace_merge(keys.begin() + start, keys.begin() + start + width, keys.begin() + end, RBT_sort_key_less);
         }
-        return node->parent->left_child;
     }
-    return nullptr;
 }
 
-bool RBT::RBT_is_nonNull_and_red(RBT_Security_Node* node)
+void RBT::RBT_collect_in_order(vector<RBT_Sort_Key>& keys)
 {
-    if(node == nullptr)
+    for(iterator node = begin(); node != end(); ++node)
     {
-        return false;
+        keys.push_back({node->key.market_value, node->key.ticket, &*node});
     }
-    return node->node_color == "red";
 }
 
-bool RBT::RBT_is_Null_or_black(RBT_Security_Node* node)
-{
-    if(node == nullptr)
-    {
-        return true;
-    }
-    return (node->node_color == "black");
-}
-
-bool RBT::RBT_both_children_black(RBT_Security_Node* node)
-{
-    if(node->left_child != nullptr && node->left_child->node_color == "red")
-    {
-        return false;
-    }
-    if(node->right_child != nullptr && node->right_child->node_color == "red")
-    {
-        return false;
-    }
-    return true;
-}
 
-void RBT::RBT_prepare_for_removal(RBT_Security_Node* node)
-{
-    if(RBT_try_case1(node))
-    {
-        return;
-    }
-
-    RBT_Security_Node* sibling = RBT_get_sibling(node);
-    if(RBT_try_case2(node, sibling))
-    {
-        sibling = RBT_get_sibling(node);
-    }
-    if(RBT_try_case3(node, sibling))
-    {
-        return;
-    }
-    if(RBT_try_case4(node, sibling))
-    {
-        return;
-    }
-    if(RBT_try_case5(node, sibling))
-    {
-        sibling = RBT_get_sibling(node);
-    }
-    if(RBT_try_case6(node, sibling))
-    {
-        sibling = RBT_get_sibling(node);
-    }
-    sibling->node_color = node->parent->node_color;
-    node->parent->node_color = "black";
-    if(node == node->parent->left_child)
-    {
-        sibling->right_child->node_color = "black";
-        RBT_rotate_left(node->parent);
-    }
-    else
-    {
-        sibling->left_child->node_color = "black";
-        RBT_rotate_right(node->parent);
-    }
-}
+/*---------------------------------------  Red Black Tree Private Utility Functions --------------------------------------------*/
 
-bool RBT::RBT_try_case1(RBT_Security_Node* node)
+bool RBT::RBT_key_less(Money first_value, int first_ticket, Money second_value, int second_ticket)
 {
-    if(node->node_color == "red" || node->parent == nullptr)
-    {
-        return true;
-    }
-    else
+    if(first_value != second_value)
     {
-        return false;
+        return first_value < second_value;
     }
+    return first_ticket < second_ticket;
 }
 
-bool RBT::RBT_try_case2(RBT_Security_Node* node, RBT_Security_Node* sibling)
+void RBT::count_and_sum_below(Money market_value, bool inclusive, int& count, Money& sum)
 {
-    if(sibling->node_color == "red")
+    count = 0;
+    sum = Money();
+    RBT_Node* cursor = nodes.root_node();
+    while(cursor != nullptr)
     {
-        node->parent->node_color = "red";
-        sibling->node_color = "black";
-        if (node == node->parent->left_child)
+        Money value = cursor->key.market_value;
+        if(value < market_value || (inclusive && value == market_value))
         {
-            RBT_rotate_left(node->parent);
+            //the cursor and its whole left subtree are below the value - take them and continue right
+            count += 1 + count_nodes(cursor->left());
+            sum += value + sum_nodes(cursor->left());
+            cursor = cursor->right();
         }
         else
         {
-            RBT_rotate_right(node->parent);
+            cursor = cursor->left();
         }
-        return true;
     }
-    return false;
 }
 
-bool RBT::RBT_try_case3(RBT_Security_Node* node, RBT_Security_Node* sibling)
-{
-    if(node->parent->node_color == "black" && RBT_both_children_black(sibling))
-    {
-        sibling->node_color = "red";
-        RBT_prepare_for_removal(node->parent);
-        return true;
-    }
-    return false;
-}
+/*--------------------------------------- Red Black Tree Private Test Functions ------------------------------------------------*/
 
-bool RBT::RBT_try_case4(RBT_Security_Node* node, RBT_Security_Node* sibling)
+RBT_Subtree_Check RBT::RBT_check_subtree(RBT_Node* subtree, int frontier_depth, const vector<RBT_Subtree_Check>& frontier,
+                                         RBT_Validation_Report& report)
 {
-    if(node->parent->node_color == "red" && RBT_both_children_black(sibling))
+    //post-order walk with its own stack. A node is checked once both of its subtrees are, their results sitting on top
+    //of the results stack. Nodes at the frontier depth were checked already, their results are taken in left to right order.
+    struct Pending_Node
     {
-        node->parent->node_color = "black";
-        sibling->node_color = "red";
-        return true;
+        RBT_Node* node;
+        int depth;
+        bool subtrees_checked;
+    };
+    vector<Pending_Node> pending;
+    vector<RBT_Subtree_Check> results;
+    const RBT_Subtree_Check empty = {0, 0, 0, nullptr, nullptr, Money(), 0, Money(), 0};
+    size_t frontier_next = 0;
+    if(subtree == nullptr)
+    {
+        return empty;
     }
-    return false;
-}
-
-bool RBT::RBT_try_case5(RBT_Security_Node* node, RBT_Security_Node* sibling)
-{
-    if(RBT_is_nonNull_and_red(sibling->left_child) && RBT_is_Null_or_black(sibling->right_child) && node == node->parent->left_child)
+    pending.push_back({subtree, 0, false});
+    while(!pending.empty())
     {
-        sibling->node_color = "red";
-        sibling->left_child->node_color = "black";
-        RBT_rotate_right(sibling);
-        return true;
+        Pending_Node& current = pending.back();
+        RBT_Node* node = current.node;
+        if(current.depth == frontier_depth)
+        {
+            results.push_back(frontier.at(frontier_next++));
+            pending.pop_back();
+        }
+        else if(!current.subtrees_checked)
+        {
+            //the left subtree is pushed last so it is checked first, empty subtrees are never pushed
+            current.subtrees_checked = true;
+            int child_depth = current.depth + 1;
+            if(node->right() != nullptr)
+            {
+                pending.push_back({node->right(), child_depth, false});
+            }
+            if(node->left() != nullptr)
+            {
+                pending.push_back({node->left(), child_depth, false});
+            }
+        }
+        else
+        {
+            pending.pop_back();
+            RBT_Subtree_Check right = empty;
+            RBT_Subtree_Check left = empty;
+            if(node->right() != nullptr)
+            {
+                right = results.back();
+                results.pop_back();
+            }
+            if(node->left() != nullptr)
+            {
+                left = results.back();
+                results.pop_back();
+            }
+            results.push_back(RBT_check_node(node, left, right, report));
+        }
     }
-    return false;
-
+    return results.back();
 }
 
-bool RBT::RBT_try_case6(RBT_Security_Node* node, RBT_Security_Node* sibling)
+RBT_Subtree_Check RBT::RBT_check_node(RBT_Node* node, const RBT_Subtree_Check& left, const RBT_Subtree_Check& right,
+                                      RBT_Validation_Report& report)
 {
-    if(RBT_is_Null_or_black(sibling->left_child) && RBT_is_nonNull_and_red(sibling->right_child) && node == node->parent->right_child)
+    //test numeric ordering on market value then ticket against the largest key on the left and smallest on the right
+    if(left.rightmost != nullptr && RBT_key_less(node->key.market_value, node->key.ticket, left.highest_value, left.highest_ticket))
     {
-        sibling->node_color = "red";
-        sibling->right_child->node_color = "black";
-        RBT_rotate_left(sibling);
-        return true;
+        report.keys_ordered = false;
     }
-    return false;
-}
-
-
-
-/*---------------------------------------  Red Black Tree Private Utility Functions --------------------------------------------*/
-
-void RBT::extract_node_data(RBT_Security_Node* target, RBT_Security_Node* source, bool copy_color)
-{   //maybe need an optional parameter to copy over color for remove function
-    //function is called in multiple places, one call doesn't need the color to be carried over
-    target->portfolio = source->portfolio;
-    target->cusip = source->cusip;
-    target->ticket = source->ticket;
-    target->maturity = source->maturity;
-    target->pledge_id = source->pledge_id;
-    target->pledge_description = source->pledge_description;
-    target->pledge_amount = source->pledge_amount;
-    target->par_value = source->par_value;
-    target->market_value = source->market_value;
-    target->group = source->group;
-    target->security_description = source->security_description;
-    if(copy_color)
+    if(right.leftmost != nullptr && RBT_key_less(right.lowest_value, right.lowest_ticket, node->key.market_value, node->key.ticket))
     {
-        target->node_color = source->node_color;
+        report.keys_ordered = false;
     }
-}
-
-int RBT::count_nodes(RBT_Security_Node* root)
-{
-    int counter = 0;
-    if(root == nullptr)
+    RBT_Node* left_child = node->left();
+    RBT_Node* right_child = node->right();
+    //test red/black relation by testing that no red node has red children
+    if(node->is_red() && ((left_child != nullptr && left_child->is_red()) || (right_child != nullptr && right_child->is_red())))
     {
-        return 0;
+        report.no_red_red = false;
     }
-    counter += count_nodes(root->left_child);
-    counter += count_nodes(root->right_child);
-    return counter + 1;
-}
-
-/*--------------------------------------- Red Black Tree Private Test Functions ------------------------------------------------*/
-
-bool RBT::test_invariants(RBT_Security_Node* root)
-{   
-    bool status = true;
-    if (root == nullptr)
+    if(left.black_height != right.black_height)
     {
-        return true;
+        report.black_height_equal = false;
     }
-    status = test_invariants(root->left_child);
-    //test numeric ordering
-    if (root->left_child!= nullptr && root->left_child->market_value >= root->market_value)
+    if((left_child != nullptr && left_child->parent() != node) || (right_child != nullptr && right_child->parent() != node))
     {
-        return false;
+        report.parent_links = false;
     }
-    if(root->right_child != nullptr && root->right_child->market_value < root->market_value) 
+    //test the stored subtree size and market value total match the node's children
+    int expected_size = 1 + (left_child == nullptr ? 0 : left_child->subtree_size) + (right_child == nullptr ? 0 : right_child->subtree_size);
+    Money expected_sum = node->key.market_value + (left_child == nullptr ? Money() : left_child->subtree_sum)
+                         + (right_child == nullptr ? Money() : right_child->subtree_sum);
+    if(node->subtree_size != expected_size || node->subtree_sum != expected_sum)
     {
-        return false;
+        report.subtree_totals = false;
     }
 
-    //test red/black relation by testing that no red node has red children
-    if (root->node_color == "red" && root->left_child != nullptr && root->left_child->node_color == "red")
+    RBT_Subtree_Check check;
+    check.node_count = 1 + left.node_count + right.node_count;
+    check.height = 1 + max(left.height, right.height);
+    check.black_height = max(left.black_height, right.black_height) + (node->is_red() ? 0 : 1);
+    if(left.leftmost != nullptr)
     {
-        return false;
+        check.leftmost = left.leftmost;
+        check.lowest_value = left.lowest_value;
+        check.lowest_ticket = left.lowest_ticket;
     }
-    if (root->node_color == "red" && root->right_child != nullptr && root->right_child->node_color == "red")
+    else
     {
-        return false;
+        check.leftmost = node;
+        check.lowest_value = node->key.market_value;
+        check.lowest_ticket = node->key.ticket;
     }
-    //test root is black
-    if (root->parent == nullptr && root->node_color == "red")
+    if(right.rightmost != nullptr)
     {
-        return false;
+        check.rightmost = right.rightmost;
+        check.highest_value = right.highest_value;
+        check.highest_ticket = right.highest_ticket;
     }
-    status = test_invariants(root->right_child);
-
-    return status;     
-}
-
-int RBT::get_tree_height(RBT_Security_Node* root)
-{
-    if (root == nullptr)
+    else
     {
-        return -1;
+        check.rightmost = node;
+        check.highest_value = node->key.market_value;
+        check.highest_ticket = node->key.ticket;
     }
-    int left_height = get_tree_height(root->left_child);
-    int right_height = get_tree_height(root->right_child);
-    return 1 + max(left_height, right_height);
+    return check;
 }
 
-RBT_Security_Node* RBT::find_node(RBT_Security_Node* root, int ticket, double mv)
+void RBT::RBT_collect_frontier(RBT_Node* root, int frontier_depth, vector<RBT_Node*>& subtrees)
 {
-    if (root == nullptr)
+    //left to right, the same order the post-order walk reaches them in
+    vector<pair<RBT_Node*, int>> pending;
+    if(root != nullptr)
     {
-        return nullptr;
+        pending.push_back({root, 0});
     }
-    else if (root->ticket == ticket && root->market_value == mv)
+    while(!pending.empty())
     {
-        return root;
-    }
-    else
-    {      
-        if(mv < root->market_value)
+        RBT_Node* node = pending.back().first;
+        int depth = pending.back().second;
+        pending.pop_back();
+        if(depth == frontier_depth)
         {
-            return find_node(root->left_child, ticket, mv);
+            subtrees.push_back(node);
+            continue;
         }
-        else
+        if(node->right() != nullptr)
+        {
+            pending.push_back({node->right(), depth + 1});
+        }
+        if(node->left() != nullptr)
         {
-            return find_node(root->right_child, ticket, mv);
+            pending.push_back({node->left(), depth + 1});
         }
     }
 }
 
-double RBT::sum_nodes(RBT_Security_Node* root)
+Money RBT::sum_nodes(RBT_Node* root)
 {
+    if (root == nullptr)
     {
-        if (root == nullptr)
-            return 0;
+        return Money();
+    }
+    return root->subtree_sum;
+}
 
-        return (root->market_value + sum_nodes(root->left_child) + sum_nodes(root->right_child));
+int RBT::count_nodes(RBT_Node* root)
+{
+    if(root == nullptr)
+    {
+        return 0;
     }
-}
\ No newline at end of file
+    return root->subtree_size;
+}
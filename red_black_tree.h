@@ -3,20 +3,31 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iomanip>
 #include <algorithm>
 #include <cmath>
+#include <thread>
+#include <iterator>
+#include <atomic>
+#include <chrono>
+#include "node_pool.h"
+#include "money.h"
+#include "generic_rbt.h"
 
 
 using namespace std;
 #define TOTAL_SPACES 4 //used within the print_RBT_tree function
+#define PARALLEL_SORT_MIN 65536 //smallest bulk load that is worth splitting across threads to sort
+#define PARALLEL_VALIDATE_MIN 65536 //smallest tree that is worth splitting across threads to validate
 
 
 /*--------------------------------------Account and Customer Node Structures ---------------------------------------------------*/
 
 /*
-    This structure holds the contents of a security as wells as the components needed to construct the red-black tree
+    This structure holds the contents of a security (the security record). Records are kept apart from
+    the red-black tree so that searching and rebalancing never have to touch the descriptive fields.
 */
 struct RBT_Security_Node
 {
@@ -26,183 +37,442 @@ struct RBT_Security_Node
     string maturity;
     int pledge_id; //if there is no pledge id, it will be set to 0;
     string pledge_description;
-    double pledge_amount;
-    double par_value;
-    double market_value;
+    Money pledge_amount;
+    Money par_value;
+    Money market_value;
     string group;
     string security_description;
 
     string change_status;
 
-    string node_color; // black or red
-    RBT_Security_Node* parent = nullptr;
-    RBT_Security_Node* left_child = nullptr;
-    RBT_Security_Node* right_child = nullptr;
+    //security records are carved out of a shared slab pool rather than allocated one at a time
+    static void* operator new(size_t size);
+    static void operator delete(void* node, size_t size);
+
+    /*
+        Function returns the pool every security record is allocated from (the security record table).
+        The tree, the customer pledge vectors and the change vectors all draw from this one pool.
+    */
+    static Node_Pool<RBT_Security_Node>& pool();
+
+    //bytes held by the record, including any string buffers it owns
+    size_t footprint() const;
+};
+
+/*
+    This structure is the search key of the security tree - securities are ordered on market value, then ticket.
+*/
+struct RBT_Key
+{
+    Money market_value;
+    int ticket;
 };
 
+struct RBT_Key_Less
+{
+    bool operator()(const RBT_Key& first, const RBT_Key& second) const
+    {
+        return first.market_value < second.market_value
+               || (first.market_value == second.market_value && first.ticket < second.ticket);
+    }
+};
 
-/* -------------------------------------------------Red-Black Tree Class--------------------------------------------------------*/
+/*
+    This structure is the augment every security tree node carries - the size and market value total of the node's
+    subtree, including itself. The generic tree refreshes it through inserts, removals and rotations.
+*/
+struct RBT_Subtree_Totals
+{
+    Money subtree_sum; //market value total of this node and everything beneath it
+    int subtree_size = 1; //number of securities in this node's subtree, including itself
+
+    template <typename Node>
+    static void update(Node* node)
+    {
+        node->subtree_size = 1;
+        node->subtree_sum = node->key.market_value;
+        if(node->left() != nullptr)
+        {
+            node->subtree_size += node->left()->subtree_size;
+            node->subtree_sum += node->left()->subtree_sum;
+        }
+        if(node->right() != nullptr)
+        {
+            node->subtree_size += node->right()->subtree_size;
+            node->subtree_sum += node->right()->subtree_sum;
+        }
+    }
+};
+
+//color packed into the left child pointer, parent pointers kept and the subtree totals as the augment
+typedef RBT_Policy<true, true, RBT_Subtree_Totals> RBT_Security_Policy;
+
+/*
+    The security tree's nodes are the generic tree's nodes under the security policy. A node holds only the search
+    key (market value and ticket), the links with the color bit, the subtree totals and a pointer to the security
+    record with the descriptive data (value). With the color packed into a link a node is 64 bytes and fills a
+    single cache line.
+*/
+typedef Generic_RBT<RBT_Key, RBT_Security_Node*, RBT_Key_Less, RBT_Security_Policy> RBT_Node_Tree;
+typedef RBT_Node_Tree::Node RBT_Node;
+
+/*
+    This structure is an entry used while sorting a bulk load. The search key is copied next to the
+    node pointer so the sort compares keys held side by side rather than following a pointer to every node.
+*/
+struct RBT_Sort_Key
+{
+    Money market_value;
+    int ticket;
+    RBT_Node* node;
+};
 
+/*
+    This structure is the result of validating the red-black tree. Each check is reported on its own,
+    along with the size and shape of the tree and how long the validation took.
+*/
+struct RBT_Validation_Report
+{
+    bool keys_ordered = true; //every node sits between the keys of its left and right subtrees
+    bool no_red_red = true; //no red node has a red child
+    bool root_black = true;
+    bool black_height_equal = true; //every path down from a node passes the same number of black nodes
+    bool parent_links = true; //every child points back at its parent
+    bool subtree_totals = true; //stored subtree sizes and market value totals match the children
+    bool cached_extremes = true; //cached smallest and largest nodes are the leftmost and rightmost nodes
+    bool height_in_range = true; //between log2(N + 1) and 2 * log2(N + 1) levels
+    int node_count = 0;
+    int height = 0; //levels, 0 for an empty tree
+    int black_height = 0; //black nodes on every path from the root down
+    int threads_used = 1;
+    double milliseconds = 0;
+
+    //true when every red-black tree invariant holds (all checks other than the height)
+    bool invariants_hold() const;
+
+    //true when every check passed
+    bool valid() const;
+};
 
+/*
+    This structure is what the validator knows about a subtree once every node in it has been checked. The keys
+    of its leftmost and rightmost nodes are copied here so the parent is checked without going back to those nodes.
+*/
+struct RBT_Subtree_Check
+{
+    int node_count;
+    int height;
+    int black_height;
+    RBT_Node* leftmost;
+    RBT_Node* rightmost;
+    Money lowest_value;
+    int lowest_ticket;
+    Money highest_value;
+    int highest_ticket;
+};
+
+
+/* -------------------------------------------------Red-Black Tree Class--------------------------------------------------------*/
+
+/*
+    The security tree. The nodes, and every red-black rule that keeps them balanced, belong to the generic tree it
+    holds (see generic_rbt.h) - this class adds ownership of the security records, sorted bulk loads, the cached
+    smallest and largest nodes, range sums on the subtree totals and the tree validator.
+*/
 class RBT 
 {
 public:
 
+    /*
+        Bidirectional iterator over the tree nodes in key order (market value, then ticket). Steps follow the
+        parent links, so walking the whole tree is O(N) and a single step is O(1) amortized. end() sits one
+        past the largest node - decrementing it gives the largest node.
+    */
+    class iterator
+    {
+    public:
+        typedef bidirectional_iterator_tag iterator_category;
+        typedef RBT_Node value_type;
+        typedef ptrdiff_t difference_type;
+        typedef RBT_Node* pointer;
+        typedef RBT_Node& reference;
+
+        iterator(RBT_Node* node = nullptr, const RBT* tree = nullptr);
+
+        RBT_Node& operator*() const;
+        RBT_Node* operator->() const;
+
+        iterator& operator++();
+        iterator operator++(int);
+        iterator& operator--();
+        iterator operator--(int);
+
+        bool operator==(const iterator& other) const;
+        bool operator!=(const iterator& other) const;
+
+    private:
+        RBT_Node* current;
+        const RBT* owner;
+
+        friend class RBT;
+    };
+
     //Tree Constructor
     RBT();  
 
-    //Tree Deconstructor
+    //Tree Deconstructor - frees every node along with the security records still in the tree
     ~RBT(); 
 
+    /*
+        The tree owns its nodes and their records, so it can be moved but not copied. A move hands the
+        nodes over in O(1) and leaves the moved from tree empty. Iterators into a moved tree are invalidated.
+        Functions that only work on the tree take it (or the security index around it) by reference.
+    */
+    RBT(const RBT&) = delete;
+    RBT& operator=(const RBT&) = delete;
+    RBT(RBT&& other) noexcept;
+    RBT& operator=(RBT&& other) noexcept;
+
 
     /*--------------------------------- Red Black Tree Public Insert and Remove Functions --------------------------------------*/
 
     /*
-        Function is called to initiate the addition of a security node into the red-black tree
+        Function is called to initiate the addition of a security into the red-black tree. A tree node
+        is built for the security record and returned. The tree takes ownership of the record.
     */
-    void RBT_add_node(RBT_Security_Node* node);
+    RBT_Node* RBT_add_node(RBT_Security_Node* security);
 
     /*
-        Function is called to initiate the removal of a security node from the red-black tree
+        Function is called to initiate the removal of a security node from the red-black tree.
+        The tree node is unlinked and freed, and its security record is handed back to the caller,
+        who takes ownership of it. Removal only relinks pointers, so every other tree node keeps
+        its address and its security for as long as it remains in the tree.
     */
-    void RBT_remove_node(RBT_Security_Node* node); 
+    RBT_Security_Node* RBT_remove_node(RBT_Node* node); 
 
- 
+    /*
+        Function is called to add many securities to the red-black tree at once. The securities are sorted
+        (split across threads for large loads) and merged with the nodes already in the tree, then the tree
+        is rebuilt bottom-up in O(N) with every level black except the deepest, partially filled level,
+        which is red. Nodes already in the tree are relinked rather than rebuilt, so their handles stay valid.
+        When only a few securities are added to a large tree they are inserted one at a time instead.
+        The tree takes ownership of the records.
+    */
+    void RBT_bulk_add(const vector<RBT_Security_Node*>& securities);
 
-    /*------------------------------------- Red Black Tree Public Utility Functions --------------------------------------------*/
+    /*
+        Function returns the tree node holding the security with the passed in ticket and market value.
+        The tree is ordered on market value and then ticket, so this is a single O(logN) descent, even
+        among many securities of the same value. Returns nullptr if the security is not in the tree.
+    */
+    RBT_Node* find(int ticket, Money market_value);
 
     /*
-        Function is called to consruct a security node. The vector parameter 
-        consists of data from each security line within the loaded csv file. 
-        Data conversions are performed here
+        Function removes the security with the passed in ticket and market value from the tree and hands its
+        record back to the caller (see RBT_remove_node). Returns nullptr if the security is not in the tree.
     */
-    RBT_Security_Node* build_security_node(const vector<string>& security_data);
+    RBT_Security_Node* erase(int ticket, Money market_value);
 
     /*
-        Function is called to return the root node of the tree.
-        Returns nullptr if root is empty
+        Function returns the tree node holding the passed in security record. Identical lots share a key, so the
+        nodes with an equal key are walked in order until the one holding this exact record is found.
+        Returns nullptr if the record is not in the tree.
     */
-    RBT_Security_Node* get_root();
+    RBT_Node* find_record(RBT_Security_Node* security);
 
     /*
-        Function is called to set the root of the tree as the security
-        node passed in
+        Function removes the node at the iterator's position and returns an iterator to the node after it.
+        The security record is handed back to the caller through the security parameter.
     */
-    void set_root(RBT_Security_Node* node);
+    iterator erase(iterator position, RBT_Security_Node*& security);
 
     /*
-        Function is called to make a copy of the node passed in.
-        All details of the security are copied, with the exception
-        of red-black tree data (parent, children, node color and change 
-        status are not copied)
+        Function removes the node at the iterator's position, deletes its security record and returns an
+        iterator to the node after it.
     */
-    RBT_Security_Node* RBT_copy_node(RBT_Security_Node* node);
+    iterator erase(iterator position);
+
+    /*---------------------------------------- Red Black Tree Public Iterator Functions ----------------------------------------*/
+
+    //iterator to the smallest node, O(1)
+    iterator begin() const;
+
+    //iterator one past the largest node
+    iterator end() const;
 
     /*
-        Function is called in order to remove a pre-established red-black tree
-        Beginning at the passed in node of the tree, the function performs 
-        a post-order traversal to free up the memory of each security by 
-        delete each node in the tree.
+        Function returns an iterator to the first node with a market value not below the value passed in,
+        or end() if there is none. O(logN)
     */
-    void RBT_delete_tree(RBT_Security_Node* root);
+    iterator lower_bound(Money market_value) const;
 
     /*
-        Function returns the security node in the red-black tree
-        with the smallest market value (the 'leftmost' node  of tree)
+        Function returns an iterator to the first node with a market value above the value passed in,
+        or end() if there is none. O(logN)
     */
-    RBT_Security_Node* find_minimum(RBT_Security_Node* root);
+    iterator upper_bound(Money market_value) const;
 
     /*
-        Function returns the security node in the red-black tree
-        with the largest market value (the 'rightmost' node  of tree)
+        Functions return the node with the smallest / largest key. Both are cached and kept up to date
+        through inserts and removals, so they are O(1). Returns nullptr if the tree is empty.
     */
-    RBT_Security_Node* find_maximum(RBT_Security_Node* root);
+    RBT_Node* get_minimum() const;
 
-    /*---------------------------------------- Red Black Tree Public Test Functions --------------------------------------------*/
+    RBT_Node* get_maximum() const;
 
-   /*
-        Function runs a series of checks to test if the red black tree
-        invariants are appropriate. These tests include checking the 
-        numeric ordering of the tree based on market value, the relationship 
-        between red and black nodes as well testing the height of the tree.
-    */
-    void run_RBT_tests(RBT_Security_Node* root);
+ 
+
+    /*------------------------------------- Red Black Tree Public Utility Functions --------------------------------------------*/
 
     /*
-        Function prints a horizontal representation of the red black tree
+        Function is called to consruct a security node. The vector parameter 
+        consists of data from each security line within the loaded csv file. 
+        Data conversions are performed here. The fields may be views straight into the file text (see
+        csv_reader.h) - only the eleven fields the node keeps are copied, anything after them is ignored.
     */
-    void print_RBT_tree(RBT_Security_Node* node, int empty_space = 0);
+    static RBT_Security_Node* build_security_node(const vector<string_view>& security_data);
 
-    RBT_Security_Node* find_node(RBT_Security_Node* root, int ticket, double MV);
+    static RBT_Security_Node* build_security_node(const vector<string>& security_data);
 
-    double sum_nodes(RBT_Security_Node* root);
+    /*
+        Function is called to return the root node of the tree.
+        Returns nullptr if root is empty
+    */
+    RBT_Node* get_root();
 
-    int count_nodes(RBT_Security_Node* root);
+    /*
+        Function is called to make a copy of the security record passed in.
+        All details of the security are copied, with the exception
+        of the change status
+    */
+    static RBT_Security_Node* RBT_copy_node(RBT_Security_Node* node);
 
-private:
+    /*
+        Function deletes every node in the tree along with its security record and leaves the tree empty.
+    */
+    void clear();
 
-    //holds the root of the RBT object
-    RBT_Security_Node** root;
+    /*
+        Function drops every node in the tree and leaves the tree empty, without deleting the security records -
+        they are released by the caller. The nodes come from the tree's own pool, so this is a single pool reset
+        that leaves every other tree untouched. O(1)
+    */
+    void release_nodes();
 
-    int security_node_count = 0;
+    //the pool this tree's nodes come from, for its live and peak node counts
+    const Node_Pool<RBT_Node>& node_pool() const;
 
-    /*------------------------------------ Red Black Tree Private Insert and Remove Functions ----------------------------------*/
+    /*
+        Function returns the number of bytes held by the tree - the tree object, its nodes and the security
+        records they point to, including string buffers. O(N)
+    */
+    size_t memory_footprint();
 
-    void RBT_BST_Remove(RBT_Security_Node* node);
+    /*
+        Function returns the security node in the red-black tree
+        with the smallest market value (the 'leftmost' node  of tree)
+    */
+    RBT_Node* find_minimum(RBT_Node* root);
 
-    void RBT_insert(RBT_Security_Node* new_node);
+    /*
+        Function returns the security node in the red-black tree
+        with the largest market value (the 'rightmost' node  of tree)
+    */
+    RBT_Node* find_maximum(RBT_Node* root);
 
-    /*------------------------------ Red Black Tree Rebalancing Private Helper Functions ---------------------------------------*/
+    /*------------------------------------- Red Black Tree Public Range Functions ----------------------------------------------*/
 
-    void RBT_Balance(RBT_Security_Node* node);
-    
-    RBT_Security_Node* get_grandparent_node(RBT_Security_Node* node);
+    /*
+        Function returns the number of securities in the tree with a market value between min and max (inclusive).
+        Uses the subtree sizes, O(logN)
+    */
+    int range_count(Money min, Money max);
 
-    RBT_Security_Node* get_uncle_node(RBT_Security_Node* node);
+    /*
+        Function returns the market value total of the securities in the tree with a market value between min and max
+        (inclusive) - the free collateral available in that range. Uses the subtree totals, O(logN)
+    */
+    Money range_sum(Money min, Money max);
 
-    void RBT_rotate_right(RBT_Security_Node* node);
+    /*
+        Function returns the security node with the passed in rank, where rank 0 is the smallest market value.
+        Returns nullptr if the rank is outside of the tree. O(logN)
+    */
+    RBT_Node* select_by_rank(int rank);
 
-    void RBT_rotate_left(RBT_Security_Node* node);
+    /*
+        Function returns the number of securities in the tree with a market value smaller than the value passed in,
+        which is the rank a security of that value would take. O(logN)
+    */
+    int rank_of_value(Money market_value);
 
-    void RBT_set_child(RBT_Security_Node* parent, string which_child, RBT_Security_Node* child);
+    /*---------------------------------------- Red Black Tree Public Test Functions --------------------------------------------*/
 
-    void RBT_replace_child(RBT_Security_Node* parent, RBT_Security_Node* current_child, RBT_Security_Node* new_child);
-    
-    RBT_Security_Node* RBT_get_predecessor(RBT_Security_Node* node);
+    /*
+        Function validates the whole tree in a single pass and returns the report - key ordering, red nodes with
+        red children, black height, parent links, stored subtree totals, the cached extremes and the height bound.
+        The walk keeps its own stack rather than recursing, so a damaged, lopsided tree can't exhaust the call stack.
+        Large trees are split into subtrees that are checked across threads, then the top of the tree is checked
+        above them.
+    */
+    RBT_Validation_Report validate() const;
 
-    RBT_Security_Node* RBT_get_sibling(RBT_Security_Node* node);
+   /*
+        Function runs a series of checks to test if the red black tree
+        invariants are appropriate (see validate) and prints the results.
+    */
+    void run_RBT_tests();
 
-    bool RBT_is_nonNull_and_red(RBT_Security_Node* node);
+    /*
+        Function prints a horizontal representation of the red black tree
+    */
+    void print_RBT_tree(RBT_Node* node, int empty_space = 0);
 
-    bool RBT_is_Null_or_black(RBT_Security_Node* node);
+    /*
+        Function returns the market value total of the subtree beneath the passed in node. 
+        Read from the node's stored subtree total, O(1)
+    */
+    Money sum_nodes(RBT_Node* root);
 
-    bool RBT_both_children_black(RBT_Security_Node* node);
+    /*
+        Function returns the number of securities in the subtree beneath the passed in node.
+        Read from the node's stored subtree size, O(1)
+    */
+    int count_nodes(RBT_Node* root);
 
-    void RBT_prepare_for_removal(RBT_Security_Node* node);
+private:
 
-    bool RBT_try_case1(RBT_Security_Node* node);
+    //the nodes of the tree, balanced by the generic tree's insert and removal
+    RBT_Node_Tree nodes;
 
-    bool RBT_try_case2(RBT_Security_Node* node, RBT_Security_Node* sibling);
+    //smallest and largest nodes, kept up to date by every insert and removal
+    RBT_Node* minimum_node = nullptr;
+    RBT_Node* maximum_node = nullptr;
 
-    bool RBT_try_case3(RBT_Security_Node* node, RBT_Security_Node* sibling);
+    /*-------------------------------------- Red Black Tree Bulk Load Private Helper Functions ---------------------------------*/
 
-    bool RBT_try_case4(RBT_Security_Node* node, RBT_Security_Node* sibling);
+    static bool RBT_sort_key_less(const RBT_Sort_Key& first, const RBT_Sort_Key& second);
 
-    bool RBT_try_case5(RBT_Security_Node* node, RBT_Security_Node* sibling);
+    void RBT_sort_keys(vector<RBT_Sort_Key>& keys);
 
-    bool RBT_try_case6(RBT_Security_Node* node, RBT_Security_Node* sibling);
+    void RBT_collect_in_order(vector<RBT_Sort_Key>& keys);
 
+    /*------------------------------ Red Black Tree Key and Subtree Total Private Helper Functions -----------------------------*/
 
-    /*--------------------------------------  Red Black Tree Private Utility Functions -----------------------------------------*/
+    static bool RBT_key_less(Money first_value, int first_ticket, Money second_value, int second_ticket);
 
-    void extract_node_data(RBT_Security_Node* target, RBT_Security_Node* source, bool copy_color = false);
+    void count_and_sum_below(Money market_value, bool inclusive, int& count, Money& sum);
 
 
     /*--------------------------------------- Red Black Tree Private Test Functions --------------------------------------------*/
 
-    bool test_invariants(RBT_Security_Node* root);
+    static RBT_Subtree_Check RBT_check_subtree(RBT_Node* subtree, int frontier_depth, const vector<RBT_Subtree_Check>& frontier,
+                                               RBT_Validation_Report& report);
+
+    static RBT_Subtree_Check RBT_check_node(RBT_Node* node, const RBT_Subtree_Check& left, const RBT_Subtree_Check& right,
+                                            RBT_Validation_Report& report);
 
-    int get_tree_height(RBT_Security_Node* root);
+    static void RBT_collect_frontier(RBT_Node* root, int frontier_depth, vector<RBT_Node*>& subtrees);
 
   
 
@@ -0,0 +1,314 @@
+#include "security_catalog.h"
+#include "supporting_func_structs.h"
+
+using namespace std;
+
+
+/*----------------------------------------------- Security Catalog Update Functions --------------------------------------------*/
+
+void Security_Catalog::register_record(RBT_Security_Node* record)
+{
+    if(records.find(record) != records.end())
+    {
+        return;
+    }
+    Catalog_Entry entry;
+    //a lot without a readable maturity can't be placed by date, so it is only counted as undated
+    int maturity = maturity_key(record->maturity);
+    entry.maturity_position = (maturity != UNDATED_MATURITY) ? by_maturity.insert(maturity, record) : nullptr;
+    entry.group_position = by_group.insert(record->group, record);
+    by_ticket.insert({record->ticket, record});
+    by_cusip.insert({record->cusip, record});
+    records[record] = entry;
+}
+
+void Security_Catalog::unregister_record(RBT_Security_Node* record)
+{
+    unordered_map<RBT_Security_Node*, Catalog_Entry>::iterator entry = records.find(record);
+    if(entry == records.end())
+    {
+        return;
+    }
+    if(entry->second.maturity_position != nullptr)
+    {
+        by_maturity.erase(entry->second.maturity_position);
+    }
+    by_group.erase(entry->second.group_position);
+
+    //hash index iterators don't survive a rehash, so the lots sharing the key are walked to find this record
+    auto tickets = by_ticket.equal_range(record->ticket);
+    for(auto lot = tickets.first; lot != tickets.second; lot++)
+    {
+        if(lot->second == record)
+        {
+            by_ticket.erase(lot);
+            break;
+        }
+    }
+    auto cusips = by_cusip.equal_range(record->cusip);
+    for(auto lot = cusips.first; lot != cusips.second; lot++)
+    {
+        if(lot->second == record)
+        {
+            by_cusip.erase(lot);
+            break;
+        }
+    }
+    records.erase(entry);
+}
+
+void Security_Catalog::rebuild(Security_Index& index, Customer_Store& customers)
+{
+    clear();
+    vector<RBT_Security_Node*> securities;
+    index.collect_securities(securities);
+    for (size_t i = 0; i < customers.size(); i++)
+    {
+        securities.insert(securities.end(), customers.at(i)->pledged_to_customer.begin(), customers.at(i)->pledged_to_customer.end());
+    }
+    records.reserve(securities.size());
+    by_ticket.reserve(securities.size());
+    by_cusip.reserve(securities.size());
+    for(size_t i = 0; i < securities.size(); i++)
+    {
+        register_record(securities.at(i));
+    }
+}
+
+void Security_Catalog::clear()
+{
+    records.clear();
+    by_ticket.clear();
+    by_cusip.clear();
+    by_maturity.clear();
+    by_group.clear();
+}
+
+
+/*----------------------------------------------- Security Catalog Lookup Functions --------------------------------------------*/
+
+RBT_Security_Node* Security_Catalog::find_ticket(int ticket) const
+{
+    unordered_multimap<int, RBT_Security_Node*>::const_iterator lot = by_ticket.find(ticket);
+    return (lot != by_ticket.end()) ? lot->second : nullptr;
+}
+
+vector<RBT_Security_Node*> Security_Catalog::find_cusip(const string& cusip) const
+{
+    vector<RBT_Security_Node*> lots;
+    collect_cusip(cusip, lots);
+    return lots;
+}
+
+void Security_Catalog::collect_cusip(const string& cusip, vector<RBT_Security_Node*>& lots) const
+{
+    auto cusips = by_cusip.equal_range(cusip);
+    for(auto lot = cusips.first; lot != cusips.second; lot++)
+    {
+        lots.push_back(lot->second);
+    }
+}
+
+vector<RBT_Security_Node*> Security_Catalog::maturing_between(int first_date, int last_date) const
+{
+    vector<RBT_Security_Node*> lots;
+    if(first_date > last_date)
+    {
+        return lots;
+    }
+    by_maturity.for_each_in_range(first_date, last_date, [&lots](Maturity_Tree::Node* lot)
+    {
+        lots.push_back(lot->value);
+    });
+    return lots;
+}
+
+vector<RBT_Security_Node*> Security_Catalog::find_group(const string& group) const
+{
+    vector<RBT_Security_Node*> lots;
+    by_group.for_each_in_range(group, group, [&lots](Group_Tree::Node* lot)
+    {
+        lots.push_back(lot->value);
+    });
+    return lots;
+}
+
+int Security_Catalog::lot_count() const
+{
+    return records.size();
+}
+
+int Security_Catalog::undated_count() const
+{
+    return records.size() - by_maturity.size();
+}
+
+bool Catalog_Sync_Report::lookups_match() const
+{
+    return ticket_lookup && cusip_lookup && maturity_lookup && group_lookup;
+}
+
+bool Catalog_Sync_Report::in_sync() const
+{
+    return records_match && indexes_match && trees_valid && lookups_match();
+}
+
+Catalog_Sync_Report Security_Catalog::in_sync(Security_Index& index, Customer_Store& customers) const
+{
+    Catalog_Sync_Report report;
+    report.lot_count = records.size();
+    report.undated_lots = undated_count();
+    vector<RBT_Security_Node*> securities;
+    index.collect_securities(securities);
+    for (size_t i = 0; i < customers.size(); i++)
+    {
+        securities.insert(securities.end(), customers.at(i)->pledged_to_customer.begin(), customers.at(i)->pledged_to_customer.end());
+    }
+    report.trees_valid = by_maturity.validate() && by_group.validate();
+    report.records_match = securities.size() == records.size();
+    report.indexes_match = by_ticket.size() == records.size() && by_cusip.size() == records.size()
+                           && by_group.size() == records.size();
+    int undated = 0;
+    vector<RBT_Security_Node*> same_cusip; //reused for every record, so the check allocates once
+    for(size_t i = 0; i < securities.size(); i++)
+    {
+        RBT_Security_Node* record = securities.at(i);
+        unordered_map<RBT_Security_Node*, Catalog_Entry>::const_iterator entry = records.find(record);
+        if(entry == records.end())
+        {
+            report.records_match = false;
+            continue;
+        }
+        int maturity = maturity_key(record->maturity);
+        Maturity_Tree::Node* maturity_position = entry->second.maturity_position;
+        if(maturity == UNDATED_MATURITY)
+        {
+            undated++;
+            report.indexes_match = report.indexes_match && maturity_position == nullptr;
+        }
+        else
+        {
+            report.indexes_match = report.indexes_match && maturity_position != nullptr
+                                   && maturity_position->value == record && maturity_position->key == maturity;
+        }
+        report.indexes_match = report.indexes_match && entry->second.group_position->value == record
+                               && entry->second.group_position->key == record->group;
+        same_cusip.clear();
+        collect_cusip(record->cusip, same_cusip);
+        report.indexes_match = report.indexes_match && find(same_cusip.begin(), same_cusip.end(), record) != same_cusip.end();
+        bool ticket_found = false;
+        auto tickets = by_ticket.equal_range(record->ticket);
+        for(auto lot = tickets.first; lot != tickets.second; lot++)
+        {
+            ticket_found = ticket_found || lot->second == record;
+        }
+        report.indexes_match = report.indexes_match && ticket_found;
+    }
+    //every record was checked against its lot, so the maturity index holds exactly the dated lots
+    report.indexes_match = report.indexes_match && undated == report.undated_lots;
+    check_lookups(securities, report);
+    return report;
+}
+
+void Security_Catalog::check_lookups(const vector<RBT_Security_Node*>& lots, Catalog_Sync_Report& report) const
+{
+    if(lots.empty())
+    {
+        //an empty catalog has no lots to probe, but no ticket should be found in it either
+        report.ticket_lookup = find_ticket(0) == nullptr;
+        return;
+    }
+    //the maturity keys are read once, rather than parsing every date again for each probe
+    vector<int> maturities(lots.size());
+    int largest_ticket = lots.front()->ticket;
+    for(size_t i = 0; i < lots.size(); i++)
+    {
+        maturities.at(i) = maturity_key(lots.at(i)->maturity);
+        largest_ticket = max(largest_ticket, lots.at(i)->ticket);
+    }
+    if(largest_ticket < INT_MAX)
+    {
+        report.ticket_lookup = find_ticket(largest_ticket + 1) == nullptr;
+    }
+
+    size_t probes = min(lots.size(), size_t(CATALOG_LOOKUP_PROBES));
+    vector<RBT_Security_Node*> found;
+    vector<RBT_Security_Node*> scanned;
+    for(size_t probe = 0; probe < probes; probe++)
+    {
+        size_t position = probe * lots.size() / probes;
+        RBT_Security_Node* lot = lots.at(position);
+        report.lookups_checked++;
+
+        RBT_Security_Node* ticket_lot = find_ticket(lot->ticket);
+        report.ticket_lookup = report.ticket_lookup && ticket_lot != nullptr && ticket_lot->ticket == lot->ticket;
+
+        found.clear();
+        collect_cusip(lot->cusip, found);
+        scanned.clear();
+        for(RBT_Security_Node* other : lots)
+        {
+            if(other->cusip == lot->cusip)
+            {
+                scanned.push_back(other);
+            }
+        }
+        sort(found.begin(), found.end());
+        sort(scanned.begin(), scanned.end());
+        report.cusip_lookup = report.cusip_lookup && found == scanned;
+
+        found = find_group(lot->group);
+        scanned.clear();
+        for(RBT_Security_Node* other : lots)
+        {
+            if(other->group == lot->group)
+            {
+                scanned.push_back(other);
+            }
+        }
+        sort(found.begin(), found.end());
+        sort(scanned.begin(), scanned.end());
+        report.group_lookup = report.group_lookup && found == scanned;
+
+        //the range runs from this lot's maturity to the next probed lot's, so undated lots bound some ranges too
+        int first_date = maturities.at(position);
+        int last_date = maturities.at(((probe + 1) % probes) * lots.size() / probes);
+        if(first_date > last_date)
+        {
+            swap(first_date, last_date);
+        }
+        found = maturing_between(first_date, last_date);
+        for(size_t i = 1; i < found.size(); i++)
+        {
+            report.maturity_lookup = report.maturity_lookup
+                                     && maturity_key(found.at(i - 1)->maturity) <= maturity_key(found.at(i)->maturity);
+        }
+        scanned.clear();
+        for(size_t i = 0; i < lots.size(); i++)
+        {
+            if(maturities.at(i) != UNDATED_MATURITY && maturities.at(i) >= first_date && maturities.at(i) <= last_date)
+            {
+                scanned.push_back(lots.at(i));
+            }
+        }
+        sort(found.begin(), found.end());
+        sort(scanned.begin(), scanned.end());
+        report.maturity_lookup = report.maturity_lookup && found == scanned;
+    }
+}
+
+int Security_Catalog::maturity_key(const string& maturity)
+{
+    int month = 0;
+    int day = 0;
+    int year = 0;
+    char separator1 = 0;
+    char separator2 = 0;
+    stringstream date(maturity);
+    date >> month >> separator1 >> day >> separator2 >> year;
+    if(date.fail() || separator1 != '/' || separator2 != '/' || month < 1 || month > 12 || day < 1 || day > 31 || year < 1)
+    {
+        return UNDATED_MATURITY;
+    }
+    return year * 10000 + month * 100 + day;
+}
@@ -0,0 +1,171 @@
+#ifndef SECURITY_CATALOG_H
+#define SECURITY_CATALOG_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <climits>
+#include "security_index.h"
+#include "customer_store.h"
+#include "generic_rbt.h"
+
+
+using namespace std;
+
+#define UNDATED_MATURITY 0 //maturity key of a date that can't be read
+#define CATALOG_LOOKUP_PROBES 16 //lots whose fields are looked up and checked against a linear scan by in_sync
+
+//ordered indexes of the catalog - lots keyed on maturity date (yyyymmdd) and on group
+typedef Generic_RBT<int, RBT_Security_Node*> Maturity_Tree;
+typedef Generic_RBT<string, RBT_Security_Node*> Group_Tree;
+
+
+/*-------------------------------------------------- Security Catalog Structures -----------------------------------------------*/
+
+/*
+    This structure is what the catalog keeps for each security record - where the record sits in the ordered
+    indexes, so it can be taken out of them without searching.
+*/
+struct Catalog_Entry
+{
+    Maturity_Tree::Node* maturity_position; //nullptr for a lot whose maturity date can't be read
+    Group_Tree::Node* group_position;
+};
+
+/*
+    This structure is the result of checking the catalog against the index and the customers' pledged lots.
+    Each check is reported on its own, along with the lots left out of the maturity index. The lookup checks
+    compare what each lookup returns for the probed lots' fields with a linear scan over every lot.
+*/
+struct Catalog_Sync_Report
+{
+    bool records_match = true; //the catalog holds exactly the free and pledged lots
+    bool indexes_match = true; //every index holds every record under the record's current fields
+    bool trees_valid = true; //the ordered indexes pass their red-black checks
+    bool ticket_lookup = true; //find_ticket finds each probed ticket, and nothing for a ticket no lot has
+    bool cusip_lookup = true; //collect_cusip returns exactly the lots of each probed CUSIP
+    bool maturity_lookup = true; //maturing_between returns exactly the dated lots in range, earliest first
+    bool group_lookup = true; //find_group returns exactly the lots of each probed group
+    int lot_count = 0;
+    int undated_lots = 0; //lots whose maturity date can't be read, kept out of the maturity index
+    int lookups_checked = 0; //lots probed by the lookup checks
+
+    //true when every lookup matched the linear scan
+    bool lookups_match() const;
+
+    //true when every check passed - undated lots are reported, not failed
+    bool in_sync() const;
+};
+
+
+/* --------------------------------------------------Security Catalog Class-----------------------------------------------------*/
+
+/*
+    The security catalog holds every security lot the bank currently has - the free securities in the security index
+    and the securities pledged to customers - and indexes them on their other fields: a hash index on ticket, a hash
+    multi-index on CUSIP, and ordered indexes on maturity date and group. Records written to the change vectors are
+    not lots and are never in the catalog.
+
+    The catalog is rebuilt once a file is loaded. After that it is kept in sync by the state journal, which registers
+    and unregisters records as pledging runs add them to the index, pledge and release them and roll them back.
+    A security taken out of the index stays registered - it is either pledged or put back by the same run.
+*/
+class Security_Catalog
+{
+public:
+
+    //the catalog holds handles to the nodes of its own indexes, so it can't be copied
+    Security_Catalog() = default;
+    Security_Catalog(const Security_Catalog&) = delete;
+    Security_Catalog& operator=(const Security_Catalog&) = delete;
+
+    /*-------------------------------------------- Security Catalog Update Functions -------------------------------------------*/
+
+    /*
+        Function adds the security record to every index. Nothing is done if the record is already registered.
+        O(logN)
+    */
+    void register_record(RBT_Security_Node* record);
+
+    /*
+        Function takes the security record out of every index. Nothing is done if the record is not registered.
+        O(logN) for the ordered indexes, plus the lots sharing its ticket and CUSIP for the hash indexes.
+    */
+    void unregister_record(RBT_Security_Node* record);
+
+    /*
+        Function drops every record from the catalog and registers the securities in the index and the
+        securities pledged to each customer. O(NlogN)
+    */
+    void rebuild(Security_Index& index, Customer_Store& customers);
+
+    //drops every record from the catalog - the records themselves are untouched
+    void clear();
+
+    /*-------------------------------------------- Security Catalog Lookup Functions -------------------------------------------*/
+
+    /*
+        Function returns the lot with the passed in ticket, or nullptr if there is none. O(1)
+    */
+    RBT_Security_Node* find_ticket(int ticket) const;
+
+    /*
+        Function returns every lot of the passed in CUSIP. O(1) plus the lots returned.
+    */
+    vector<RBT_Security_Node*> find_cusip(const string& cusip) const;
+
+    /*
+        Function adds every lot of the passed in CUSIP to the end of the vector passed in, so one vector can be
+        reused across lookups. O(1) plus the lots added.
+    */
+    void collect_cusip(const string& cusip, vector<RBT_Security_Node*>& lots) const;
+
+    /*
+        Function returns every lot maturing between the two dates (inclusive), earliest first. Dates are
+        passed as yyyymmdd (see maturity_key). Lots whose maturity can't be read are never returned.
+        O(logN) plus the lots returned.
+    */
+    vector<RBT_Security_Node*> maturing_between(int first_date, int last_date) const;
+
+    /*
+        Function returns every lot in the passed in group. O(logN) plus the lots returned.
+    */
+    vector<RBT_Security_Node*> find_group(const string& group) const;
+
+    //number of lots in the catalog
+    int lot_count() const;
+
+    //number of lots in the catalog whose maturity date can't be read - they are not in the maturity index
+    int undated_count() const;
+
+    /*
+        Function checks that the catalog holds exactly the securities in the index and the securities pledged
+        to each customer, that each index holds every record and that the lookups match a linear scan, and
+        counts the undated lots. O(NlogN)
+    */
+    Catalog_Sync_Report in_sync(Security_Index& index, Customer_Store& customers) const;
+
+    /*
+        Function converts a maturity date in the security file format (month/day/year) to yyyymmdd, so dates
+        compare as integers. Returns UNDATED_MATURITY if the date cannot be read.
+    */
+    static int maturity_key(const string& maturity);
+
+private:
+
+    /*
+        Function looks up the fields of up to CATALOG_LOOKUP_PROBES lots spread through the lots passed in, in
+        every index, and checks each result against a linear scan of the lots. O(N) per lot probed.
+    */
+    void check_lookups(const vector<RBT_Security_Node*>& lots, Catalog_Sync_Report& report) const;
+
+    unordered_map<RBT_Security_Node*, Catalog_Entry> records;
+    unordered_multimap<int, RBT_Security_Node*> by_ticket;
+    unordered_multimap<string, RBT_Security_Node*> by_cusip;
+    Maturity_Tree by_maturity;
+    Group_Tree by_group;
+};
+
+
+#endif
@@ -0,0 +1,157 @@
+#include "security_index.h"
+#include "bplus_tree.h"
+
+using namespace std;
+
+
+/*----------------------------------------------- Security Index Backend Selection ---------------------------------------------*/
+
+Security_Index* create_security_index(const string& backend)
+{
+    if(backend == "rbt")
+    {
+        return new RBT_Security_Index;
+    }
+    if(backend == "bplus")
+    {
+        return new BPlus_Tree;
+    }
+    return nullptr;
+}
+
+
+/*------------------------------------------ Red-Black Tree Security Index Functions -------------------------------------------*/
+
+string RBT_Security_Index::backend_name()
+{
+    return "Red-Black Tree";
+}
+
+void RBT_Security_Index::add_security(RBT_Security_Node* security)
+{
+    tree.RBT_add_node(security);
+}
+
+void RBT_Security_Index::bulk_add(const vector<RBT_Security_Node*>& securities)
+{
+    tree.RBT_bulk_add(securities);
+}
+
+RBT_Security_Node* RBT_Security_Index::take_security(Money min, Money max)
+{
+    RBT_Node* cursor = tree.get_root();
+
+    while (cursor != nullptr)
+    {
+        //check to see if current security value is within range, if so, take it out of the tree
+        if (cursor->key.market_value >= min && cursor->key.market_value <= max)
+        {
+            return tree.RBT_remove_node(cursor);
+        }
+        else if (min < cursor->key.market_value)
+        {
+            cursor = cursor->left();
+        }
+        else
+        {
+            cursor = cursor->right();
+        }
+    }
+    return nullptr; //if an appropriate security is not found, return null
+}
+
+bool RBT_Security_Index::remove_security(RBT_Security_Node* security)
+{
+    RBT_Node* node = tree.find_record(security);
+    if(node == nullptr)
+    {
+        return false;
+    }
+    tree.RBT_remove_node(node);
+    return true;
+}
+
+RBT_Security_Node* RBT_Security_Index::take_smallest()
+{
+    if(tree.get_minimum() == nullptr)
+    {
+        return nullptr;
+    }
+    RBT_Security_Node* security;
+    tree.erase(tree.begin(), security);
+    return security;
+}
+
+RBT_Security_Node* RBT_Security_Index::take_largest()
+{
+    if(tree.get_maximum() == nullptr)
+    {
+        return nullptr;
+    }
+    RBT_Security_Node* security;
+    tree.erase(--tree.end(), security);
+    return security;
+}
+
+RBT_Security_Node* RBT_Security_Index::erase(int ticket, Money market_value)
+{
+    return tree.erase(ticket, market_value);
+}
+
+void RBT_Security_Index::release_all()
+{
+    //the tree's own node pool is reset, the records stay with the caller
+    tree.release_nodes();
+}
+
+RBT_Security_Node* RBT_Security_Index::smallest_security()
+{
+    RBT_Node* smallest = tree.get_minimum();
+    return smallest == nullptr ? nullptr : smallest->value;
+}
+
+RBT_Security_Node* RBT_Security_Index::largest_security()
+{
+    RBT_Node* largest = tree.get_maximum();
+    return largest == nullptr ? nullptr : largest->value;
+}
+
+int RBT_Security_Index::security_count()
+{
+    return tree.count_nodes(tree.get_root());
+}
+
+Money RBT_Security_Index::market_value_total()
+{
+    return tree.sum_nodes(tree.get_root());
+}
+
+void RBT_Security_Index::collect_securities(vector<RBT_Security_Node*>& securities)
+{
+    securities.reserve(securities.size() + tree.count_nodes(tree.get_root()));
+    for(RBT::iterator node = tree.begin(); node != tree.end(); ++node)
+    {
+        securities.push_back(node->value);
+    }
+}
+
+size_t RBT_Security_Index::memory_footprint()
+{
+    return tree.memory_footprint();
+}
+
+void RBT_Security_Index::print_index()
+{
+    tree.print_RBT_tree(tree.get_root());
+}
+
+void RBT_Security_Index::run_tests()
+{
+    tree.run_RBT_tests();
+}
+
+void RBT_Security_Index::print_node_usage()
+{
+    cout << "Tree Nodes Live: " << tree.node_pool().live_count()
+         << "  Peak: " << tree.node_pool().peak_count() << endl;
+}
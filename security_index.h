@@ -0,0 +1,181 @@
+#ifndef SECURITY_INDEX_H
+#define SECURITY_INDEX_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "red_black_tree.h"
+
+
+using namespace std;
+
+
+/* ------------------------------------------------Security Index Interface-----------------------------------------------------*/
+
+/*
+    The security index holds every security that is free to be pledged, ordered on market value and then ticket.
+    The pledging functions only work through this interface, so the structure behind it can be swapped at startup.
+    Securities are handed in and out as records - the index takes ownership of a record when it is added and gives
+    ownership back to the caller when the record is taken out. The red-black tree is the reference implementation.
+*/
+class Security_Index
+{
+public:
+
+    virtual ~Security_Index() {}
+
+    //name of the structure behind the index, shown in the test output
+    virtual string backend_name() = 0;
+
+    /*---------------------------------------- Security Index Add and Remove Functions -----------------------------------------*/
+
+    /*
+        Function adds a single security to the index. The index takes ownership of the record.
+    */
+    virtual void add_security(RBT_Security_Node* security) = 0;
+
+    /*
+        Function adds many securities to the index at once, building from sorted input where it pays off.
+        The index takes ownership of the records.
+    */
+    virtual void bulk_add(const vector<RBT_Security_Node*>& securities) = 0;
+
+    /*
+        Function searches for a security with a market value between min and max (inclusive). If one is found
+        it is removed from the index and its record handed back to the caller, otherwise nullptr is returned.
+        Which security in the range is taken depends on the structure behind the index.
+    */
+    virtual RBT_Security_Node* take_security(Money min, Money max) = 0;
+
+    /*
+        Function removes the passed in security record from the index. The caller takes back ownership of
+        the record. Returns false if the record is not in the index.
+    */
+    virtual bool remove_security(RBT_Security_Node* security) = 0;
+
+    /*
+        Functions remove the security with the smallest / largest market value and hand its record back to the
+        caller. Returns nullptr if the index is empty.
+    */
+    virtual RBT_Security_Node* take_smallest() = 0;
+
+    virtual RBT_Security_Node* take_largest() = 0;
+
+    /*
+        Function removes the security with the passed in ticket and market value from the index and hands
+        its record back to the caller. Returns nullptr if the security is not in the index.
+    */
+    virtual RBT_Security_Node* erase(int ticket, Money market_value) = 0;
+
+    /*
+        Function is called when a new security file is loaded. Every entry is dropped without deleting
+        the records, which are released along with the security record pool by the caller.
+    */
+    virtual void release_all() = 0;
+
+    /*-------------------------------------------- Security Index Lookup Functions ---------------------------------------------*/
+
+    /*
+        Functions return the security with the smallest / largest market value without removing it.
+        Returns nullptr if the index is empty.
+    */
+    virtual RBT_Security_Node* smallest_security() = 0;
+
+    virtual RBT_Security_Node* largest_security() = 0;
+
+    //number of securities in the index
+    virtual int security_count() = 0;
+
+    //market value total of every security in the index
+    virtual Money market_value_total() = 0;
+
+    /*
+        Function appends every security record in the index to the vector, in key order (market value, then
+        ticket). The records stay in the index. O(N)
+    */
+    virtual void collect_securities(vector<RBT_Security_Node*>& securities) = 0;
+
+    /*
+        Function returns the number of bytes held by the index - its nodes and the security records
+        it owns, including their string buffers.
+    */
+    virtual size_t memory_footprint() = 0;
+
+    /*--------------------------------------------- Security Index Test Functions ----------------------------------------------*/
+
+    /*
+        Function prints the structure behind the index.
+    */
+    virtual void print_index() = 0;
+
+    /*
+        Function checks the invariants of the structure behind the index and prints the results.
+    */
+    virtual void run_tests() = 0;
+
+    /*
+        Function prints how many index nodes are allocated (live and peak).
+    */
+    virtual void print_node_usage() = 0;
+};
+
+/*
+    Function returns a new, empty security index of the requested backend - "rbt" for the red-black tree
+    or "bplus" for the B+ tree. Returns nullptr if the backend name is not recognized.
+*/
+Security_Index* create_security_index(const string& backend);
+
+
+/* -------------------------------------------Red-Black Tree Security Index Class-----------------------------------------------*/
+
+/*
+    Security index backed by the red-black tree. Securities are searched for with a descent from the root,
+    returning the first security on the path that is within the range.
+*/
+class RBT_Security_Index : public Security_Index
+{
+public:
+
+    string backend_name();
+
+    void add_security(RBT_Security_Node* security);
+
+    void bulk_add(const vector<RBT_Security_Node*>& securities);
+
+    RBT_Security_Node* take_security(Money min, Money max);
+
+    bool remove_security(RBT_Security_Node* security);
+
+    RBT_Security_Node* take_smallest();
+
+    RBT_Security_Node* take_largest();
+
+    RBT_Security_Node* erase(int ticket, Money market_value);
+
+    void release_all();
+
+    RBT_Security_Node* smallest_security();
+
+    RBT_Security_Node* largest_security();
+
+    int security_count();
+
+    Money market_value_total();
+
+    void collect_securities(vector<RBT_Security_Node*>& securities);
+
+    size_t memory_footprint();
+
+    void print_index();
+
+    void run_tests();
+
+    void print_node_usage();
+
+private:
+
+    RBT tree;
+};
+
+
+#endif
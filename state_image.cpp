@@ -0,0 +1,449 @@
+#include "state_image.h"
+#include "supporting_func_structs.h"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+using namespace std;
+
+static const char IMAGE_MAGIC[8] = {'S', 'E', 'C', 'I', 'M', 'A', 'G', 'E'};
+
+
+/*------------------------------------------------- State Image Writer Functions -----------------------------------------------*/
+
+/*
+    This structure gathers the sections of an image while it is being saved.
+*/
+struct Image_Writer
+{
+    vector<Image_Security> securities;
+    vector<Image_Account> accounts;
+    vector<Image_Customer> customers;
+    string text;
+
+    Image_Text add_text(const string& value)
+    {
+        Image_Text added = {text.size(), uint32_t(value.size()), 0};
+        text += value;
+        return added;
+    }
+
+    void add_security(const RBT_Security_Node* security)
+    {
+        Image_Security record;
+        record.pledge_amount = security->pledge_amount.in_cents();
+        record.par_value = security->par_value.in_cents();
+        record.market_value = security->market_value.in_cents();
+        record.ticket = security->ticket;
+        record.pledge_id = security->pledge_id;
+        record.portfolio = add_text(security->portfolio);
+        record.cusip = add_text(security->cusip);
+        record.maturity = add_text(security->maturity);
+        record.pledge_description = add_text(security->pledge_description);
+        record.group = add_text(security->group);
+        record.security_description = add_text(security->security_description);
+        record.change_status = add_text(security->change_status);
+        securities.push_back(record);
+    }
+};
+
+//sections start on an 8 byte boundary so their records can be read in place
+static uint64_t aligned(uint64_t offset)
+{
+    return (offset + 7) & ~uint64_t(7);
+}
+
+/*
+    This structure computes State_Image::checksum over a block passed in pieces. Every piece but the last must
+    be a multiple of 8 bytes long.
+*/
+struct Image_Checksum
+{
+    uint64_t hash = 14695981039346656037ULL;
+    uint64_t length = 0;
+
+    //FNV-1a over 8 byte words, then the bytes left over
+    void add(const char* data, size_t bytes)
+    {
+        size_t i = 0;
+        for(; i + 8 <= bytes; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, data + i, sizeof(word));
+            hash = (hash ^ word) * 1099511628211ULL;
+        }
+        for(; i < bytes; i++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+        }
+        length += bytes;
+    }
+
+    uint64_t value() const
+    {
+        return hash ^ length;
+    }
+};
+
+//writes a section of the image followed by the zero bytes that bring it to an 8 byte boundary
+static void write_section(ofstream& image_file, Image_Checksum& body_checksum, const void* records, size_t bytes)
+{
+    static const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    const char* section = static_cast<const char*>(records);
+    size_t whole_words = bytes - bytes % 8;
+    image_file.write(section, bytes);
+    image_file.write(padding, aligned(bytes) - bytes);
+    body_checksum.add(section, whole_words);
+    if(whole_words < bytes)
+    {   //the last word of the section is checksummed with its padding, as it sits in the file
+        char last_word[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        memcpy(last_word, section + whole_words, bytes - whole_words);
+        body_checksum.add(last_word, sizeof(last_word));
+    }
+}
+
+/*
+    Function fills in the size and checksum of a source csv file. Returns false if the file can't be read.
+*/
+static bool describe_source(const string& file_name, Image_Source& source)
+{
+    Mapped_File file;
+    if(!file.open(file_name))
+    {
+        return false;
+    }
+    source.size = file.size();
+    source.checksum = State_Image::checksum(file.data(), file.size());
+    return true;
+}
+
+bool State_Image::save(const string& image_name, const string& customer_source, const string& security_source,
+                       Security_Index& index, Customer_Store& customers, vector<RBT_Security_Node*>& removals)
+{
+    Image_Header header;
+    memset(&header, 0, sizeof(header));
+    if(!describe_source(customer_source, header.customer_source) || !describe_source(security_source, header.security_source))
+    {
+        return false;
+    }
+
+    //every record is counted first, so the sections are sized once rather than grown record by record
+    size_t pledged_count = 0;
+    size_t account_count = 0;
+    for (size_t i = 0; i < customers.size(); i++)
+    {
+        pledged_count += customers.at(i)->pledged_to_customer.size();
+        account_count += customers.at(i)->accounts.size();
+    }
+    Image_Writer writer;
+    writer.securities.reserve(index.security_count() + pledged_count + removals.size());
+    writer.accounts.reserve(account_count);
+    writer.customers.reserve(customers.size());
+    header.customer_source.name = writer.add_text(customer_source);
+    header.security_source.name = writer.add_text(security_source);
+
+    //free securities come out of the index in key order, so the image can be searched in place
+    vector<RBT_Security_Node*> free_securities;
+    index.collect_securities(free_securities);
+    for(size_t i = 0; i < free_securities.size(); i++)
+    {
+        writer.add_security(free_securities.at(i));
+    }
+    header.free_count = free_securities.size();
+
+    for (size_t customer_position = 0; customer_position < customers.size(); customer_position++)
+    {
+        Customer_Node* customer = customers.at(customer_position);
+        Image_Customer record;
+        record.tax_ID = customer->tax_ID;
+        record.pledge_code = customer->pledge_code;
+        record.account_count = customer->accounts.size();
+        record.first_account = writer.accounts.size();
+        record.first_pledged = writer.securities.size();
+        record.pledged_count = customer->pledged_to_customer.size();
+        record.name1 = writer.add_text(customer->name1);
+        record.name2 = writer.add_text(customer->name2);
+        for(size_t i = 0; i < customer->accounts.size(); i++)
+        {
+            const Account_Node& account = customer->accounts.at(i);
+            Image_Account account_record;
+            account_record.current_balance = account.current_balance.in_cents();
+            account_record.account_number = account.account_number;
+            account_record.unused = 0;
+            account_record.interest_rate = writer.add_text(account.interest_rate);
+            account_record.account_type = writer.add_text(account.account_type);
+            account_record.class_code_description = writer.add_text(account.class_code_description);
+            writer.accounts.push_back(account_record);
+        }
+        for(size_t i = 0; i < customer->pledged_to_customer.size(); i++)
+        {
+            writer.add_security(customer->pledged_to_customer.at(i));
+        }
+        writer.customers.push_back(record);
+    }
+
+    for(size_t i = 0; i < removals.size(); i++)
+    {
+        writer.add_security(removals.at(i));
+    }
+    header.removal_count = removals.size();
+
+    //lay the sections out after the header - each is padded to the next one as it is written and checksummed
+    uint64_t offset = aligned(sizeof(Image_Header));
+    header.securities = {offset, writer.securities.size()};
+    offset = aligned(offset + writer.securities.size() * sizeof(Image_Security));
+    header.accounts = {offset, writer.accounts.size()};
+    offset = aligned(offset + writer.accounts.size() * sizeof(Image_Account));
+    header.customers = {offset, writer.customers.size()};
+    offset = aligned(offset + writer.customers.size() * sizeof(Image_Customer));
+    header.text = {offset, writer.text.size()};
+    offset = aligned(offset + writer.text.size());
+
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.schema_version = STATE_IMAGE_SCHEMA;
+    header.header_size = sizeof(Image_Header);
+    header.image_size = offset;
+
+    string temporary_name = image_name + ".tmp";
+    {
+        ofstream image_file(temporary_name, ios::out | ios::binary | ios::trunc);
+        Image_Checksum body_checksum;
+        image_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        write_section(image_file, body_checksum, writer.securities.data(), writer.securities.size() * sizeof(Image_Security));
+        write_section(image_file, body_checksum, writer.accounts.data(), writer.accounts.size() * sizeof(Image_Account));
+        write_section(image_file, body_checksum, writer.customers.data(), writer.customers.size() * sizeof(Image_Customer));
+        write_section(image_file, body_checksum, writer.text.data(), writer.text.size());
+        //the checksum is only known once the body is written, so the header is written again with it
+        header.checksum = body_checksum.value();
+        image_file.seekp(0);
+        image_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        image_file.flush();
+        if(!image_file.good())
+        {
+            image_file.close();
+            remove(temporary_name.c_str());
+            return false;
+        }
+    }
+    return rename(temporary_name.c_str(), image_name.c_str()) == 0;
+}
+
+
+/*------------------------------------------------- State Image Reader Functions -----------------------------------------------*/
+
+bool State_Image::open(const string& image_name, bool copy_on_write)
+{
+    close();
+    if(!image.open(image_name, copy_on_write) || image.size() < sizeof(Image_Header))
+    {
+        close();
+        return false;
+    }
+    const Image_Header* candidate = reinterpret_cast<const Image_Header*>(image.data());
+    uint64_t size = image.size();
+
+    //every section has to lie inside the image before anything in it is read
+    bool sections_fit = candidate->securities.offset <= size && candidate->accounts.offset <= size
+        && candidate->customers.offset <= size && candidate->text.offset <= size
+        && candidate->securities.count <= (size - candidate->securities.offset) / sizeof(Image_Security)
+        && candidate->accounts.count <= (size - candidate->accounts.offset) / sizeof(Image_Account)
+        && candidate->customers.count <= (size - candidate->customers.offset) / sizeof(Image_Customer)
+        && candidate->text.count <= size - candidate->text.offset
+        && candidate->free_count <= candidate->securities.count
+        && candidate->removal_count <= candidate->securities.count - candidate->free_count;
+    if(memcmp(candidate->magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 || candidate->schema_version != STATE_IMAGE_SCHEMA
+       || candidate->header_size != sizeof(Image_Header) || candidate->image_size != size || !sections_fit
+       || candidate->checksum != checksum(image.data() + sizeof(Image_Header), size - sizeof(Image_Header)))
+    {
+        close();
+        return false;
+    }
+    header = candidate;
+    return true;
+}
+
+void State_Image::close()
+{
+    image.close();
+    header = nullptr;
+}
+
+bool State_Image::is_open() const
+{
+    return header != nullptr;
+}
+
+bool State_Image::sources_match() const
+{
+    if(header == nullptr)
+    {
+        return false;
+    }
+    Image_Source customer_file;
+    Image_Source security_file;
+    return describe_source(customer_source(), customer_file) && describe_source(security_source(), security_file)
+           && customer_file.size == header->customer_source.size && customer_file.checksum == header->customer_source.checksum
+           && security_file.size == header->security_source.size && security_file.checksum == header->security_source.checksum;
+}
+
+/*
+    Function builds a security record from its image record.
+*/
+static RBT_Security_Node* restore_security(const State_Image& image, const Image_Security& record)
+{
+    RBT_Security_Node* security = new RBT_Security_Node;
+    security->portfolio = image.text(record.portfolio);
+    security->cusip = image.text(record.cusip);
+    security->ticket = record.ticket;
+    security->maturity = image.text(record.maturity);
+    security->pledge_id = record.pledge_id;
+    security->pledge_description = image.text(record.pledge_description);
+    security->pledge_amount = Money::from_cents(record.pledge_amount);
+    security->par_value = Money::from_cents(record.par_value);
+    security->market_value = Money::from_cents(record.market_value);
+    security->group = image.text(record.group);
+    security->security_description = image.text(record.security_description);
+    security->change_status = image.text(record.change_status);
+    return security;
+}
+
+void State_Image::restore(Security_Index& index, Customer_Store& customers, vector<RBT_Security_Node*>& removals) const
+{
+    if(header == nullptr)
+    {
+        return;
+    }
+    const Image_Security* security_records = securities();
+    vector<RBT_Security_Node*> free_securities;
+    free_securities.reserve(header->free_count);
+    for(size_t i = 0; i < header->free_count; i++)
+    {
+        free_securities.push_back(restore_security(*this, security_records[i]));
+    }
+    index.bulk_add(free_securities);
+
+    const Image_Customer* customer_records = this->customers();
+    const Image_Account* account_records = accounts();
+    customers.reserve(header->customers.count);
+    for(size_t i = 0; i < header->customers.count; i++)
+    {
+        const Image_Customer& record = customer_records[i];
+        Customer_Node* customer = new Customer_Node;
+        customer->pledge_code = record.pledge_code;
+        customer->tax_ID = record.tax_ID;
+        customer->name1 = text(record.name1);
+        customer->name2 = text(record.name2);
+        for(size_t j = 0; j < record.account_count && record.first_account + j < header->accounts.count; j++)
+        {
+            const Image_Account& account_record = account_records[record.first_account + j];
+            Account_Node account;
+            account.account_number = account_record.account_number;
+            account.interest_rate = text(account_record.interest_rate);
+            account.account_type = text(account_record.account_type);
+            account.class_code_description = text(account_record.class_code_description);
+            account.current_balance = Money::from_cents(account_record.current_balance);
+            customer->add_account(account);
+        }
+        for(size_t j = 0; j < record.pledged_count && record.first_pledged + j < header->securities.count; j++)
+        {
+            customer->pledge_security(restore_security(*this, security_records[record.first_pledged + j]));
+        }
+        //customers were saved in pledge code order, so each one is added at the end of the store, which sums
+        //its totals into the store's columns
+        customers.insert(customer);
+    }
+
+    size_t first_removal = header->securities.count - header->removal_count;
+    for(size_t i = first_removal; i < header->securities.count; i++)
+    {
+        removals.push_back(restore_security(*this, security_records[i]));
+    }
+}
+
+
+/*------------------------------------------------- State Image Lookup Functions -----------------------------------------------*/
+
+const Image_Security* State_Image::securities() const
+{
+    return reinterpret_cast<const Image_Security*>(image.data() + header->securities.offset);
+}
+
+const Image_Customer* State_Image::customers() const
+{
+    return reinterpret_cast<const Image_Customer*>(image.data() + header->customers.offset);
+}
+
+const Image_Account* State_Image::accounts() const
+{
+    return reinterpret_cast<const Image_Account*>(image.data() + header->accounts.offset);
+}
+
+Image_Security* State_Image::writable_securities()
+{
+    char* data = image.writable_data();
+    return (data != nullptr && header != nullptr) ? reinterpret_cast<Image_Security*>(data + header->securities.offset) : nullptr;
+}
+
+size_t State_Image::security_count() const
+{
+    return (header != nullptr) ? header->securities.count : 0;
+}
+
+size_t State_Image::free_count() const
+{
+    return (header != nullptr) ? header->free_count : 0;
+}
+
+size_t State_Image::customer_count() const
+{
+    return (header != nullptr) ? header->customers.count : 0;
+}
+
+string_view State_Image::text(const Image_Text& text) const
+{
+    //a string running past the text section is cut off at its end
+    if(text.offset >= header->text.count)
+    {
+        return string_view();
+    }
+    uint64_t length = min<uint64_t>(text.length, header->text.count - text.offset);
+    return string_view(image.data() + header->text.offset + text.offset, length);
+}
+
+string State_Image::customer_source() const
+{
+    return (header != nullptr) ? string(text(header->customer_source.name)) : "";
+}
+
+string State_Image::security_source() const
+{
+    return (header != nullptr) ? string(text(header->security_source.name)) : "";
+}
+
+size_t State_Image::lower_bound(Money market_value) const
+{
+    const Image_Security* security_records = securities();
+    size_t low = 0;
+    size_t high = free_count();
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if(security_records[middle].market_value < market_value.in_cents())
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+uint64_t State_Image::checksum(const char* data, size_t length)
+{
+    Image_Checksum block_checksum;
+    block_checksum.add(data, length);
+    return block_checksum.value();
+}
@@ -0,0 +1,201 @@
+#ifndef STATE_IMAGE_H
+#define STATE_IMAGE_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "security_index.h"
+#include "csv_reader.h"
+#include "customer_store.h"
+
+
+using namespace std;
+#define STATE_IMAGE_FILE "security_state.img" //image saved after each security import and restored at startup
+#define STATE_IMAGE_SCHEMA 1 //bumped whenever the layout of the image changes - older images are then ignored
+
+
+/*------------------------------------------------- State Image Structures -----------------------------------------------------*/
+
+/*
+    The image is one flat block: a header followed by sections of fixed size records. Records never hold pointers -
+    a link is the index of a record in its section, and text is an offset and length into the text section - so
+    the block means the same thing wherever it is mapped and can be used in place.
+*/
+
+//a string in the text section
+struct Image_Text
+{
+    uint64_t offset;
+    uint32_t length;
+    uint32_t unused;
+};
+
+struct Image_Security
+{
+    int64_t pledge_amount; //amounts are in cents
+    int64_t par_value;
+    int64_t market_value;
+    int32_t ticket;
+    int32_t pledge_id;
+    Image_Text portfolio;
+    Image_Text cusip;
+    Image_Text maturity;
+    Image_Text pledge_description;
+    Image_Text group;
+    Image_Text security_description;
+    Image_Text change_status;
+};
+
+struct Image_Account
+{
+    int64_t current_balance;
+    int32_t account_number;
+    int32_t unused;
+    Image_Text interest_rate;
+    Image_Text account_type;
+    Image_Text class_code_description;
+};
+
+/*
+    A customer's accounts are a run of the account section and the securities pledged to it a run of the
+    security section, each given as the index of the first record and the number of records.
+*/
+struct Image_Customer
+{
+    int64_t tax_ID;
+    int32_t pledge_code;
+    uint32_t account_count;
+    uint64_t first_account;
+    uint64_t first_pledged;
+    uint64_t pledged_count;
+    Image_Text name1;
+    Image_Text name2;
+};
+
+struct Image_Section
+{
+    uint64_t offset; //from the start of the image
+    uint64_t count; //records, or bytes for the text section
+};
+
+//a csv file the image was built from - the image is only restored while the file is unchanged
+struct Image_Source
+{
+    uint64_t size;
+    uint64_t checksum;
+    Image_Text name;
+};
+
+/*
+    The security section holds the free securities first, in key order (market value, then ticket), then the
+    securities pledged to each customer, then the pledge removal records.
+*/
+struct Image_Header
+{
+    char magic[8];
+    uint32_t schema_version;
+    uint32_t header_size;
+    uint64_t image_size;
+    uint64_t checksum; //of everything after the header
+    Image_Source customer_source;
+    Image_Source security_source;
+    Image_Section securities;
+    Image_Section accounts;
+    Image_Section customers;
+    Image_Section text;
+    uint64_t free_count;
+    uint64_t removal_count;
+};
+
+
+/* ------------------------------------------------------State Image Class------------------------------------------------------*/
+
+/*
+    The state image holds the loaded state - the free securities, the customers with their accounts and pledged
+    securities, and the pledge removals found while loading - saved once the csv files are imported, so the next
+    session can map it instead of parsing them again.
+
+    An image is only trusted if its schema version and checksum are right and both csv files it names still have
+    the size and checksum they had when it was saved; otherwise the files have to be imported again. It can be
+    mapped read-only, or copy-on-write so its records can be changed in memory without touching the file.
+*/
+class State_Image
+{
+public:
+
+    /*
+        Function writes the loaded state to the named image. The image is written to a temporary file that then
+        replaces the old one, so a crash while saving leaves the last image as it was. Returns false if the
+        image or either source file could not be written / read.
+    */
+    static bool save(const string& image_name, const string& customer_source, const string& security_source,
+                     Security_Index& index, Customer_Store& customers, vector<RBT_Security_Node*>& removals);
+
+    /*
+        Function maps the named image and checks its header, sections and checksum. Returns false, with the image
+        closed, if it is missing, from another schema version or damaged.
+    */
+    bool open(const string& image_name, bool copy_on_write = false);
+
+    void close();
+
+    bool is_open() const;
+
+    /*
+        Function checks that both csv files the image was built from still have the size and checksum they had
+        when it was saved.
+    */
+    bool sources_match() const;
+
+    /*
+        Function builds the loaded state from the image: the free securities are bulk added to the index (which
+        should be empty), the customers are added to the store (which should be empty) and the pledge removal records to removals.
+    */
+    void restore(Security_Index& index, Customer_Store& customers, vector<RBT_Security_Node*>& removals) const;
+
+    /*---------------------------------------------- State Image Lookup Functions ----------------------------------------------*/
+
+    //the records of each section, used in place
+    const Image_Security* securities() const;
+
+    const Image_Customer* customers() const;
+
+    const Image_Account* accounts() const;
+
+    //security records of a copy-on-write image, nullptr if the image was opened read-only
+    Image_Security* writable_securities();
+
+    size_t security_count() const;
+
+    size_t free_count() const;
+
+    size_t customer_count() const;
+
+    //text of a string in the image
+    string_view text(const Image_Text& text) const;
+
+    string customer_source() const;
+
+    string security_source() const;
+
+    /*
+        Function returns the index of the first free security with a market value not below the value passed
+        in, or free_count() if there is none. O(logN)
+    */
+    size_t lower_bound(Money market_value) const;
+
+    /*
+        Function returns a checksum of a block of bytes, used for the image and the csv files it names.
+    */
+    static uint64_t checksum(const char* data, size_t length);
+
+private:
+
+    Mapped_File image;
+    const Image_Header* header = nullptr;
+};
+
+
+#endif
@@ -0,0 +1,295 @@
+#include "state_journal.h"
+#include "supporting_func_structs.h"
+
+using namespace std;
+
+
+/*---------------------------------------------------- State Journal Constructor -----------------------------------------------*/
+
+State_Journal::State_Journal(Security_Index& index, Security_Catalog* catalog) : index(index), catalog(catalog) {}
+
+
+/*------------------------------------------------ State Journal Snapshot Functions --------------------------------------------*/
+
+size_t State_Journal::snapshot()
+{
+    return entries.size();
+}
+
+void State_Journal::rollback(size_t snapshot)
+{
+    while(entries.size() > snapshot)
+    {
+        Journal_Entry entry = entries.back();
+        entries.pop_back();
+        undo(entry);
+    }
+}
+
+void State_Journal::commit()
+{
+    entries.clear();
+    saved_fields.clear();
+    saved_pledges.clear();
+}
+
+size_t State_Journal::entry_count()
+{
+    return entries.size();
+}
+
+
+/*-------------------------------------------- State Journal Customer and Record Functions -------------------------------------*/
+
+RBT_Security_Node* State_Journal::copy_record(RBT_Security_Node* record)
+{
+    RBT_Security_Node* copy = RBT::RBT_copy_node(record);
+    add_entry(JOURNAL_RECORD_COPY, copy);
+    return copy;
+}
+
+void State_Journal::set_pledge(RBT_Security_Node* record, int pledge_id, const string& pledge_description)
+{
+    save_fields(record);
+    record->pledge_id = pledge_id;
+    record->pledge_description = pledge_description;
+}
+
+void State_Journal::set_change_status(RBT_Security_Node* record, const string& change_status)
+{
+    save_fields(record);
+    record->change_status = change_status;
+}
+
+void State_Journal::pledge(Customer_Node* customer, RBT_Security_Node* record)
+{
+    customer->pledge_security(record);
+    catalog_register(record);
+    add_entry(JOURNAL_CUSTOMER_PLEDGE, record, customer);
+}
+
+void State_Journal::release_pledges(Customer_Node* customer)
+{
+    //released records are no longer lots, the caller puts copies of them back in the index
+    for(size_t i = 0; i < customer->pledged_to_customer.size(); i++)
+    {
+        catalog_unregister(customer->pledged_to_customer.at(i));
+    }
+    //the vector is moved onto the journal as a whole, so releasing a customer's pledges copies no records
+    saved_pledges.push_back(customer->release_pledged());
+    add_entry(JOURNAL_CUSTOMER_RELEASE, nullptr, customer);
+}
+
+void State_Journal::push_change(vector<RBT_Security_Node*>& changes, RBT_Security_Node* record)
+{
+    changes.push_back(record);
+    add_entry(JOURNAL_CHANGE_PUSH, record, nullptr, &changes);
+}
+
+
+/*----------------------------------------------- State Journal Security Index Functions ---------------------------------------*/
+
+string State_Journal::backend_name()
+{
+    return index.backend_name();
+}
+
+void State_Journal::add_security(RBT_Security_Node* security)
+{
+    index.add_security(security);
+    catalog_register(security);
+    add_entry(JOURNAL_INDEX_ADD, security);
+}
+
+void State_Journal::bulk_add(const vector<RBT_Security_Node*>& securities)
+{
+    index.bulk_add(securities);
+    for(size_t i = 0; i < securities.size(); i++)
+    {
+        catalog_register(securities.at(i));
+        add_entry(JOURNAL_INDEX_ADD, securities.at(i));
+    }
+}
+
+RBT_Security_Node* State_Journal::take_security(Money min, Money max)
+{
+    RBT_Security_Node* security = index.take_security(min, max);
+    if(security != nullptr)
+    {
+        add_entry(JOURNAL_INDEX_REMOVE, security);
+    }
+    return security;
+}
+
+bool State_Journal::remove_security(RBT_Security_Node* security)
+{
+    if(!index.remove_security(security))
+    {
+        return false;
+    }
+    add_entry(JOURNAL_INDEX_REMOVE, security);
+    return true;
+}
+
+RBT_Security_Node* State_Journal::take_smallest()
+{
+    RBT_Security_Node* security = index.take_smallest();
+    if(security != nullptr)
+    {
+        add_entry(JOURNAL_INDEX_REMOVE, security);
+    }
+    return security;
+}
+
+RBT_Security_Node* State_Journal::take_largest()
+{
+    RBT_Security_Node* security = index.take_largest();
+    if(security != nullptr)
+    {
+        add_entry(JOURNAL_INDEX_REMOVE, security);
+    }
+    return security;
+}
+
+RBT_Security_Node* State_Journal::erase(int ticket, Money market_value)
+{
+    RBT_Security_Node* security = index.erase(ticket, market_value);
+    if(security != nullptr)
+    {
+        add_entry(JOURNAL_INDEX_REMOVE, security);
+    }
+    return security;
+}
+
+void State_Journal::release_all()
+{
+    index.release_all();
+    if(catalog != nullptr)
+    {
+        catalog->clear();
+    }
+    commit();
+}
+
+RBT_Security_Node* State_Journal::smallest_security()
+{
+    return index.smallest_security();
+}
+
+RBT_Security_Node* State_Journal::largest_security()
+{
+    return index.largest_security();
+}
+
+int State_Journal::security_count()
+{
+    return index.security_count();
+}
+
+Money State_Journal::market_value_total()
+{
+    return index.market_value_total();
+}
+
+void State_Journal::collect_securities(vector<RBT_Security_Node*>& securities)
+{
+    index.collect_securities(securities);
+}
+
+size_t State_Journal::memory_footprint()
+{
+    return index.memory_footprint();
+}
+
+void State_Journal::print_index()
+{
+    index.print_index();
+}
+
+void State_Journal::run_tests()
+{
+    index.run_tests();
+}
+
+void State_Journal::print_node_usage()
+{
+    index.print_node_usage();
+    cout << "Journal Entries: " << entries.size() << endl;
+}
+
+
+/*------------------------------------------------ State Journal Private Functions ---------------------------------------------*/
+
+void State_Journal::add_entry(Journal_Action action, RBT_Security_Node* record, Customer_Node* customer,
+                              vector<RBT_Security_Node*>* changes)
+{
+    entries.push_back({action, record, customer, changes});
+}
+
+void State_Journal::save_fields(RBT_Security_Node* record)
+{
+    saved_fields.push_back({record->pledge_id, record->pledge_description, record->change_status});
+    add_entry(JOURNAL_RECORD_FIELDS, record);
+}
+
+void State_Journal::undo(const Journal_Entry& entry)
+{
+    //each case is the exact inverse of the function that recorded the entry
+    if(entry.action == JOURNAL_INDEX_ADD)
+    {
+        index.remove_security(entry.record);
+        catalog_unregister(entry.record);
+    }
+    else if(entry.action == JOURNAL_INDEX_REMOVE)
+    {
+        index.add_security(entry.record);
+        catalog_register(entry.record);
+    }
+    else if(entry.action == JOURNAL_RECORD_COPY)
+    {
+        //every later use of the copy has already been undone, so nothing refers to it any more
+        catalog_unregister(entry.record);
+        delete entry.record;
+    }
+    else if(entry.action == JOURNAL_RECORD_FIELDS)
+    {
+        Saved_Record_Fields& fields = saved_fields.back();
+        entry.record->pledge_id = fields.pledge_id;
+        entry.record->pledge_description = move(fields.pledge_description);
+        entry.record->change_status = move(fields.change_status);
+        saved_fields.pop_back();
+    }
+    else if(entry.action == JOURNAL_CUSTOMER_PLEDGE)
+    {
+        entry.customer->unpledge_security(entry.customer->pledged_to_customer.size() - 1);
+    }
+    else if(entry.action == JOURNAL_CUSTOMER_RELEASE)
+    {
+        entry.customer->restore_pledged(move(saved_pledges.back()));
+        saved_pledges.pop_back();
+        for(size_t i = 0; i < entry.customer->pledged_to_customer.size(); i++)
+        {
+            catalog_register(entry.customer->pledged_to_customer.at(i));
+        }
+    }
+    else if(entry.action == JOURNAL_CHANGE_PUSH)
+    {
+        entry.changes->pop_back();
+    }
+}
+
+void State_Journal::catalog_register(RBT_Security_Node* record)
+{
+    if(catalog != nullptr)
+    {
+        catalog->register_record(record);
+    }
+}
+
+void State_Journal::catalog_unregister(RBT_Security_Node* record)
+{
+    if(catalog != nullptr)
+    {
+        catalog->unregister_record(record);
+    }
+}
@@ -0,0 +1,188 @@
+#ifndef STATE_JOURNAL_H
+#define STATE_JOURNAL_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "security_index.h"
+#include "security_catalog.h"
+
+
+using namespace std;
+
+struct Customer_Node;
+
+
+/*------------------------------------------------- State Journal Entry Structures ---------------------------------------------*/
+
+//every change the journal knows how to undo
+enum Journal_Action {JOURNAL_INDEX_ADD, JOURNAL_INDEX_REMOVE, JOURNAL_RECORD_COPY, JOURNAL_RECORD_FIELDS,
+                     JOURNAL_CUSTOMER_PLEDGE, JOURNAL_CUSTOMER_RELEASE, JOURNAL_CHANGE_PUSH};
+
+/*
+    This structure is a single journal entry - the change made and what it was made to. Only the fields the
+    change needs are set. Values a change overwrites are kept on the journal's own stacks, in the same order.
+*/
+struct Journal_Entry
+{
+    Journal_Action action;
+    RBT_Security_Node* record;
+    Customer_Node* customer;
+    vector<RBT_Security_Node*>* changes;
+};
+
+/*
+    This structure holds the pledge fields of a security record as they were before a change.
+*/
+struct Saved_Record_Fields
+{
+    int pledge_id;
+    string pledge_description;
+    string change_status;
+};
+
+
+/* ----------------------------------------------------State Journal Class------------------------------------------------------*/
+
+/*
+    The state journal sits in front of the security index and records every change made to the pledging state
+    through it - securities added to and taken from the index, pledges made to and released from customers, pledge
+    fields written to security records and entries pushed onto the change vectors. A snapshot is the position in
+    the journal, so taking one is O(1). Rolling back to a snapshot undoes the entries recorded since, newest first,
+    so it costs only the work done after the snapshot was taken. Nothing is copied to keep the earlier state around.
+
+    When a security catalog is attached, the journal keeps it in sync with every change it makes and undoes.
+
+    The index rolls back to the same set of securities, not the same shape - the order securities are found in
+    can differ after a rollback.
+*/
+class State_Journal : public Security_Index
+{
+public:
+
+    //Journal Constructor - the index and catalog are borrowed, the journal does not own them
+    State_Journal(Security_Index& index, Security_Catalog* catalog = nullptr);
+
+    //the journal holds pointers into the state it records, copying it would let two journals undo the same changes
+    State_Journal(const State_Journal&) = delete;
+    State_Journal& operator=(const State_Journal&) = delete;
+
+    /*-------------------------------------------- State Journal Snapshot Functions --------------------------------------------*/
+
+    /*
+        Function returns a snapshot of the current state, which can later be passed to rollback. O(1)
+    */
+    size_t snapshot();
+
+    /*
+        Function undoes every change recorded since the snapshot was taken, newest first. Security records copied
+        since the snapshot are deleted. Snapshots taken after this one are no longer valid.
+    */
+    void rollback(size_t snapshot);
+
+    /*
+        Function keeps the current state and forgets the recorded changes - called once the state has been
+        rebuilt from a file, when there is nothing left to roll back to.
+    */
+    void commit();
+
+    //number of changes recorded since the last commit
+    size_t entry_count();
+
+    /*---------------------------------------- State Journal Customer and Record Functions -------------------------------------*/
+
+    /*
+        Function returns a copy of the security record (see RBT::RBT_copy_node). The copy is deleted if its
+        creation is rolled back.
+    */
+    RBT_Security_Node* copy_record(RBT_Security_Node* record);
+
+    /*
+        Functions write the pledge id and description / the change status of a security record.
+    */
+    void set_pledge(RBT_Security_Node* record, int pledge_id, const string& pledge_description);
+
+    void set_change_status(RBT_Security_Node* record, const string& change_status);
+
+    /*
+        Function pledges the security record to the customer and updates the customer's balances.
+    */
+    void pledge(Customer_Node* customer, RBT_Security_Node* record);
+
+    /*
+        Function releases every security pledged to the customer and updates the customer's balances. The
+        records are kept by the journal so a rollback can pledge them again, the caller decides what else
+        happens to them.
+    */
+    void release_pledges(Customer_Node* customer);
+
+    /*
+        Function adds the security record to the back of a change vector (additions or removals).
+    */
+    void push_change(vector<RBT_Security_Node*>& changes, RBT_Security_Node* record);
+
+    /*------------------------------------------- State Journal Security Index Functions ---------------------------------------*/
+
+    string backend_name();
+
+    void add_security(RBT_Security_Node* security);
+
+    void bulk_add(const vector<RBT_Security_Node*>& securities);
+
+    RBT_Security_Node* take_security(Money min, Money max);
+
+    bool remove_security(RBT_Security_Node* security);
+
+    RBT_Security_Node* take_smallest();
+
+    RBT_Security_Node* take_largest();
+
+    RBT_Security_Node* erase(int ticket, Money market_value);
+
+    //every record in the index is dropped, so the journal is cleared along with it
+    void release_all();
+
+    RBT_Security_Node* smallest_security();
+
+    RBT_Security_Node* largest_security();
+
+    int security_count();
+
+    Money market_value_total();
+
+    void collect_securities(vector<RBT_Security_Node*>& securities);
+
+    size_t memory_footprint();
+
+    void print_index();
+
+    void run_tests();
+
+    void print_node_usage();
+
+private:
+
+    Security_Index& index;
+
+    Security_Catalog* catalog;
+
+    vector<Journal_Entry> entries;
+
+    //overwritten values, pushed and popped in step with the entries that overwrote them
+    vector<Saved_Record_Fields> saved_fields;
+    vector<vector<RBT_Security_Node*>> saved_pledges;
+
+    void add_entry(Journal_Action action, RBT_Security_Node* record, Customer_Node* customer = nullptr,
+                   vector<RBT_Security_Node*>* changes = nullptr);
+
+    void save_fields(RBT_Security_Node* record);
+
+    void undo(const Journal_Entry& entry);
+
+    void catalog_register(RBT_Security_Node* record);
+
+    void catalog_unregister(RBT_Security_Node* record);
+};
+
+
+#endif
@@ -7,229 +7,237 @@ using namespace std;
 
 
 
-/*-------------------------------Program Build Functions (Red Black Tree and Customer Map) -------------------------------------*/
+/*------------------------------Program Build Functions (Red Black Tree and Customer Store) ------------------------------------*/
 
-Account_Node *build_account_node(const vector<string> &customer_data)
+Account_Node build_account_node(const vector<string_view> &customer_data)
 {
-    Account_Node *new_account = new Account_Node;
-    new_account->account_number = stoi(customer_data.at(4));
-    new_account->interest_rate = customer_data.at(5);
-    new_account->account_type = customer_data.at(6);
-    new_account->class_code_description = customer_data.at(7);
-    new_account->current_balance = stod(customer_data.at(8));
+    Account_Node new_account;
+    new_account.account_number = field_to_int(customer_data.at(4));
+    new_account.interest_rate = customer_data.at(5);
+    new_account.account_type = customer_data.at(6);
+    new_account.class_code_description = customer_data.at(7);
+    new_account.current_balance = Money::from_string(customer_data.at(8));
     return new_account;
 }
 
-Customer_Node *build_customer_node(const vector<string> &customer_data)
+Customer_Node *build_customer_node(const vector<string_view> &customer_data)
 {
     Customer_Node *new_customer = new Customer_Node;
-    new_customer->pledge_code = stoi(customer_data.at(0));
-    new_customer->tax_ID = stol(customer_data.at(1));
+    new_customer->pledge_code = field_to_int(customer_data.at(0));
+    new_customer->tax_ID = field_to_long(customer_data.at(1));
     new_customer->name1 = customer_data.at(2);
     new_customer->name2 = customer_data.at(3);
-    new_customer->accounts.push_back(build_account_node(customer_data));
+    new_customer->add_account(build_account_node(customer_data));
     return new_customer;
 }
 
 
-RBT import_and_build_RBT_tree(map<int, Customer_Node *> customers, vector<RBT_Security_Node *> &pledge_removals, ifstream& security_file)
+void import_and_build_security_index(Customer_Store& customers, vector<RBT_Security_Node *> &pledge_removals, Mapped_File& security_file, Security_Index& tree)
 {
-    //construct new Red-Black tree object -once all securities are loaded into  the tree, the tree object is returned
-    RBT security_tree;
+    //unpledged securities are gathered here and loaded into the tree in one bulk build once the file is read
+    vector<RBT_Security_Node*> unpledged_securities;
 
-    string security_line;
+    //each row is split in place in the mapped file - the fields are views into it, reused for every row
+    Csv_Reader security_rows(security_file);
+    vector<string_view> security_fields;
 
-    //this assignment to security_line will 'absorb' the header line from the csv file
-    getline(security_file, security_line); 
+    //this will 'absorb' the header line from the csv file
+    security_rows.skip_row();
 
-
-    while (getline(security_file, security_line))
+    while (security_rows.next_row(security_fields))
     {
-
-        stringstream security_detail_line(security_line);
-
-        string temp_string;
-        vector<string> temp_vector; //this holds each 'element' in the csv line, which will be used to create a node
-
-        while (getline(security_detail_line, temp_string, ','))
-        {
-            temp_vector.push_back(temp_string);
-        }
-
         //build out the security node
-        RBT_Security_Node *next_security = security_tree.build_security_node(temp_vector);
+        RBT_Security_Node *next_security = RBT::build_security_node(security_fields);
 
-        //check if the pledge ID (customer) is already in the map, if it is, add it to the customer
-        if (customers.find(next_security->pledge_id) != customers.end())
+        //a security placed with a customer has already been added to the customer's totals
+        if (place_loaded_security(customers, pledge_removals, next_security) == nullptr)
         {
-            Customer_Node *customer = customers[next_security->pledge_id];
-            //add security to customer
-            customer->pledged_to_customer.push_back(next_security);
-            //Update all balances in customer node
-            update_balances(customer);
-        }
-        else
-        {   //if the customer is not in the map, free up the security and add to the tree
-            //regardless if security was originally pledged, clear id and description and add to tree
-            //makes a copy of the node to store all components into the unpledge vector, which will later be exported
-            //copy allows each node in the tree to be independent of the unpledge vector. *RBTree Operations can cause nodes to 'change'
-            //add the original security node to the tree
-            RBT_Security_Node *security_copy = security_tree.RBT_copy_node(next_security);
-            if(security_copy->pledge_id != 0)
-            { //only add it to the removal list if it was previously assigned to a customer that is no longer in the map
-                security_copy->change_status = "Unpledge";
-                pledge_removals.push_back(security_copy);
-            } 
-            next_security->pledge_id = 0;
-            next_security->pledge_description = "";
-            security_tree.RBT_add_node(next_security);
+            unpledged_securities.push_back(next_security);
         }
     }
     security_file.close();
-    return security_tree;
+    tree.bulk_add(unpledged_securities);
 }
 
 
-map<int, Customer_Node *> load_customer_data(ifstream& customer_file)
+Customer_Node *place_loaded_security(Customer_Store& customers, vector<RBT_Security_Node *> &pledge_removals, RBT_Security_Node *security)
 {
-    map<int, Customer_Node *> customers;
-
-    string customer_line;
-
-    //this assignment to security_line will 'absorb' the header line from the csv file
-    getline(customer_file, customer_line);
-
-    while (getline(customer_file, customer_line))
+    //check if the pledge ID (customer) is already in the store, if it is, add it to the customer
+    Customer_Node *customer = customers.find(security->pledge_id);
+    if (customer != nullptr)
     {
-        stringstream security_detail_line(customer_line);
+        //add security to customer
+        customer->pledge_security(security);
+        return customer;
+    }
+    //if the customer is not in the store, free up the security so it can be added to the tree
+    //regardless if security was originally pledged, clear id and description
+    //makes a copy of the node to store all components into the unpledge vector, which will later be exported
+    //copy allows each node in the tree to be independent of the unpledge vector. *RBTree Operations can cause nodes to 'change'
+    if(security->pledge_id != 0)
+    { //only add it to the removal list if it was previously assigned to a customer that is no longer in the store
+        RBT_Security_Node *security_copy = RBT::RBT_copy_node(security);
+        security_copy->change_status = "Unpledge";
+        pledge_removals.push_back(security_copy);
+    }
+    security->pledge_id = 0;
+    security->pledge_description = "";
+    return nullptr;
+}
 
-        string temp_string;
-        vector<string> temp_vector; //this holds each 'element' in the csv line, which will be used to create a node
 
-        while (getline(security_detail_line, temp_string, ','))
-        {
-            temp_vector.push_back(temp_string);
-        }
-
-        int pledge_id = stoi(temp_vector.at(0));
-        Customer_Node *customer;
+/*
+    Function reads the customer rows in one chunk of the customer file. Customers are added to chunk_customers
+    the first time their pledge ID is seen in the chunk, later rows for them only add an account.
+*/
+static void load_customer_chunk(const char* text, size_t length, vector<Customer_Node*>& chunk_customers)
+{
+    unordered_map<int, Customer_Node*> chunk_table;
+    Csv_Reader customer_rows(text, length);
+    vector<string_view> customer_fields;
 
-        if (customers.find(pledge_id) == customers.end()) //check to see if customer is already in the mapping
+    while (customer_rows.next_row(customer_fields))
+    {
+        int pledge_id = field_to_int(customer_fields.at(0));
+        //a single lookup both finds the customer and reserves the slot for a new one
+        pair<unordered_map<int, Customer_Node*>::iterator, bool> slot = chunk_table.emplace(pledge_id, nullptr);
+        if (slot.second) //only build new node if not already in the chunk
         {
-            customer = build_customer_node(temp_vector); //only build new node if not already in map
-
-            customers[customer->pledge_code] = customer;
+            slot.first->second = build_customer_node(customer_fields);
+            chunk_customers.push_back(slot.first->second);
         }
         else
-        {  //If the customer is already in the map, add account to the already created customer node
-            customer = customers[pledge_id];
-
-            Account_Node *new_account = build_account_node(temp_vector);
-
-            customer->accounts.push_back(new_account);
+        {  //If the customer is already in the chunk, add account to the already created customer node
+            slot.first->second->add_account(build_account_node(customer_fields));
         }
-        //Update all balances in customer node
-        update_balances(customer);
     }
-    customer_file.close();
-    return customers;
 }
 
+Customer_Store load_customer_data(Mapped_File& customer_file, size_t threads)
+{
+    Customer_Store customers;
 
-/*---------------------------------------Security Seach / Add and Removal Functions --------------------------------------------*/
+    //this will 'absorb' the header line from the csv file - the chunks are cut from the rows after it
+    Csv_Reader header_row(customer_file);
+    header_row.skip_row();
+    const char* rows = customer_file.data() + header_row.offset();
+    size_t rows_length = customer_file.size() - header_row.offset();
 
-RBT_Security_Node *find_security(RBT_Security_Node *root, double min, double max)
-{
-    RBT_Security_Node *cursor = root;
+    size_t workers = (threads > 0) ? threads : thread::hardware_concurrency();
+    if(rows_length < PARALLEL_IMPORT_MIN || workers < 2)
+    {
+        workers = 1;
+    }
+    vector<size_t> bounds = Csv_Reader::row_chunks(rows, rows_length, workers);
+    size_t chunk_count = bounds.size() - 1;
+
+    //each chunk is read into its own table - a chunk that throws (a row that can't be read) is rethrown here
+    vector<vector<Customer_Node*>> chunk_customers(chunk_count);
+    vector<exception_ptr> chunk_errors(chunk_count);
+    vector<thread> loaders;
+    for(size_t chunk = 0; chunk < chunk_count; chunk++)
+    {
+        loaders.push_back(thread([&, chunk]()
+        {
+            try
+            {
+                load_customer_chunk(rows + bounds.at(chunk), bounds.at(chunk + 1) - bounds.at(chunk), chunk_customers.at(chunk));
+            }
+            catch(...)
+            {
+                chunk_errors.at(chunk) = current_exception();
+            }
+        }));
+    }
+    for(size_t i = 0; i < loaders.size(); i++)
+    {
+        loaders.at(i).join();
+    }
+    customer_file.close();
 
-    while (cursor != nullptr)
+    //the chunk tables are merged in file order - a stable sort on pledge code keeps a customer split across
+    //chunks in chunk order, so it keeps the node from the first chunk it appears in, and the accounts read by
+    //later chunks are moved onto it
+    vector<Customer_Node*> loaded;
+    for(size_t chunk = 0; chunk < chunk_count; chunk++)
+    {
+        loaded.insert(loaded.end(), chunk_customers.at(chunk).begin(), chunk_customers.at(chunk).end());
+    }
+    stable_sort(loaded.begin(), loaded.end(), [](const Customer_Node* first, const Customer_Node* second)
+    {
+        return first->pledge_code < second->pledge_code;
+    });
+    size_t kept = 0;
+    for(size_t i = 0; i < loaded.size(); i++)
     {
-        //check to see if current security value is within range, if so, return it
-        if (cursor->market_value >= min && cursor->market_value <= max)
+        Customer_Node* customer = loaded.at(i);
+        if(kept > 0 && loaded.at(kept - 1)->pledge_code == customer->pledge_code)
         {
-            return cursor;
+            Customer_Node* first = loaded.at(kept - 1);
+            first->take_accounts(customer);
+            delete customer;
         }
-        else if (min < cursor->market_value)
+        else
         {
-            cursor = cursor->left_child;
+            loaded.at(kept++) = customer;
         }
-        else
+    }
+    loaded.resize(kept);
+    customers.assign(loaded);
+    for(size_t chunk = 0; chunk < chunk_count; chunk++)
+    {
+        if(chunk_errors.at(chunk))
         {
-            cursor = cursor->right_child;
+            clear_customers(customers);
+            rethrow_exception(chunk_errors.at(chunk));
         }
     }
-    return nullptr; //if an appropriate security is not found, return null
+
+    return customers;
 }
 
-bool update_customers(map<int, Customer_Node *> customers, RBT tree, vector<RBT_Security_Node*>& additions, double threshold)
+
+/*---------------------------------------Security Seach / Add and Removal Functions --------------------------------------------*/
+
+bool update_customers(Customer_Store& customers, State_Journal& tree, vector<RBT_Security_Node*>& additions, double threshold)
 {
-    //array holding all customers with underpeldged balances that need to be updated 
-    vector<Customer_Node *> updates_needed; 
-    for (map<int, Customer_Node *>::iterator pair = customers.begin(); pair != customers.end(); pair++)
+    //if the free securities in the tree are worth less than the combined shortfall, the run can't succeed
+    //the index keeps its market value total and the store its total deficit, so this check is O(1)
+    if (customers.deficit_total() > tree.market_value_total())
     {
-        //determine which customers are underpledged
-        Customer_Node *current = pair->second;
-        if (current->over_under < 0)
-        {
-            updates_needed.push_back(current);
-        }
+        return false;
     }
-    for (size_t i = 0; i < updates_needed.size(); i++)
+    //the underpledged customers come from the store's deficit queue in its pledge order - a customer leaves the
+    //queue as soon as its pledges cover it, so the next one is always at the top
+    Customer_Node *to_update;
+    while ((to_update = customers.next_underpledged()) != nullptr)
     {
-        Customer_Node *to_update = updates_needed.at(i);
 
         //small and large vectors to hold the securities pledge using each method (searching both smaller and larger balances)
         //the aggregate total of each vector will be compared and the smaller value will be used
         vector<RBT_Security_Node *> small;
         vector<RBT_Security_Node *> large;
-        double small_sum = 0;
-        double large_sum = 0;
+        Money small_sum;
+        Money large_sum;
+
+        //both methods are tried speculatively from the same starting point - each search is rolled back to here
+        //through the journal, so no securities are copied and only the winning method's pledges are kept
+        size_t before_search = tree.snapshot();
 
         //perform search using the small method
-        bool pledge_status_small = increase_decrease_search(tree, to_update->over_under, false, small, threshold);
+        bool pledge_status_small = increase_decrease_search(tree, to_update->over_under(), false, small, threshold);
         
-        //temporary vector to hold the securities found during the small search method
-        //the nodes herein will be used to identify which securities to remove from the tree below
-        vector<RBT_Security_Node*> small_security_hold;
-        //re-enter copied securities back into the tree - this ensures that they are available
-        //for the large search method
-        for (RBT_Security_Node *security : small)
-        {
-            RBT_Security_Node *copy1 = tree.RBT_copy_node(security);
-            RBT_Security_Node *copy2 = tree.RBT_copy_node(security);
-            copy1->pledge_id = 0;
-            copy1->pledge_description = "";
-            tree.RBT_add_node(copy1);
-            small_security_hold.push_back(copy2);
-        }
+        //roll back the small method - its securities return to the tree so they are available for the large search method
+        tree.rollback(before_search);
+
         //perform search usign the large method    
-         bool pledge_status_large = increase_decrease_search(tree, to_update->over_under, true, large, threshold);
-         
+        bool pledge_status_large = increase_decrease_search(tree, to_update->over_under(), true, large, threshold);
 
         if (!(pledge_status_large || pledge_status_small))
         {
             //if neither one of the methods result in the security being covered, the function returns false
-            //the large method securities used (those within the 'large' vector) must be re-entered into the tree
-            for(size_t unused = 0; unused < large.size(); unused++)
-            {
-                RBT_Security_Node *copy = tree.RBT_copy_node(large.at(unused));
-                copy->pledge_id = 0;
-                copy->pledge_description = "";
-                tree.RBT_add_node(copy);
-                delete large.at(unused);
-            }
-            for(size_t unused = 0; unused < small_security_hold.size(); unused++)
-            {
-                //small has already been replaced in the tree above
-                //free the memory of nodes that were added here
-                delete small_security_hold.at(unused);
-            }
-            for(size_t unused = 0; unused < small.size(); unused++)
-            {
-                //small has already been replaced in the tree above
-                //free the memory of nodes that were added here
-                delete small.at(unused);
-            }
+            //the large method securities used are put back into the tree
+            tree.rollback(before_search);
             return false;
         }
 
@@ -243,148 +251,141 @@ bool update_customers(map<int, Customer_Node *> customers, RBT tree, vector<RBT_
             large_sum += security->market_value;
         }
         //This is checking which path resulted in less additions value - the path with the lessor amount
-        //should be used to reduce excess value pledged. Converted to int for comparison. Otherwise, when values
-        //are exact, proper comparison wasn't performed since they were double values
-        int small_sum_convert = small_sum;
-        int large_sum_convert = large_sum;
-        if (small_sum_convert < large_sum_convert || small_sum == to_update->over_under)
-        {   //when small sum is smaller, assign these securities to the customers and add to the additions vector
-            for (size_t add_security = 0; add_security < small.size(); add_security++)
-            {
-                small.at(add_security)->pledge_id = to_update->pledge_code;
-                small.at(add_security)->pledge_description = to_update->name1;
-                to_update->pledged_to_customer.push_back(small.at(add_security)); 
-                RBT_Security_Node* copy = tree.RBT_copy_node(small.at(add_security));
-                copy->change_status = "Pledge";
-                additions.push_back(copy);
-                update_balances(to_update);
-            }
-            //restore the unused large method securities to the tree and free up it's memory allocation
-            for(size_t unused = 0; unused < large.size(); unused++)
+        //should be used to reduce excess value pledged. Amounts are whole cents, so exact values compare equal
+        if (small_sum < large_sum || small_sum == to_update->over_under())
+        {   
+            //roll back the large method and take the small method securities back out of the tree by their records
+            tree.rollback(before_search);
+            for(size_t used = 0; used < small.size(); used++)
             {
-                RBT_Security_Node *copy = tree.RBT_copy_node(large.at(unused));
-                copy->pledge_id = 0;
-                copy->pledge_description = "";
-                tree.RBT_add_node(copy);
-                delete large.at(unused);
+                tree.remove_security(small.at(used));
             }
-            //need to remove the duplicate "replaced" securities so they are not added twice to the tree
-            //since these were re-added to the tree above before the 'large' method was performed, they are currently
-            //in the tree as well as being pledge to the customer above. This will find the security it the tree
-            //and then remove it.
-            for(size_t used = 0; used < small_security_hold.size(); used++)
+            //when small sum is smaller, assign these securities to the customers and add to the additions vector
+            for (size_t add_security = 0; add_security < small.size(); add_security++)
             {
-                int ticket = small_security_hold.at(used)->ticket;
-                double mv = small_security_hold.at(used)->market_value;
-                RBT_Security_Node* to_remove = tree.find_node(tree.get_root(), ticket, mv);
-                tree.RBT_remove_node(to_remove);
-                delete small_security_hold.at(used);
+                tree.set_pledge(small.at(add_security), to_update->pledge_code, to_update->name1);
+                tree.pledge(to_update, small.at(add_security));
+                RBT_Security_Node* copy = tree.copy_record(small.at(add_security));
+                copy->change_status = "Pledge";
+                tree.push_change(additions, copy);
             }
         }
         else
         {   //if the large method results in a smaller excess amount, it's security nodes at added to the customer
+            //they are already out of the tree, so the large method's journal entries are simply kept
             for (size_t add_security = 0; add_security < large.size(); add_security++)
             {
-                large.at(add_security)->pledge_id = to_update->pledge_code;
-                large.at(add_security)->pledge_description = to_update->name1;
-                to_update->pledged_to_customer.push_back(large.at(add_security));
-                RBT_Security_Node* copy = tree.RBT_copy_node(large.at(add_security));
+                tree.set_pledge(large.at(add_security), to_update->pledge_code, to_update->name1);
+                tree.pledge(to_update, large.at(add_security));
+                RBT_Security_Node* copy = tree.copy_record(large.at(add_security));
                 copy->change_status = "Pledge";
-                additions.push_back(copy);
-                update_balances(to_update);
-            }
-            for(size_t unused = 0; unused < small.size(); unused++)
-            {
-                //small has already been replaced in the tree above
-                //free the memory of nodes that were added here
-                delete small.at(unused);
-            }
-            for(size_t unused = 0; unused < small_security_hold.size(); unused++)
-            {
-                //small has already been replaced in the tree above
-                //free the memory of nodes that were added here
-                delete small_security_hold.at(unused);
+                tree.push_change(additions, copy);
             }
         }
+        //a customer still short after its pledges would come straight back out of the queue
+        if (customers.next_underpledged() == to_update)
+        {
+            return false;
+        }
     }
     return true;
 }
 
-bool clear_all_and_repledge(RBT tree, map<int, Customer_Node *> customers, vector<RBT_Security_Node*>& additions, vector<RBT_Security_Node*>& removals)
+bool clear_all_and_repledge(State_Journal& tree, Customer_Store& customers, vector<RBT_Security_Node*>& additions, vector<RBT_Security_Node*>& removals,
+                            Allocation_Report& report)
 {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    report = Allocation_Report();
+    size_t first_removal = removals.size();
+    size_t first_addition = additions.size();
     //first step - clear all securities currently pledged to customers and add back to the tree
     //making the securities available for the new search
-    clear_pledges(tree, customers, removals, true);
+    clear_pledges(tree, customers, removals);
+    report.lots_released = removals.size() - first_removal;
+    report.deficit = total_deficit(customers);
+    report.customers_pledged = customers.underpledged_count();
+    //every security is now in the tree - if they are worth less than the combined shortfall, no pass below could succeed
+    bool status = report.deficit <= tree.market_value_total();
+    //every pass starts from the state left by clearing the pledges
+    size_t cleared_state = tree.snapshot();
+    if (status)
+    {
+        //the single global pass covers the customers in most runs - the threshold loop is only run if it falls short,
+        //so a run never covers fewer customers than the loop would
+        report.single_pass = allocate_pledges(tree, customers, additions);
+        status = report.single_pass;
+        if (!status)
+        {
+            tree.rollback(cleared_state);
+        }
+    }
     //set initial threshold - gets reduced to 50% in the initial iteration below
     double threshold = .51;
-    //this will only be set to true if all customers have their balances covered
-    bool status = false;
-    
-    while(!status && threshold > 0)
+    while(!status && report.deficit <= tree.market_value_total() && threshold > 0)
     { 
         threshold -= .01;
         //when this goes below 0, set it to 0 - this will indicate a search for securities at their exact value
         if(threshold < 0) {threshold = 0;} 
+        report.threshold_passes++;
         status = update_customers(customers, tree, additions, threshold);
         if(!status)
         {   
-            //free memory of nodes in additions and clear out resetting for the next iteration
-            for(size_t addition = 0; addition < additions.size(); addition++)
-            {
-                delete additions.at(addition);
-            }
-            additions.clear();
-            //clear all securities pledged as a result of the pevious iteration
-            //in preparation of the next round
-            clear_pledges(tree, customers, removals, false);
-
+            //undo the pledges and additions of the failed pass in preparation of the next round - the securities
+            //it took go back into the tree and the addition copies are freed
+            tree.rollback(cleared_state);
         }
     }
+    report.covered = status;
+    if (!status)
+    {
+        report.customers_pledged = 0;
+    }
+    report.lots_pledged = additions.size() - first_addition;
+    report.lots_moved = count_lots_moved(removals, first_removal, additions, first_addition);
+    report.excess = total_excess(customers);
+    report.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
     return status;
 }
 
-bool increase_decrease_search(RBT tree, double over_under, bool direction, vector<RBT_Security_Node *> &used_securities, double threshold)
+bool increase_decrease_search(Security_Index& tree, Money over_under, bool direction, vector<RBT_Security_Node *> &used_securities, double threshold)
 {
-    double min = over_under * -1;
-    double max;
-    RBT_Security_Node *smallest_mv = tree.find_minimum(tree.get_root());
-    RBT_Security_Node *largest_mv = tree.find_maximum(tree.get_root());
-    double temporary_over_under = over_under; //using a copy of the under_over balance to determine coverage
+    Money min = -over_under;
+    Money max;
+    RBT_Security_Node *smallest_mv = tree.smallest_security();
+    RBT_Security_Node *largest_mv = tree.largest_security();
+    Money temporary_over_under = over_under; //using a copy of the under_over balance to determine coverage
 
     if (!direction)
     {
-        max = temporary_over_under * -1 * (1 + threshold);
+        max = (-temporary_over_under).scaled(1 + threshold);
     }
     else
     {
         //this will find the first security in the tree large enough to cover the value or the next largest one - it will continue to find smaller ones
-        max = __DBL_MAX__;
+        max = Money::max();
     }
-    while (temporary_over_under < 0)
+    while (temporary_over_under < Money())
     {
-        RBT_Security_Node *security = find_security(tree.get_root(), min, max);
+        RBT_Security_Node *security = tree.take_security(min, max);
         if (security != nullptr)
         {   
-            //if an appropriate security is found, the temporary over under is increase with the security's value
-            //a copy of the security node is created and added to the vector holding the found securities
-            //the security is then removed from the tree
+            //if an appropriate security is found, it has already been taken out of the tree - the temporary over under
+            //is increased with the security's value and the security added to the vector holding the found securities
             temporary_over_under += security->market_value;
-            RBT_Security_Node *copy = tree.RBT_copy_node(security);
-            used_securities.push_back(copy);
-            tree.RBT_remove_node(security);
+            used_securities.push_back(security);
 
-            //restablish smallest and largest securities as a result of removing nodes from the tree and rebalancing
-            smallest_mv = tree.find_minimum(tree.get_root());
-            largest_mv = tree.find_maximum(tree.get_root());
+            //restablish smallest and largest securities - both are kept by the index, so this is O(1)
+            smallest_mv = tree.smallest_security();
+            largest_mv = tree.largest_security();
 
-            if (temporary_over_under >= 0)
+            if (temporary_over_under >= Money())
             {   //exit the loop/function, the balance is now covered
                 break;
             }
         }
         //check if the tree is empty - exit in the loop/function and return false
         //if the over_under is still not covered at this point, it's impossible to cover
-        if(tree.get_root() == nullptr)
+        if(tree.security_count() == 0)
         {
             return false;
         }
@@ -393,23 +394,21 @@ bool increase_decrease_search(RBT tree, double over_under, bool direction, vecto
         if (max < smallest_mv->market_value)
         {
             temporary_over_under += smallest_mv->market_value;
-            RBT_Security_Node *copy = tree.RBT_copy_node(smallest_mv);
-            used_securities.push_back(copy);
-            tree.RBT_remove_node(smallest_mv);
-            //find new smallest security
-            smallest_mv = tree.find_minimum(tree.get_root());
+            used_securities.push_back(tree.take_smallest());
+            //find new smallest and largest security - the smallest may also have been the last (largest) security
+            smallest_mv = tree.smallest_security();
+            largest_mv = tree.largest_security();
         }
-        if (min > largest_mv->market_value)
+        if (largest_mv != nullptr && min > largest_mv->market_value)
         {
             temporary_over_under += largest_mv->market_value;
-            RBT_Security_Node *copy = tree.RBT_copy_node(largest_mv);
-            used_securities.push_back(copy);
-            security = copy;
-            tree.RBT_remove_node(largest_mv);
-            //find new largest security
-            largest_mv = tree.find_maximum(tree.get_root());
-        }
-        if (temporary_over_under > 0)
+            security = largest_mv;
+            used_securities.push_back(tree.take_largest());
+            //find new smallest and largest security
+            smallest_mv = tree.smallest_security();
+            largest_mv = tree.largest_security();
+        }
+        if (temporary_over_under > Money())
         { //exit the loop, the balance is now covered
             break;
         }
@@ -419,92 +418,92 @@ bool increase_decrease_search(RBT tree, double over_under, bool direction, vecto
           //the under-over needed balance. This will beging search the tree starting at the root
           //moving 'left' down the tree.
             max = min;
-            min = 0;
+            min = Money();
         }
         else if(security != nullptr && direction)
         {   //once a security is found, but the balance is not yet covered,
             //the min threshold is reset at the new temp over_under balance
-            max = __DBL_MAX__;
-            min = temporary_over_under * -1;
+            max = Money::max();
+            min = -temporary_over_under;
         }
         else if(security != nullptr && !direction)
         {   //once a security is found, but the balance is not yet covered,
             //the threshold is reset at the current under-over balance
-            max = temporary_over_under * -1 * (1 + threshold);
-            min = temporary_over_under * -1;
+            max = (-temporary_over_under).scaled(1 + threshold);
+            min = -temporary_over_under;
         }
     }
     return true;
 }
 
-void clear_customers(map<int, Customer_Node*>& customers)
+Money total_deficit(Customer_Store& customers)
+{
+    //the deficit queue keeps the total as over_under balances change
+    return customers.deficit_total();
+}
+
+void clear_customers(Customer_Store& customers)
 {
-    for (map<int, Customer_Node *>::iterator pair = customers.begin(); pair != customers.end(); pair++)
+    for (size_t customer = 0; customer < customers.size(); customer++)
     {
         //release the memory used by the pointer
         //free memory allocated to security nodes
-        for(size_t i = 0; i < pair->second->pledged_to_customer.size(); i++)
-        {
-            delete pair->second->pledged_to_customer.at(i);
-        }
-        for(size_t i = 0; i < pair->second->accounts.size(); i++)
+        Customer_Node *current = customers.at(customer);
+        for(size_t i = 0; i < current->pledged_to_customer.size(); i++)
         {
-            delete pair->second->accounts.at(i);
+            delete current->pledged_to_customer.at(i);
         }
         //finally free memory allocated to the customer itself
-        delete pair->second;
+        delete current;
     }
-    //empty out the map
+    //empty out the store
     customers.clear();
 }
 
-void clear_pledges(RBT tree, map<int, Customer_Node *> customers, vector<RBT_Security_Node*>& removals, bool unpledge)
+void clear_pledges(State_Journal& tree, Customer_Store& customers, vector<RBT_Security_Node*>& removals)
 {
-    for (map<int, Customer_Node *>::iterator pair = customers.begin(); pair != customers.end(); pair++)
+    //every pledge goes back into the tree, so they are collected and added in one bulk build
+    vector<RBT_Security_Node*> released;
+    for (size_t customer = 0; customer < customers.size(); customer++)
     {
-        Customer_Node *current = pair->second;
+        Customer_Node *current = customers.at(customer);
         for(size_t i = 0; i < current->pledged_to_customer.size(); i++)
         {
-            if(unpledge)
-            {   //it should only add the removal to the unpledged list on the original removal
-                current->pledged_to_customer.at(i)->change_status = "Unpledge";
-                removals.push_back(current->pledged_to_customer.at(i));
-                RBT_Security_Node* copy = tree.RBT_copy_node(current->pledged_to_customer.at(i));
-                tree.RBT_add_node(copy);
-            }
-            else
-            {
-                RBT_Security_Node* copy = tree.RBT_copy_node(current->pledged_to_customer.at(i));
-                tree.RBT_add_node(copy);
-            }
+            RBT_Security_Node* pledged = current->pledged_to_customer.at(i);
+            tree.set_change_status(pledged, "Unpledge");
+            tree.push_change(removals, pledged);
+            released.push_back(tree.copy_record(pledged));
         }
-        current->pledged_to_customer.clear();
-        update_balances(current);
+        tree.release_pledges(current);
     }
+    tree.bulk_add(released);
 }
 
-void test_overage(map<int, Customer_Node*>& customers,vector<RBT_Security_Node*>& removals, RBT tree)
+void test_overage(Customer_Store& customers,vector<RBT_Security_Node*>& removals, Security_Index& tree)
 {
-    for (map<int, Customer_Node *>::iterator pair = customers.begin(); pair != customers.end(); pair++)
+    vector<RBT_Security_Node*> released;
+    const Money *over_under = customers.over_under_column();
+    const Money *total_balance = customers.balance_column();
+    for (size_t customer = 0; customer < customers.size(); customer++)
     {
         //test if the customer's overage exceeds 50% of the account balance
         //if it is, unpledge the securities from the customer and another attempt
-        //will be made in the pledging function
-        if(pair->second->over_under > (pair->second->total_balance * .5))
+        //will be made in the pledging function - the test reads the store's columns only
+        if(over_under[customer] > total_balance[customer].scaled(.5))
         {
-            for(size_t i = 0; i < pair->second->pledged_to_customer.size(); i++)
+            Customer_Node *current = customers.at(customer);
+            for(size_t i = 0; i < current->pledged_to_customer.size(); i++)
             {
-                RBT_Security_Node* unpledge = pair->second->pledged_to_customer.at(i);
-                RBT_Security_Node* copy = tree.RBT_copy_node(unpledge);
-                tree.RBT_add_node(copy);
+                RBT_Security_Node* unpledge = current->pledged_to_customer.at(i);
+                released.push_back(RBT::RBT_copy_node(unpledge));
                 unpledge->change_status = "Unpledge";
                 removals.push_back(unpledge);
             } 
-            pair->second->pledged_to_customer.clear();
-            update_balances(pair->second);
+            current->release_pledged();
         }
         
     }
+    tree.bulk_add(released);
 }
 
 void clear_changes(vector<RBT_Security_Node*>& removals, vector<RBT_Security_Node*>& additions)
@@ -521,10 +520,52 @@ void clear_changes(vector<RBT_Security_Node*>& removals, vector<RBT_Security_Nod
         additions.clear();
 }
 
+void release_all_securities(Security_Index& tree, Customer_Store& customers, vector<RBT_Security_Node*>& removals,
+                            vector<RBT_Security_Node*>& additions)
+{
+    //the pool is only reset when every record it has handed out is released here - otherwise a record held
+    //somewhere else would be freed under it, so the records released here are deleted on their own instead
+    size_t released = tree.security_count() + removals.size() + additions.size();
+    for (size_t i = 0; i < customers.size(); i++)
+    {
+        released += customers.at(i)->pledged_to_customer.size();
+    }
+    bool reset_pool = released == RBT_Security_Node::pool().live_count();
+    vector<RBT_Security_Node*> records;
+    if(!reset_pool)
+    {
+        records.reserve(released);
+        tree.collect_securities(records);
+        for (size_t i = 0; i < customers.size(); i++)
+        {
+            records.insert(records.end(), customers.at(i)->pledged_to_customer.begin(), customers.at(i)->pledged_to_customer.end());
+        }
+        records.insert(records.end(), removals.begin(), removals.end());
+        records.insert(records.end(), additions.begin(), additions.end());
+    }
+
+    //drop every reference to a security node before the pool is reset - the nodes themselves are released together below
+    for (size_t i = 0; i < customers.size(); i++)
+    {
+        customers.at(i)->release_pledged();
+    }
+    removals.clear();
+    additions.clear();
+    tree.release_all();
+    if(reset_pool)
+    {
+        RBT_Security_Node::pool().reset();
+    }
+    else
+    {
+        clear_vector(records);
+    }
+}
+
 
 /*---------------------------------------------- Display and Export Functions --------------------------------------------------*/
 
-void display_customers(map<int, Customer_Node *> customers, bool all_customers)
+void display_customers(Customer_Store& customers, bool all_customers)
 {
 
     //print out header line
@@ -536,33 +577,35 @@ void display_customers(map<int, Customer_Node *> customers, bool all_customers)
          << setw(25) << "Net Covered Balance %"
          << setw(35) << "Over/Under Pledged Status" << endl;
 
-    for (map<int, Customer_Node *>::iterator pair = customers.begin(); pair != customers.end(); pair++)
+    //the totals are read from the store's columns - a customer node is only read for a line that is printed
+    const Money *total_balance = customers.balance_column();
+    const Money *over_under = customers.over_under_column();
+    for (size_t i = 0; i < customers.size(); i++)
     {
-        Customer_Node *current = pair->second;
+        Customer_Node *current = customers.at(i);
         double percent;
-        double percentage_calc = current->over_under / current->total_balance;
-        if(percentage_calc == 0){percent =100;}
-        else if(current->total_balance == 0){percent = 0;}
-        else{percent = percentage_calc * 100;}
+        if(total_balance[i] == Money()){percent = 0;}
+        else if(over_under[i] == Money()){percent = 100;}
+        else{percent = over_under[i].to_double() / total_balance[i].to_double() * 100;}
 
-        //loop through all customers in the customer map if 'all_customers' set to true, not in any particular order
+        //loop through all customers in the customer store if 'all_customers' set to true, not in any particular order
         if (all_customers)
         {
             cout << fixed << showpoint << setprecision(2)
             << setw(9) << current->pledge_code
             << setw(30) << current->name1
-            << setw(20) << current->total_balance
-            << setw(25) << current->over_under;
+            << setw(20) << total_balance[i]
+            << setw(25) << over_under[i];
             cout << fixed << setprecision(2) << setw(25) << percent << "%";
-            if (current->over_under < 0)
+            if (over_under[i] < Money())
             {
                 cout << setw(35) << "Under Pledged" << endl;
             }
-            else if (current->total_balance == 0)
+            else if (total_balance[i] == Money())
             {
                 cout << setw(35) << "No Pledges Needed" << endl;
             }
-            else if (current->over_under == 0)
+            else if (over_under[i] == Money())
             {
                 cout << setw(35) << "Precisely Pledged" << endl;
             }
@@ -572,13 +615,13 @@ void display_customers(map<int, Customer_Node *> customers, bool all_customers)
             }
         }
         //only print underpledged customers if all customers is set to false
-        else if (!all_customers && current->over_under < 0)
+        else if (!all_customers && over_under[i] < Money())
         {
             cout << fixed << showpoint << setprecision(2)
                  << setw(9) << current->pledge_code
                  << setw(30) << current->name1
-                 << setw(20) << current->total_balance
-                 << setw(25) << current->over_under
+                 << setw(20) << total_balance[i]
+                 << setw(25) << over_under[i]
                  << setw(30) << "Under Pledged" << endl;
         }
     }
@@ -625,22 +668,22 @@ void display_changes(vector<RBT_Security_Node*> removals, vector<RBT_Security_No
     }
 }
 
-void export_customers(map<int, Customer_Node*>& customers)
+void export_customers(Customer_Store& customers)
 {
     ofstream export_file("customer_balances_updated.csv");
     
     export_file << "Pledge ID,Tax ID Number,Name1,Name2,Number of Accounts,Total Securities Pledge Amount,";
     export_file << "Total of Customer Account Balance(s), Net Pledge Amount, Pledge Status" << endl;
 
-    for (map<int, Customer_Node *>::iterator pair = customers.begin(); pair != customers.end(); pair++)
+    for (size_t i = 0; i < customers.size(); i++)
     {
         string status;
-        Customer_Node* next = pair->second;
-        if (next->over_under < 0)
+        Customer_Node* next = customers.at(i);
+        if (next->over_under() < Money())
         {
             status = "Under Pledged";
         }
-        else if (next->over_under == 0)
+        else if (next->over_under() == Money())
         {
             status = "Precisely Pledged";
         }
@@ -652,12 +695,12 @@ void export_customers(map<int, Customer_Node*>& customers)
        export_file << fixed << setprecision(2) 
        << next->pledge_code << ","
        << next->tax_ID << ","
-       << next->name1 << ","
-       << next->name2 << ","
+       << csv_field(next->name1) << ","
+       << csv_field(next->name2) << ","
        << next->accounts.size() << ","
-       << next->total_pledged << ","
-       << next->total_balance << ","
-       << next->over_under << ","
+       << next->total_pledged() << ","
+       << next->total_balance() << ","
+       << next->over_under() << ","
        << status << endl;
        
     }
@@ -675,17 +718,17 @@ void export_changes(vector<RBT_Security_Node*> removals, vector<RBT_Security_Nod
     {
         RBT_Security_Node* next = removals.at(change);
         export_file << next->change_status << ","
-        << next->portfolio << ","
-        << next->cusip << ","
+        << csv_field(next->portfolio) << ","
+        << csv_field(next->cusip) << ","
         << next->ticket << ","
-        << next->maturity << ","
+        << csv_field(next->maturity) << ","
         << next->pledge_id << ","
-        << next->pledge_description << ","
+        << csv_field(next->pledge_description) << ","
         << next->pledge_amount << ","
         << next->par_value << ","
         << next->market_value << ","
-        << next->group << ","
-        << next->security_description << endl;
+        << csv_field(next->group) << ","
+        << csv_field(next->security_description) << endl;
     }
 
     //add a blank line inbetween releases and pledges
@@ -696,31 +739,50 @@ void export_changes(vector<RBT_Security_Node*> removals, vector<RBT_Security_Nod
     {
         RBT_Security_Node* next = additions.at(change);
         export_file << next->change_status << ","
-        << next->portfolio << ","
-        << next->cusip << ","
+        << csv_field(next->portfolio) << ","
+        << csv_field(next->cusip) << ","
         << next->ticket << ","
-        << next->maturity << ","
+        << csv_field(next->maturity) << ","
         << next->pledge_id << ","
-        << next->pledge_description << ","
+        << csv_field(next->pledge_description) << ","
         << next->pledge_amount << ","
         << next->par_value << ","
         << next->market_value << ","
-        << next->group << ","
-        << next->security_description << endl;
+        << csv_field(next->group) << ","
+        << csv_field(next->security_description) << endl;
     }
 }
 
 
 /*---------------------------------------------------- Utility Functions -------------------------------------------------------*/
 
-void update_balances(Customer_Node *customer)
+bool update_balances(Customer_Node *customer)
+{
+    //a customer not in a store has no stored totals to check
+    if (customer->table == nullptr)
+    {
+        return true;
+    }
+    //re-sum total balance and total securities pledged
+    Money total_balance = customer->account_sum();
+    Money total_pledged = customer->pledged_sum();
+    bool matched = total_balance == customer->total_balance() && total_pledged == customer->total_pledged()
+                   && customer->over_under() == total_pledged - total_balance;
+    customer->table->set_totals(customer->row, total_balance, total_pledged);
+    return matched;
+}
+
+int audit_customer_totals(Customer_Store& customers)
 {
-    //update total balance
-    customer->total_balance = customer->total_account_balance(customer->accounts);
-    //update total securities pledged
-    customer->total_pledged = customer->total_securities_pledged(customer->pledged_to_customer);
-    //update over/under
-    customer->over_under = customer->calculate_under_over(customer->total_pledged, customer->total_balance);
+    int mismatched = 0;
+    for (size_t i = 0; i < customers.size(); i++)
+    {
+        if (!update_balances(customers.at(i)))
+        {
+            mismatched++;
+        }
+    }
+    return mismatched;
 }
 
 int interface_validate()
@@ -745,7 +807,7 @@ int interface_validate()
         }
         else if (extra.length() > 0)
         {
-            cout << endl << "You've entered an invalid value. Please enter an integer value between 0 and 10 or \"Q\" to quit: ";
+            cout << endl << "You've entered an invalid value. Please enter an integer value between 0 and 11 or \"Q\" to quit: ";
             continue;
         }
         else 
@@ -769,23 +831,23 @@ int interface_validate()
             //to_string returns only 6 digits post decimal; therefore, all digits should be 0
             if (decimal_test != "000000")
             {
-                cout << endl << "You've entered an invalid value. Please enter an integer value between 0 and 10 or \"Q\" to quit: ";
+                cout << endl << "You've entered an invalid value. Please enter an integer value between 0 and 11 or \"Q\" to quit: ";
                 continue;
             }   
 
             try
                 {
                 int converted_int = stoi(truncated_string);
-                if (converted_int < 0 || converted_int > 10)
+                if (converted_int < 0 || converted_int > 11)
                 {
-                    cout << endl << "You've entered an invalid value. Please enter an integer value between 0 and 10 or \"Q\" to quit: ";
+                    cout << endl << "You've entered an invalid value. Please enter an integer value between 0 and 11 or \"Q\" to quit: ";
                     continue;
                 }
                 return converted_int;
                 } 
             catch (...) //handles all types of exceptions - main exception of concern is overflow of data type here
                 {
-                    cout << endl << "You've entered an invalid value. Please enter an integer value between 0 and 10 or \"Q\" to quit: ";
+                    cout << endl << "You've entered an invalid value. Please enter an integer value between 0 and 11 or \"Q\" to quit: ";
                     continue;          
                 }       
         }
@@ -793,81 +855,24 @@ int interface_validate()
     while (true);  
 }
 
-void copy_customer_map(map<int, Customer_Node*>& source_map, map<int, Customer_Node*>& target_map, RBT tree)
-{
-    clear_customers(target_map);
-    for(map<int, Customer_Node *>::iterator pair = source_map.begin(); pair != source_map.end(); pair++)
-    {
-        //release the memory used by the pointer
-        //need to attach the account nodes to the customer copy
-        Customer_Node* customer_copy = new Customer_Node;
-        for(size_t i = 0; i < pair->second->accounts.size(); i++)
-        {
-            Account_Node* account = pair->second->accounts.at(i);
-            Account_Node* copy = copy_account(account);
-            customer_copy->accounts.push_back(copy);
-        }
-
-        customer_copy->name1 = pair->second->name1;
-        customer_copy->name2 = pair->second->name2;
-        customer_copy->pledge_code = pair->second->pledge_code;
-        customer_copy->tax_ID = pair->second->tax_ID;
-        for(size_t i = 0; i < pair->second->pledged_to_customer.size(); i++)
-        {
-            RBT_Security_Node* node_to_copy = pair->second->pledged_to_customer.at(i);
-            RBT_Security_Node* copy = tree.RBT_copy_node(node_to_copy);
-            customer_copy->pledged_to_customer.push_back(copy);
-        }
-        target_map[pair->first] = customer_copy;
-        update_balances(customer_copy);
-    }
-}
-
-Account_Node* copy_account(Account_Node* original)
-{
-    Account_Node* copy = new Account_Node;
-    copy->account_number = original->account_number;
-    copy->account_type = original->account_type;
-    copy->class_code_description = original->class_code_description;
-    copy->current_balance = original->current_balance;
-    copy->interest_rate = original->interest_rate;
-    return copy;
-}
-
-void open_file(ifstream& file)
+string open_file(Mapped_File& file)
 {   //if the file name entered cannot be opened, it will continuously loop until it receives a valid name, or user exits
+    string file_name;
     do 
     {   
         cout << "Enter Source File Name or \"R\" to Return to the Main Menu: ";
-        string file_name;
         cin >> file_name;
         if(file_name == "R" || file_name == "r")
         {
-            return;
+            return "";
         }
-        else
+        else if(!file.open(file_name))
         {
-            file.open(file_name, ios::in); 
-            if(!file.is_open())
-            {
-                cout << endl << "The file could not be opened. Ensure the file name is correct and re-enter." << endl << endl;
-            }
+            cout << endl << "The file could not be opened. Ensure the file name is correct and re-enter." << endl << endl;
         }
     
     } while(!file.is_open());
-    return;
-}
-
-vector<RBT_Security_Node*> copy_removals(vector<RBT_Security_Node*>& removals, RBT tree)
-{
-    vector<RBT_Security_Node*> removals_copy;
-    for(size_t i = 0; i < removals.size(); i++)
-    {
-        RBT_Security_Node* next = tree.RBT_copy_node(removals.at(i));
-        next->change_status = "Unpledge";
-        removals_copy.push_back(next);
-    }
-    return removals_copy;
+    return file_name;
 }
 
 void clear_vector(vector<RBT_Security_Node*>& to_clear)
@@ -878,44 +883,3 @@ void clear_vector(vector<RBT_Security_Node*>& to_clear)
     }
     to_clear.clear();
 }
-
-void restore_tree(vector<RBT_Security_Node*> to_restore, RBT tree)
-{
-    for(size_t i = 0; i < to_restore.size(); i++)
-    {
-        RBT_Security_Node* copy = tree.RBT_copy_node(to_restore.at(i));
-        tree.RBT_add_node(copy);
-    }
-}
-
-void remove_additions(map<int, Customer_Node*>& customers, RBT tree)
-{
-    for(map<int, Customer_Node *>::iterator pair = customers.begin(); pair != customers.end(); pair++)
-    {
-        Customer_Node* customer = pair->second;
-        for(size_t i = 0; i < customer->pledged_to_customer.size(); i++)
-        {
-            int ticket = customer->pledged_to_customer.at(i)->ticket;
-            double mv = customer->pledged_to_customer.at(i)->market_value;
-            RBT_Security_Node* security = tree.find_node(tree.get_root(), ticket, mv);
-            if(security != nullptr)
-            {
-                tree.RBT_remove_node(security);
-            }
-        }
-    }
-}
-
-
-
-
-
-
-
-
-
-
-
-
-
-
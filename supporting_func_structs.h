@@ -7,11 +7,21 @@
 #include <vector>
 #include <sstream>
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <exception>
+#include <chrono>
 #include "red_black_tree.h"
+#include "security_index.h"
+#include "state_journal.h"
+#include "csv_reader.h"
+#include "customer_store.h"
+#include "allocation_engine.h"
 
 
 using namespace std;
+#define PARALLEL_IMPORT_MIN 1048576 //smallest customer file (in bytes) that is worth splitting across threads to parse
 
 
 /*--------------------------------------Account and Customer Node Structures ---------------------------------------------------*/
@@ -26,12 +36,17 @@ struct Account_Node
     string interest_rate;
     string account_type;
     string class_code_description;
-    double current_balance;
+    Money current_balance;
 };
 
 /*
-    This structure holds the contents / details of a Customer as well as all securities
-    and accounts tied to the customer
+    This structure holds the contents / details of a Customer as well as all securities and accounts tied to the
+    customer. Accounts are held by value in one contiguous array. The totals are not kept here - they are columns
+    of the customer store the customer is in (see customer_store.h), found through table and row, and the functions
+    below move them in O(1) as accounts and pledged securities are attached and detached. The vectors are read
+    directly but only changed through them. A customer not in a store has no stored totals, so reading them sums
+    its accounts and securities; they are summed into the store once when it is added. update_balances re-sums
+    everything for an audit.
 */
 struct Customer_Node
 {
@@ -41,97 +56,190 @@ struct Customer_Node
     string name2;
 
     //vector to hold all accounts tied to the customer
-    vector<Account_Node*> accounts;
+    vector<Account_Node> accounts;
 
     //vector to hold all securities currently pledged to the customer
     vector<RBT_Security_Node*> pledged_to_customer;
 
-   //calculates the total of all securities pledged to the customer
-    double total_securities_pledged(vector<RBT_Security_Node*> securities_pledged)
-    {   
-        double total = 0;
-        for(size_t i = 0; i < securities_pledged.size(); i++)
+    //the customer store holding the customer's totals and its row there - set by the store, nullptr when not in one
+    Customer_Store* table = nullptr;
+    size_t row = 0;
+
+    //sums the balances of all accounts / the market values of all securities pledged, O(k)
+    Money account_sum() const
+    {
+        Money total;
+        for (size_t i = 0; i < accounts.size(); i++)
         {
-            total += securities_pledged.at(i)->market_value;
+            total += accounts.at(i).current_balance;
         }
         return total;
     }
 
-    //holds the sum of all securities pledged
-    double total_pledged;
-
-    //calculates the total of all accounts tied to the customer
-    double total_account_balance(vector<Account_Node*> accounts)
+    Money pledged_sum() const
     {
-        double total = 0;
-        for (size_t i = 0; i < accounts.size(); i++)
+        Money total;
+        for (size_t i = 0; i < pledged_to_customer.size(); i++)
         {
-            total += accounts.at(i)->current_balance;
+            total += pledged_to_customer.at(i)->market_value;
         }
         return total;
     }
-    //holds the aggregate balance of all accounts
-    double total_balance;
 
-    //calculates the current state of being over or under pledged
-    double calculate_under_over(double total_pledged, double total_balance)
+    //the aggregate balance of all accounts
+    Money total_balance() const
     {
-        return total_pledged - total_balance;
+        return (table != nullptr) ? table->balance_column()[row] : account_sum();
+    }
+
+    //the sum of all securities pledged
+    Money total_pledged() const
+    {
+        return (table != nullptr) ? table->pledged_column()[row] : pledged_sum();
+    }
+
+    //the account balance(s) vs security values assigned - shows if over or under pledged
+    Money over_under() const
+    {
+        return (table != nullptr) ? table->over_under_column()[row] : pledged_sum() - account_sum();
+    }
+
+    //adds an account and its balance to the customer
+    void add_account(const Account_Node& account)
+    {
+        accounts.push_back(account);
+        move_totals(account.current_balance, Money());
+    }
+
+    //takes the account at the position out of the customer
+    void remove_account(size_t position)
+    {
+        Money balance = accounts.at(position).current_balance;
+        accounts.erase(accounts.begin() + position);
+        move_totals(-balance, Money());
+    }
+
+    //changes the balance of the account at the position
+    void set_account_balance(size_t position, Money balance)
+    {
+        move_totals(balance - accounts.at(position).current_balance, Money());
+        accounts.at(position).current_balance = balance;
+    }
+
+    //moves every account of another customer with the same pledge code onto this one, after its own accounts
+    void take_accounts(Customer_Node* other)
+    {
+        Money balance = other->account_sum();
+        accounts.insert(accounts.end(), other->accounts.begin(), other->accounts.end());
+        other->accounts.clear();
+        other->move_totals(-balance, Money());
+        move_totals(balance, Money());
+    }
+
+    //pledges a security to the customer
+    void pledge_security(RBT_Security_Node* security)
+    {
+        pledged_to_customer.push_back(security);
+        move_totals(Money(), security->market_value);
+    }
+
+    //takes the security at the position out of the customer's pledges
+    void unpledge_security(size_t position)
+    {
+        Money market_value = pledged_to_customer.at(position)->market_value;
+        pledged_to_customer.erase(pledged_to_customer.begin() + position);
+        move_totals(Money(), -market_value);
+    }
+
+    //changes the market value of a security pledged to the customer
+    void set_pledged_value(RBT_Security_Node* security, Money market_value)
+    {
+        move_totals(Money(), market_value - security->market_value);
+        security->market_value = market_value;
+    }
+
+    //takes every pledged security out of the customer and returns them, in the order they were pledged
+    vector<RBT_Security_Node*> release_pledged()
+    {
+        move_totals(Money(), -total_pledged());
+        vector<RBT_Security_Node*> released = move(pledged_to_customer);
+        pledged_to_customer.clear();
+        return released;
+    }
+
+    //gives back the securities taken by release_pledged - their market values are summed again
+    void restore_pledged(vector<RBT_Security_Node*>&& securities)
+    {
+        Money released = total_pledged();
+        pledged_to_customer = move(securities);
+        move_totals(Money(), pledged_sum() - released);
+    }
+
+    //moves the totals held in the store - a customer not in a store has nothing to move
+    void move_totals(Money balance_change, Money pledged_change)
+    {
+        if (table != nullptr)
+        {
+            table->move_totals(row, balance_change, pledged_change);
+        }
     }
-    
-    //maintains the account balance(s) vs security values assigned - shows if over or under pledged
-    double over_under; 
 };
 
 
-/*-------------------------------Program Build Functions (Red Black Tree and Customer Map) -------------------------------------*/
+/*------------------------------Program Build Functions (Red Black Tree and Customer Store) ------------------------------------*/
 
 /*
     Function is called to consruct an account node. The vector parameter 
     consists of data from each customer line within the loaded csv file. 
     Data conversions are performed here
 */
-Account_Node* build_account_node(const vector<string>& customer_data);
+Account_Node build_account_node(const vector<string_view>& customer_data);
 
 /*
     Function is called to consruct a customer node. The vector parameter 
     consists of data from each customer line within the loaded csv file. 
     Data conversions are performed here
 */
-Customer_Node* build_customer_node(const vector<string>& customer_data);
+Customer_Node* build_customer_node(const vector<string_view>& customer_data);
 
 //create function to read in data from security csv file
 //this will eventually call the functions to build the red black tree - just using vector for right now
 //need to add tests to check if file was successfully loaded
 
 /*
-    Function is called to import security data from the security source file. 
+    Function is called to import security data from the security source file into the security index passed in. 
     The function will add already pledged securities to the customer listed
-    on the source. If the customer is no longer in the customer map structure, 
+    on the source. If the customer is no longer in the customer store, 
     the security will be 'unpledged' and added to the pledge removal vector.
+    The file is parsed in place where it is mapped (see csv_reader.h) and closed once every row is read.
+*/
+void import_and_build_security_index(Customer_Store& customers, vector<RBT_Security_Node*>& pledge_removals, Mapped_File& security_file, Security_Index& tree);
+
+/*
+    Function places a security read from a security file. If its pledge ID belongs to a customer in the store, the
+    security is added to that customer's pledged securities and the customer is returned. Otherwise the security is
+    freed (pledge ID and description cleared) and nullptr is returned for the caller to add it to the index - if it
+    was pledged to a customer no longer in the store, a copy is added to the pledge removals.
 */
-RBT import_and_build_RBT_tree(map<int, Customer_Node*> customers, vector<RBT_Security_Node*>& pledge_removals, ifstream& security_file);
+Customer_Node* place_loaded_security(Customer_Store& customers, vector<RBT_Security_Node*>& pledge_removals, RBT_Security_Node* security);
 
 /*
     Function is called to import customer data from the customer source file. 
-    For each customer in file, a customer node will be built and added to the map. 
-    Any customer accounts added, where the customer is already in the map, the account
+    For each customer in file, a customer node will be built and added to the store. 
+    Any customer accounts added, where the customer is already in the store, the account
     will be added to that customers struct.
+    Large files are split into chunks that start on a row and parsed on separate threads (threads = 0 uses
+    every hardware thread). Each chunk gathers its customers and their accounts in a table of its own, and the
+    tables are merged in file order once every chunk is read, so each customer's accounts keep the order
+    they have in the file, and the store is built from them with a single sort that also sums each customer's
+    totals into its columns.
 */
-map<int, Customer_Node*> load_customer_data(ifstream& customer_file);
+Customer_Store load_customer_data(Mapped_File& customer_file, size_t threads = 0);
 
 
 /*---------------------------------------Security Seach / Add and Removal Functions --------------------------------------------*/
 
 
-/*
-    Function is called to traverse the red-black tree in search of 
-    a security with the desired balance. The min and max parameters indicate the bottom
-    and top of the search threshold. Any security idenfified within this range will be
-    returned. If no security is found, nullptr is returned.
-*/
-RBT_Security_Node* find_security(RBT_Security_Node* root, double min, double max);
-
 /*
     Function is called to perform customer pleding updates. Ultimate goal of this function is to test if enough securities can be
     pledged to a customer balance. Two methods are used 1. using the needed balance plus a threshold, and if no security is within this
@@ -141,44 +249,54 @@ RBT_Security_Node* find_security(RBT_Security_Node* root, double min, double max
     are performed within the increase_decrease_search function. The smaller total market value of all securities identified of the two methods 
     is used to actually pledge to a customer. Those not used are added back to the red-black tree. If at anypoint where a customer balance 
     cannot be covered (both methods return false), the function returns false. True will only be returned if, for each customer needing pledging 
-    updates, all customer balances were adequately covered.
+    updates, all customer balances were adequately covered. Every change is made through the state journal, so the run can be rolled back.
+    Customers needing updates are taken from the store's deficit queue, in the pledge order the store is set to (see set_pledge_order).
 */
-bool update_customers(map<int, Customer_Node*> customers, RBT tree, vector<RBT_Security_Node*>& additions, double threshold = .5);
+bool update_customers(Customer_Store& customers, State_Journal& tree, vector<RBT_Security_Node*>& additions, double threshold = .5);
 /*
     Function is called to perform customer pleding updates. As an alternative to the update customer function above. This function unpledges
-    all securties for the entire customer map. This allows a 'redistribution' of securties as some securities appropriate for update may have
-    already been pledged. This gives the program a chance to find more apprpriate market values. This function will continuously loop starting
+    all securties for the entire customer store. This allows a 'redistribution' of securties as some securities appropriate for update may have
+    already been pledged. This gives the program a chance to find more apprpriate market values. The securities are first allocated to every
+    customer in a single global pass (see allocate_pledges). Only if that pass can't cover every customer, the function will continuously loop starting
     with a max threshold of 50% decrementing by 1% each iteration to lower the threshold until it reaches the actual balance needed for each customer.
+    A failed pass or iteration is rolled back through the state journal before the next one starts. The report is filled in with how the run
+    went - the passes used, the lots released, pledged and moved, the excess pledged and the time taken.
     This function returns true only if all customers are sufficiently pledged.
 */
-bool clear_all_and_repledge(RBT tree, map<int, Customer_Node*> customers, vector<RBT_Security_Node*>& additions, vector<RBT_Security_Node*>& removals);
+bool clear_all_and_repledge(State_Journal& tree, Customer_Store& customers, vector<RBT_Security_Node*>& additions, vector<RBT_Security_Node*>& removals,
+                            Allocation_Report& report);
 /*
-    Function is called to perform the actual over-under pledged balance testing, adding securities where possible. Within this function, find_security
-    is frequently called to search for securities to cover the balance. Depending on the direction parameter, the function will search smaller securities
+    Function is called to perform the actual over-under pledged balance testing, adding securities where possible. Within this function, the security
+    index is frequently searched (take_security) for securities to cover the balance. Depending on the direction parameter, the function will search smaller securities
     or larger securities. False is smaller, True is larger.
 */
-bool increase_decrease_search(RBT tree, double over_under, bool direction, vector<RBT_Security_Node*>& used_securities, double threshold);
+bool increase_decrease_search(Security_Index& tree, Money over_under, bool direction, vector<RBT_Security_Node*>& used_securities, double threshold);
 
 /*
-    Function is called to free memory and clear out the customer map - This would primarily be used if a new customer file is loaded
+    Function returns the total amount all underpledged customers are short of collateral (the sum of 
+    every negative over_under balance, returned as a positive amount), kept by the store's deficit queue. Comparing
+    this with the market value total of the tree, both O(1), shows when a pledging run cannot possibly succeed.
+*/
+Money total_deficit(Customer_Store& customers);
+
+/*
+    Function is called to free memory and clear out the customer store - This would primarily be used if a new customer file is loaded
     and a new customer base is established.
 */
-void clear_customers(map<int, Customer_Node*>& customers);
+void clear_customers(Customer_Store& customers);
 
 /*
-    Function is called to remove all pledges attached to each customer. The security will be added back to the 
-    red-black tree for reuse in future searches. If the unpledge parameter is set to true, the security will be added
-    the unpledge_secrutiy list indicating that the security was initially pledge to the customer and needs to be officially
-    unpledged. Otherwise, the security is simply added back to the tree. This is due to potentially several iterations being 
-    needed and willavoid adding duplicate removals to the vector.
+    Function is called to remove all pledges attached to each customer. A copy of each security will be added back to the 
+    red-black tree for reuse in future searches, and the security itself is added to the removals list indicating that the
+    security was initially pledged to the customer and needs to be officially unpledged.
 */
-void clear_pledges(RBT tree, map<int, Customer_Node *> customers, vector<RBT_Security_Node*>& removals, bool unpledge);
+void clear_pledges(State_Journal& tree, Customer_Store& customers, vector<RBT_Security_Node*>& removals);
 
 /*
     Function is called to perform initial check of customer under_over balances. If any are initially in excess of 50% 
     of the customer's aggregate account balance, it removes / unpledges them.
 */
-void test_overage(map<int, Customer_Node*>& customers,vector<RBT_Security_Node*>& removals, RBT tree);
+void test_overage(Customer_Store& customers,vector<RBT_Security_Node*>& removals, Security_Index& tree);
 
 /*
     Function is called to free memory and clear all additions and removals changes included in
@@ -186,13 +304,28 @@ void test_overage(map<int, Customer_Node*>& customers,vector<RBT_Security_Node*>
 */
 void clear_changes(vector<RBT_Security_Node*>& removals, vector<RBT_Security_Node*>& additions);
 
+/*
+    Function is called when a new security file is loaded. Every security node in the program (the tree,
+    the customer pledges and all change vectors) is dropped and the security node pool is
+    reset in one step, rather than deleting each node on its own. Customer balances are updated to
+    reflect that no securities are pledged.
+
+    The security record pool is shared by the whole program, so the reset frees every record it has handed out.
+    The caller must have dropped any other pointer to these records first - a catalog not attached to the journal
+    passed in, another index or a vector of records of its own. The records are counted before the reset: if the
+    pool holds records beyond those released here, they are deleted one at a time instead and the pool is left as
+    it is, so a record held elsewhere stays valid.
+*/
+void release_all_securities(Security_Index& tree, Customer_Store& customers, vector<RBT_Security_Node*>& removals,
+                            vector<RBT_Security_Node*>& additions);
+
 
 /*---------------------------------------------- Display and Export Functions --------------------------------------------------*/
 
 /*
     Function is called to display details of customer's current state.
 */
-void display_customers(map<int, Customer_Node*> customers, bool all_customers = true);
+void display_customers(Customer_Store& customers, bool all_customers = true);
 
 /*
     Function is called to display details of current state of changes to be made as a result of running the program.
@@ -202,7 +335,7 @@ void display_changes(vector<RBT_Security_Node*> removals, vector<RBT_Security_No
 /*
     Function is called to export details of customer's current state to a csv file.
 */
-void export_customers(map<int, Customer_Node*>& customers);
+void export_customers(Customer_Store& customers);
 
 /*
     Function is called to display details of current state of changes to be made to a csv file.
@@ -213,56 +346,37 @@ void export_changes(vector<RBT_Security_Node*> removals, vector<RBT_Security_Nod
 /*---------------------------------------------------- Utility Functions -------------------------------------------------------*/
 
 /*
-    Function is called to perform updates of a customer's total aggregate balances for securities pledge
-    and accounts. Additionally, it performs an update to the over_under net pledge balance.
+    Function is called to re-sum a customer's total aggregate balances for securities pledge and accounts, and
+    the over_under net pledge balance. The totals are kept as running totals, so this is only needed to audit
+    them. Returns false if the running totals were off (they are reset to the re-summed values).
 */
-void update_balances(Customer_Node* customer);
+bool update_balances(Customer_Node* customer);
 
 /*
-    Function is called to prompt user to enter menu selection. The function will only accept digits 1 - 10
-    as input, either in integer or decimal format. If any other number is provided, it will continuosly 
-    prompt the user for an acceptable selection. If any other character is provided, the function will end
-    effectively ending the program.
+    Function re-sums the totals of every customer (see update_balances) and returns the number of customers
+    whose running totals were off - 0 when every total is right.
 */
-int interface_validate();
+int audit_customer_totals(Customer_Store& customers);
 
 /*
-    Function copies the contents of one map to another
-*/
-void copy_customer_map(map<int, Customer_Node*>& customers, map<int, Customer_Node*>& customers_copy, RBT tree);
-
-/*
-    Function returns a copy node of the node passed into the function
+    Function is called to prompt user to enter menu selection. The function will only accept numbers 0 - 11
+    (the menu options are 1 - 11) as input, either in integer or decimal format. If any other number is provided, it will continuosly 
+    prompt the user for an acceptable selection. If any other character is provided, the function will end
+    effectively ending the program.
 */
-Account_Node* copy_account(Account_Node* original);
+int interface_validate();
 
 /*
     Function is called to file names from the user and open the file from with data will be imported.
     If the function fails to open the provided file name, it will continuosly prompt user to re-enter 
-    the file name.
+    the file name. The file is mapped into memory (see csv_reader.h) rather than opened as a stream.
+    Returns the name of the file opened, or an empty string if the user returned to the menu.
 */
-void open_file(ifstream& file);
-
-/*
-    Function returns a copy of the RBT_Security_Node vector passed into the function
-*/
-vector<RBT_Security_Node*> copy_removals(vector<RBT_Security_Node*>& removals, RBT tree);
+string open_file(Mapped_File& file);
 
 /*
     Function frees the memory of each pointer within a vector and then clears the vector itself
 */
 void clear_vector(vector<RBT_Security_Node*>& to_clear);
 
-/*
-    Function frees removes nodes from the passed vector and adds them to the passed Red Black Tree
-    The node references are not deleted, but swapped from the vector to the tree. 
-*/
-void restore_tree(vector<RBT_Security_Node*> to_restore, RBT tree);
-
-/*
-    Function removes securities from the tree that were added back to the tree as part of clear all and repledge. These 
-    securities should no longer be in the tree when restarting a process as these are already pledged to a customer
-*/
-void remove_additions(map<int, Customer_Node*>& customers, RBT tree);
-
 #endif
\ No newline at end of file